@@ -0,0 +1,412 @@
+/**********************************************************************
+* File:        BoxBenchmark.cpp
+* Description: Benchmarks of load, render, edit and save paths
+* Author:      Zdenko Podobny
+* Created:     2026-10-19
+*
+* (C) Copyright 2026, Zdenko Podobny
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**    http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*
+**********************************************************************/
+
+
+#include <QtTest>
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTemporaryDir>
+
+#include <algorithm>
+
+#include "BoxFile.h"
+#include "ChildWidget.h"
+#include "TessTools.h"
+
+#ifndef QBE_SAMPLES_DIR
+#define QBE_SAMPLES_DIR "tests"
+#endif
+
+// Synthetic documents are split to pages like real scans (A4, 300 dpi)
+static const int kBoxesPerPage = 5000;
+static const int kBoxesPerLine = 100;
+static const int kPageWidth = 2480;
+static const int kPageHeight = 3508;
+// Every measurement runs at least once and repeats until budget is spent
+static const qint64 kTimeBudgetMs = 500;
+static const int kMaxIterations = 100;
+
+struct BenchDocument {
+    QString name;
+    QString imageFile;
+    QString boxFile;
+    int boxes;
+};
+
+/*
+ * Timing of hot paths of editor on shipped samples (tests/) and on synthetic
+ * documents with 1k - 1M boxes. Results are written as JSON so runs can be
+ * compared. Private functions of ChildWidget are accessed as friend.
+ */
+class ChildWidgetBenchmark : public QObject {
+    Q_OBJECT
+
+  public:
+    ChildWidgetBenchmark(const QString& samplesDir, const QString& jsonFile,
+                         int maxBoxes);
+
+  private slots:
+    void initTestCase_data();
+    void cleanupTestCase();
+
+    void readToVector();
+    void fillTableData();
+    void save();
+    void imageConversion();
+    void slotChangePage();
+    void updateSelectionRects();
+    void clickHitTest();
+    void exportTxt();
+
+  private:
+    bool addSample(const QString& boxFile);
+    bool addSynthetic(int boxes);
+    const BenchDocument& currentDocument();
+    ChildWidget* openDocument(const BenchDocument& doc);
+
+    template <typename Body>
+    void measure(const QString& name, const BenchDocument& doc, Body body) {
+        QVector<qint64> times;  // nanoseconds
+        QElapsedTimer total;
+        total.start();
+        do {
+            QElapsedTimer timer;
+            timer.start();
+            body();
+            times.append(timer.nsecsElapsed());
+        } while (total.elapsed() < kTimeBudgetMs &&
+                 times.size() < kMaxIterations);
+        std::sort(times.begin(), times.end());
+
+        QJsonObject result;
+        result["benchmark"] = name;
+        result["document"] = doc.name;
+        result["boxes"] = doc.boxes;
+        result["iterations"] = times.size();
+        result["min_ms"] = times.first() / 1e6;
+        result["median_ms"] = times.at(times.size() / 2) / 1e6;
+        result["max_ms"] = times.last() / 1e6;
+        m_results.append(result);
+        qDebug().noquote() << name << doc.name << "median"
+                           << times.at(times.size() / 2) / 1e6 << "ms";
+    }
+
+    QString m_samplesDir;
+    QString m_jsonFile;
+    int m_maxBoxes;
+    QTemporaryDir m_dir;
+    QVector<BenchDocument> m_documents;
+    QJsonArray m_results;
+};
+
+ChildWidgetBenchmark::ChildWidgetBenchmark(const QString& samplesDir,
+                                           const QString& jsonFile,
+                                           int maxBoxes)
+  : m_samplesDir(samplesDir), m_jsonFile(jsonFile), m_maxBoxes(maxBoxes) {
+}
+
+/*
+ * Documents are global data, so every benchmark runs for every document.
+ * Samples are copied to temporary directory, so saving does not touch them.
+ */
+void ChildWidgetBenchmark::initTestCase_data() {
+  QVERIFY(m_dir.isValid());
+  QDir samples(m_samplesDir);
+  QStringList boxFiles = samples.entryList(QStringList() << "*.box",
+                                           QDir::Files, QDir::Name);
+  for (int i = 0; i < boxFiles.size(); ++i)
+    addSample(samples.filePath(boxFiles.at(i)));
+
+  for (int boxes = 1000; boxes <= 1000000; boxes *= 10) {
+    if (boxes > m_maxBoxes)
+      break;
+    QVERIFY2(addSynthetic(boxes),
+             qPrintable(QString("Cannot create synthetic document %1")
+                        .arg(boxes)));
+  }
+
+  QTest::addColumn<int>("document");
+  for (int i = 0; i < m_documents.size(); ++i)
+    QTest::newRow(qPrintable(m_documents.at(i).name)) << i;
+}
+
+void ChildWidgetBenchmark::cleanupTestCase() {
+  QJsonObject root;
+  root["application"] = QString("qt-box-editor");
+  root["version"] = QString(APP_VERSION);
+  root["qt"] = QString(qVersion());
+  root["date"] = QDateTime::currentDateTime().toString(Qt::ISODate);
+  root["results"] = m_results;
+
+  QFile file(m_jsonFile);
+  QVERIFY2(file.open(QIODevice::WriteOnly | QIODevice::Truncate),
+           qPrintable(file.errorString()));
+  file.write(QJsonDocument(root).toJson());
+  qDebug().noquote() << "Results written to" << m_jsonFile;
+}
+
+bool ChildWidgetBenchmark::addSample(const QString& boxFile) {
+  QString imageFile = BoxFile::findImageFile(boxFile);
+  if (imageFile.isEmpty())
+    return false;
+
+  BenchDocument doc;
+  doc.name = "sample-" + QFileInfo(boxFile).completeBaseName();
+  doc.boxFile = m_dir.filePath(QFileInfo(boxFile).fileName());
+  doc.imageFile = m_dir.filePath(QFileInfo(imageFile).fileName());
+  if (!QFile::copy(boxFile, doc.boxFile) ||
+      !QFile::copy(imageFile, doc.imageFile))
+    return false;
+
+  BoxPages pages;
+  QString error;
+  if (!BoxFile::load(doc.boxFile, &pages, &error))
+    return false;
+  doc.boxes = 0;
+  for (int i = 0; i < pages.size(); ++i)
+    doc.boxes += pages.at(i).size();
+  m_documents.append(doc);
+  return true;
+}
+
+/*
+ * Create multipage G4 tiff with black rectangle for every box and box file
+ * with lines of kBoxesPerLine symbols (every 50th is bold).
+ */
+bool ChildWidgetBenchmark::addSynthetic(int boxes) {
+  static const QString symbols = "abcdefghijklmnopqrstuvwxyz0123456789";
+  const int cellWidth = kPageWidth / (kBoxesPerLine + 2);
+  const int lineHeight = 60;
+
+  BenchDocument doc;
+  doc.name = QString("synthetic-%1").arg(boxes);
+  doc.imageFile = m_dir.filePath(doc.name + ".tif");
+  doc.boxFile = m_dir.filePath(doc.name + ".box");
+  doc.boxes = boxes;
+
+  BoxPages pages;
+  for (int page = 0; page * kBoxesPerPage < boxes; ++page) {
+    PIX* pix = pixCreate(kPageWidth, kPageHeight, 1);
+    BoxPage boxPage;
+    int count = qMin(kBoxesPerPage, boxes - page * kBoxesPerPage);
+    for (int i = 0; i < count; ++i) {
+      int left = cellWidth + (i % kBoxesPerLine) * cellWidth;
+      int top = lineHeight + (i / kBoxesPerLine) * lineHeight;
+      int width = cellWidth - 4 - i % 5;
+      int height = 30 + i % 7;
+      pixRasterop(pix, left, top, width, height, PIX_SET, NULL, 0, 0);
+
+      QString symbol = symbols.at(i % symbols.size());
+      if (i % 50 == 0)
+        symbol.prepend('@');
+      boxPage.append(QStringList() << symbol << QString::number(left)
+                     << QString::number(kPageHeight - top - height)
+                     << QString::number(left + width)
+                     << QString::number(kPageHeight - top)
+                     << QString::number(page));
+    }
+    int failed = pixWriteTiff(doc.imageFile.toLocal8Bit().constData(), pix,
+                              IFF_TIFF_G4, page == 0 ? "w" : "a");
+    pixDestroy(&pix);
+    if (failed)
+      return false;
+    pages.append(boxPage);
+  }
+
+  QString error;
+  if (!BoxFile::save(doc.boxFile, pages, &error))
+    return false;
+  m_documents.append(doc);
+  return true;
+}
+
+const BenchDocument& ChildWidgetBenchmark::currentDocument() {
+  QFETCH_GLOBAL(int, document);
+  return m_documents.at(document);
+}
+
+ChildWidget* ChildWidgetBenchmark::openDocument(const BenchDocument& doc) {
+  ChildWidget* child = new ChildWidget();
+  child->resize(1200, 800);
+  child->show();
+  if (!child->loadImage(doc.imageFile)) {
+    delete child;
+    return 0;
+  }
+  return child;
+}
+
+// ChildWidget::readToVector only reports errors of BoxFile::read
+void ChildWidgetBenchmark::readToVector() {
+  const BenchDocument& doc = currentDocument();
+  QFile file(doc.boxFile);
+  QVERIFY(file.open(QIODevice::ReadOnly));
+  const QString data = QString::fromUtf8(file.readAll());
+
+  bool ok = true;
+  measure("readToVector", doc, [&]() {
+    QString boxdata = data;
+    QTextStream stream(&boxdata);
+    BoxPages pages;
+    QString error;
+    ok = BoxFile::read(stream, &pages, &error) && ok;
+  });
+  QVERIFY(ok);
+}
+
+// Same steps as page change/reload: new model filled from pages
+void ChildWidgetBenchmark::fillTableData() {
+  const BenchDocument& doc = currentDocument();
+  QScopedPointer<ChildWidget> child(openDocument(doc));
+  QVERIFY(!child.isNull());
+
+  bool ok = true;
+  measure("fillTableData", doc, [&]() {
+    child->cleanTable();
+    child->initTable();
+    ok = child->fillTableData(child->currPage) && ok;
+  });
+  QVERIFY(ok);
+}
+
+void ChildWidgetBenchmark::save() {
+  const BenchDocument& doc = currentDocument();
+  QScopedPointer<ChildWidget> child(openDocument(doc));
+  QVERIFY(!child.isNull());
+
+  const QString fileName = m_dir.filePath("saved.box");
+  bool ok = true;
+  measure("save", doc, [&]() {
+    ok = child->save(fileName) && ok;
+  });
+  QVERIFY(ok);
+}
+
+void ChildWidgetBenchmark::imageConversion() {
+  const BenchDocument& doc = currentDocument();
+  PIX* pix = pixRead(doc.imageFile.toLocal8Bit().constData());
+  QVERIFY(pix);
+  const QImage image = TessTools::PIX2qImage(pix);
+  QVERIFY(!image.isNull());
+
+  measure("qImage2PIX", doc, [&]() {
+    PIX* converted = TessTools::qImage2PIX(image);
+    pixDestroy(&converted);
+  });
+  measure("PIX2qImage", doc, [&]() {
+    QImage converted = TessTools::PIX2qImage(pix);
+    Q_UNUSED(converted);
+  });
+  pixDestroy(&pix);
+}
+
+// Switch between the first two pages (page image is read from tiff again)
+void ChildWidgetBenchmark::slotChangePage() {
+  const BenchDocument& doc = currentDocument();
+  QScopedPointer<ChildWidget> child(openDocument(doc));
+  QVERIFY(!child.isNull());
+  if (child->currentPage->maximum() < 2 || child->pages.size() < 2)
+    QSKIP("Document has only one page");
+
+  int page = 1;
+  bool ok = true;
+  measure("slotChangePage", doc, [&]() {
+    page = page == 1 ? 2 : 1;
+    ok = child->slotChangePage(page) && ok;
+  });
+  QVERIFY(ok);
+}
+
+void ChildWidgetBenchmark::updateSelectionRects() {
+  const BenchDocument& doc = currentDocument();
+  QScopedPointer<ChildWidget> child(openDocument(doc));
+  QVERIFY(!child.isNull());
+  QVERIFY(child->model->rowCount() > 0);
+
+  child->table->setCurrentIndex(
+    child->model->index(child->model->rowCount() / 2, 0));
+  measure("updateSelectionRects", doc, [&]() {
+    child->updateSelectionRects();
+  });
+
+  child->table->selectAll();
+  measure("updateSelectionRects(all)", doc, [&]() {
+    child->updateSelectionRects();
+  });
+}
+
+// Left click on image: box under mouse is searched in model
+void ChildWidgetBenchmark::clickHitTest() {
+  const BenchDocument& doc = currentDocument();
+  QScopedPointer<ChildWidget> child(openDocument(doc));
+  QVERIFY(!child.isNull());
+
+  const QPoint pos(child->sizes().first() + 6 + 10, 10);
+  measure("clickHitTest", doc, [&]() {
+    QMouseEvent event(QEvent::MouseButtonPress, pos, Qt::LeftButton,
+                      Qt::LeftButton, Qt::NoModifier);
+    child->mousePressEvent(&event);
+  });
+}
+
+void ChildWidgetBenchmark::exportTxt() {
+  const BenchDocument& doc = currentDocument();
+  QScopedPointer<ChildWidget> child(openDocument(doc));
+  QVERIFY(!child.isNull());
+
+  const QString fileName = m_dir.filePath("export.txt");
+  bool ok = true;
+  measure("exportTxt", doc, [&]() {
+    ok = child->exportTxt(BoxFile::etParagraphPerLine, fileName) && ok;
+  });
+  QVERIFY(ok);
+}
+
+// Remove option with value from arguments (the rest is passed to QTest)
+static bool takeOption(QStringList* args, const QString& name,
+                       QString* value) {
+  int i = args->indexOf(name);
+  if (i < 1 || i + 1 >= args->size())
+    return false;
+  *value = args->at(i + 1);
+  args->erase(args->begin() + i, args->begin() + i + 2);
+  return true;
+}
+
+int main(int argc, char* argv[]) {
+  QApplication app(argc, argv);
+  QStringList args = app.arguments();
+
+  QString samplesDir = QBE_SAMPLES_DIR;
+  QString jsonFile = "qt-box-editor-benchmark.json";
+  QString maxBoxes = "100000";
+  takeOption(&args, "-samples", &samplesDir);
+  takeOption(&args, "-json", &jsonFile);
+  takeOption(&args, "-maxboxes", &maxBoxes);
+
+  ChildWidgetBenchmark benchmark(samplesDir, jsonFile, maxBoxes.toInt());
+  return QTest::qExec(&benchmark, args);
+}
+
+#include "BoxBenchmark.moc"
@@ -0,0 +1,103 @@
+/**********************************************************************
+* File:        ClusterDialog.cpp
+* Description: Review of similar glyphs with different labels
+* Author:      Zdenko Podobny
+* Created:     2026-10-19
+*
+* (C) Copyright 2026, Zdenko Podobny
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**    http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*
+**********************************************************************/
+
+
+#include "dialogs/ClusterDialog.h"
+#include "Settings.h"
+
+ClusterDialog::ClusterDialog(QWidget* parent, QString title)
+  : QDialog(parent) {
+  setupUi(this);
+  if (!title.isEmpty())
+    setWindowTitle(tr("Similar glyphs of %1").arg(title));
+  treeWidget->setHeaderLabels(QStringList() << tr("Labels") << tr("Boxes"));
+
+  connect(treeWidget, SIGNAL(itemClicked(QTreeWidgetItem*, int)), this,
+          SLOT(itemClicked(QTreeWidgetItem*)));
+  connect(buttonBox, SIGNAL(rejected()), this, SLOT(close()));
+  getSettings();
+}
+
+/*
+ * Cluster -> label -> boxes. Cluster is shown as "'o' 512, '0' 3": the
+ * less frequent labels are likely wrong.
+ */
+void ClusterDialog::setClusters(const QVector<GlyphCluster>& clusters) {
+  treeWidget->clear();
+  for (int c = 0; c < clusters.size(); ++c) {
+    const GlyphCluster& cluster = clusters.at(c);
+    QStringList parts;
+    int total = 0;
+    for (int l = 0; l < cluster.m_labels.size(); ++l) {
+      parts << QString("'%1' %2").arg(cluster.m_labels.at(l))
+               .arg(cluster.m_boxes.at(l).size());
+      total += cluster.m_boxes.at(l).size();
+    }
+    QTreeWidgetItem* clusterItem = new QTreeWidgetItem(treeWidget);
+    clusterItem->setText(0, parts.join(", "));
+    clusterItem->setText(1, QString::number(total));
+
+    for (int l = 0; l < cluster.m_labels.size(); ++l) {
+      const QVector<BoxRef>& boxes = cluster.m_boxes.at(l);
+      QTreeWidgetItem* labelItem = new QTreeWidgetItem(clusterItem);
+      labelItem->setText(0, QString("'%1'").arg(cluster.m_labels.at(l)));
+      labelItem->setText(1, QString::number(boxes.size()));
+      for (int i = 0; i < boxes.size(); ++i) {
+        QTreeWidgetItem* boxItem = new QTreeWidgetItem(labelItem);
+        boxItem->setText(0, tr("page %1, row %2").arg(boxes.at(i).m_page + 1)
+                         .arg(boxes.at(i).m_row + 1));
+        boxItem->setData(0, Qt::UserRole, boxes.at(i).m_page);
+        boxItem->setData(0, Qt::UserRole + 1, boxes.at(i).m_row);
+      }
+    }
+  }
+  label->setText(tr("%1 clusters with more than one label").arg(
+                   clusters.size()));
+}
+
+void ClusterDialog::itemClicked(QTreeWidgetItem* item) {
+  if (item->childCount() > 0)
+    return;
+  emit boxActivated(item->data(0, Qt::UserRole).toInt(),
+                    item->data(0, Qt::UserRole + 1).toInt());
+}
+
+void ClusterDialog::closeEvent(QCloseEvent* event) {
+  writeGeometry();
+  event->accept();
+}
+
+void ClusterDialog::getSettings() {
+  QSettings settings(QSettings::IniFormat, QSettings::UserScope,
+                     SETTING_ORGANIZATION, SETTING_APPLICATION);
+  QPoint pos = settings.value("Clusters/Pos", QPoint(200, 200)).toPoint();
+  QSize size = settings.value("Clusters/Size", QSize(480, 480)).toSize();
+  resize(size);
+  move(pos);
+}
+
+void ClusterDialog::writeGeometry() {
+  QSettings settings(QSettings::IniFormat, QSettings::UserScope,
+                     SETTING_ORGANIZATION, SETTING_APPLICATION);
+  settings.setValue("Clusters/Pos", pos());
+  settings.setValue("Clusters/Size", size());
+}
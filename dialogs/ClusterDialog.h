@@ -0,0 +1,56 @@
+/**********************************************************************
+* File:        ClusterDialog.h
+* Description: Review of similar glyphs with different labels
+* Author:      Zdenko Podobny
+* Created:     2026-10-19
+*
+* (C) Copyright 2026, Zdenko Podobny
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**    http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*
+**********************************************************************/
+
+
+#ifndef DIALOGS_CLUSTERDIALOG_H_
+#define DIALOGS_CLUSTERDIALOG_H_
+
+#include <QCloseEvent>
+#include <QDialog>
+#include <QSettings>
+
+#include "GlyphClusters.h"
+#include "ui_ClusterDialog.h"
+
+class ClusterDialog : public QDialog, public Ui::Clusters {
+  Q_OBJECT
+
+  public:
+    explicit ClusterDialog(QWidget* parent = 0, QString title = "");
+
+    void setClusters(const QVector<GlyphCluster>& clusters);
+
+  signals:
+    void boxActivated(int page, int row);
+
+  protected:
+    void closeEvent(QCloseEvent* event);
+
+  private slots:
+    void itemClicked(QTreeWidgetItem* item);
+
+  private:
+    void getSettings();
+    void writeGeometry();
+};
+
+#endif  // DIALOGS_CLUSTERDIALOG_H_
@@ -40,12 +40,16 @@ FindDialog::FindDialog(QWidget* parent, QString title)
   findNextButton->setEnabled(false);
   findPrevButton = new QPushButton(tr("&Previous"));
   findPrevButton->setEnabled(false);
+  replaceAllButton = new QPushButton(tr("Replace &All"));
+  replaceAllButton->setEnabled(false);
   closeButton = new QPushButton(tr("&Close"));
 
   buttonBox->addButton(findNextButton,
                        QDialogButtonBox::ActionRole);
   buttonBox->addButton(findPrevButton,
                        QDialogButtonBox::ActionRole);
+  buttonBox->addButton(replaceAllButton,
+                       QDialogButtonBox::ActionRole);
   buttonBox->addButton(closeButton,
                        QDialogButtonBox::RejectRole);
 
@@ -54,8 +58,11 @@ FindDialog::FindDialog(QWidget* parent, QString title)
 
   connect(findNextButton, SIGNAL(clicked()), this, SLOT(findNext()));
   connect(findPrevButton, SIGNAL(clicked()), this, SLOT(findPrev()));
+  connect(replaceAllButton, SIGNAL(clicked()), this, SLOT(replaceAll()));
   connect(closeButton, SIGNAL(clicked()), this, SLOT(close()));
   connect(checkBox_Mc, SIGNAL(toggled(bool)), this, SLOT(changed_Mc(bool)));
+  connect(checkBox_RegExp, SIGNAL(toggled(bool)), this,
+          SLOT(changed_RegExp(bool)));
   connect(parent, SIGNAL(blinkFindDialog()), this, SLOT(blinkFindDialog()));
   timerBlink = new QTimeLine(10);
   originalBackColor = this->palette().color(QPalette::Window);;
@@ -65,6 +72,7 @@ FindDialog::FindDialog(QWidget* parent, QString title)
 void FindDialog::on_lineEdit_textChanged() {
   findNextButton->setEnabled(lineEdit->hasAcceptableInput());
   findPrevButton->setEnabled(lineEdit->hasAcceptableInput());
+  replaceAllButton->setEnabled(lineEdit->hasAcceptableInput());
 }
 
 void FindDialog::findNext() {
@@ -83,12 +91,34 @@ void FindDialog::findPrev() {
   emit findPrev(symbol, mc);
 }
 
+/*
+ * Replace all matching symbols in one step. Pattern is interpreted as
+ * regular expression if requested (captures can be used in replacement
+ * as \1, \2...).
+ */
+void FindDialog::replaceAll() {
+  QString symbol = lineEdit->text();
+  Qt::CaseSensitivity mc =
+    checkBox_Mc->isChecked() ? Qt::CaseSensitive
+    : Qt::CaseInsensitive;
+  emit replaceAll(symbol, lineEdit_Replace->text(), mc,
+                  checkBox_RegExp->isChecked(),
+                  comboBox_Scope->currentIndex() == 1,
+                  comboBox_Style->currentIndex());
+}
+
 void FindDialog::changed_Mc(bool status) {
   QSettings settings(QSettings::IniFormat, QSettings::UserScope,
                      SETTING_ORGANIZATION, SETTING_APPLICATION);
   settings.setValue("Find/MatchCase", status);
 }
 
+void FindDialog::changed_RegExp(bool status) {
+  QSettings settings(QSettings::IniFormat, QSettings::UserScope,
+                     SETTING_ORGANIZATION, SETTING_APPLICATION);
+  settings.setValue("Find/RegExp", status);
+}
+
 void FindDialog::blinkFindDialog() {
   QApplication::beep();
   if(timerBlink->state() == QTimeLine::NotRunning)
@@ -118,6 +148,8 @@ void FindDialog::getSettings() {
                      SETTING_ORGANIZATION, SETTING_APPLICATION);
   if (settings.contains("Find/MatchCase"))
     checkBox_Mc->setChecked(settings.value("Find/MatchCase").toBool());
+  if (settings.contains("Find/RegExp"))
+    checkBox_RegExp->setChecked(settings.value("Find/RegExp").toBool());
 
   QPoint pos = settings.value("Find/Pos", QPoint(200, 200)).toPoint();
   QSize size = settings.value("Find/Size", QSize(300, 100)).toSize();
@@ -32,6 +32,10 @@
 
 #include "ui_FindDialog.h"
 
+// Style filter used by replace all (index of comboBox_Style)
+enum ReplaceStyleFilter { rsfAny = 0, rsfNormal, rsfBold, rsfItalic,
+                          rsfUnderline };
+
 class FindDialog : public QDialog, public Ui::Find {
   Q_OBJECT
 
@@ -44,6 +48,9 @@ class FindDialog : public QDialog, public Ui::Find {
   signals:
     void findNext(const QString &smbl, Qt::CaseSensitivity mc);
     void findPrev(const QString &smbl, Qt::CaseSensitivity mc);
+    void replaceAll(const QString &smbl, const QString &replacement,
+                    Qt::CaseSensitivity mc, bool regExp, bool allPages,
+                    int styleFilter);
 
   protected:
     void closeEvent(QCloseEvent* event);
@@ -51,6 +58,7 @@ class FindDialog : public QDialog, public Ui::Find {
   private:
     QPushButton *findNextButton;
     QPushButton *findPrevButton;
+    QPushButton *replaceAllButton;
     QPushButton *closeButton;
     QTimeLine *timerBlink;
     QColor originalBackColor;
@@ -61,8 +69,10 @@ class FindDialog : public QDialog, public Ui::Find {
     void on_lineEdit_textChanged();
     void findNext();
     void findPrev();
+    void replaceAll();
     void blinkFinished();
     void changed_Mc(bool status);
+    void changed_RegExp(bool status);
     void getSettings();
 };
 
@@ -0,0 +1,152 @@
+/**********************************************************************
+* File:        SymbolStatsDialog.cpp
+* Description: Statistics of symbols of all pages
+* Author:      Zdenko Podobny
+* Created:     2026-10-19
+*
+* (C) Copyright 2026, Zdenko Podobny
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**    http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*
+**********************************************************************/
+
+
+#include "dialogs/SymbolStatsDialog.h"
+#include "Settings.h"
+
+enum statsColumn { escSymbol = 0, escCount, escWidth, escHeight, escAspect,
+                   escBold, escItalic, escUnderline, escColumns };
+
+SymbolStatsDialog::SymbolStatsDialog(QWidget* parent, QString title)
+  : QDialog(parent) {
+  setupUi(this);
+  if (!title.isEmpty())
+    setWindowTitle(tr("Symbols of %1").arg(title));
+
+  tableWidget->setColumnCount(escColumns);
+  tableWidget->setHorizontalHeaderLabels(QStringList()
+    << tr("Symbol") << tr("Count") << tr("Width") << tr("Height")
+    << tr("Aspect") << tr("Bold") << tr("Italic") << tr("Underline"));
+  tableWidget->setToolTip(tr("Width, height and aspect: "
+                             "minimum / median / maximum"));
+
+  connect(tableWidget, SIGNAL(itemSelectionChanged()), this,
+          SLOT(currentSymbolChanged()));
+  connect(listWidget, SIGNAL(itemClicked(QListWidgetItem*)), this,
+          SLOT(outlierClicked(QListWidgetItem*)));
+  connect(buttonBox, SIGNAL(rejected()), this, SLOT(close()));
+  getSettings();
+}
+
+/*
+ * Table is rebuilt (there are only hundreds of symbols); selected symbol is
+ * kept.
+ */
+void SymbolStatsDialog::setStats(const SymbolStats& stats) {
+  QString selected = selectedSymbol();
+  QStringList symbols = stats.symbols();
+  tableWidget->blockSignals(true);
+  tableWidget->setSortingEnabled(false);
+  tableWidget->clearContents();
+  tableWidget->setRowCount(symbols.size());
+  int selectedRow = -1;
+  for (int row = 0; row < symbols.size(); ++row) {
+    SymbolSummary s = stats.summary(symbols.at(row));
+    QStringList cells;
+    cells << symbols.at(row) << QString::number(s.m_count)
+          << QString("%1 / %2 / %3").arg(s.m_minWidth).arg(s.m_medianWidth)
+             .arg(s.m_maxWidth)
+          << QString("%1 / %2 / %3").arg(s.m_minHeight)
+             .arg(s.m_medianHeight).arg(s.m_maxHeight)
+          << QString("%1 / %2 / %3").arg(s.m_minAspect, 0, 'f', 2)
+             .arg(s.m_medianAspect, 0, 'f', 2).arg(s.m_maxAspect, 0, 'f', 2)
+          << QString::number(s.m_bold) << QString::number(s.m_italic)
+          << QString::number(s.m_underline);
+    for (int col = 0; col < cells.size(); ++col) {
+      QTableWidgetItem* item = new QTableWidgetItem(cells.at(col));
+      if (col != escSymbol)
+        item->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+      tableWidget->setItem(row, col, item);
+    }
+    if (symbols.at(row) == selected)
+      selectedRow = row;
+  }
+  if (selectedRow >= 0)
+    tableWidget->selectRow(selectedRow);
+  tableWidget->blockSignals(false);
+  label->setText(tr("%1 boxes, %2 symbols").arg(stats.boxCount())
+                 .arg(symbols.size()));
+  if (selectedRow >= 0)
+    emit symbolSelected(selected);  // outliers could change
+  else
+    listWidget->clear();
+}
+
+void SymbolStatsDialog::setOutliers(const QString& symbol,
+                                    const QVector<BoxRef>& boxes) {
+  listWidget->clear();
+  for (int i = 0; i < boxes.size(); ++i) {
+    QListWidgetItem* item = new QListWidgetItem(
+      tr("'%1' page %2, row %3").arg(symbol).arg(boxes.at(i).m_page + 1)
+      .arg(boxes.at(i).m_row + 1), listWidget);
+    item->setData(Qt::UserRole, boxes.at(i).m_page);
+    item->setData(Qt::UserRole + 1, boxes.at(i).m_row);
+  }
+  label_Outliers->setText(tr("Outliers of '%1': %2").arg(symbol)
+                          .arg(boxes.size()));
+}
+
+QString SymbolStatsDialog::selectedSymbol() const {
+  QList<QTableWidgetItem*> items = tableWidget->selectedItems();
+  for (int i = 0; i < items.size(); ++i) {
+    if (items.at(i)->column() == escSymbol)
+      return items.at(i)->text();
+  }
+  return QString();
+}
+
+void SymbolStatsDialog::currentSymbolChanged() {
+  QString symbol = selectedSymbol();
+  if (symbol.isEmpty()) {
+    listWidget->clear();
+    label_Outliers->setText(tr("Outliers:"));
+    return;
+  }
+  emit symbolSelected(symbol);
+}
+
+void SymbolStatsDialog::outlierClicked(QListWidgetItem* item) {
+  emit boxActivated(item->data(Qt::UserRole).toInt(),
+                    item->data(Qt::UserRole + 1).toInt());
+}
+
+void SymbolStatsDialog::closeEvent(QCloseEvent* event) {
+  writeGeometry();
+  event->accept();
+}
+
+void SymbolStatsDialog::getSettings() {
+  QSettings settings(QSettings::IniFormat, QSettings::UserScope,
+                     SETTING_ORGANIZATION, SETTING_APPLICATION);
+  QPoint pos = settings.value("SymbolStats/Pos", QPoint(200, 200)).toPoint();
+  QSize size = settings.value("SymbolStats/Size", QSize(560, 480)).toSize();
+  resize(size);
+  move(pos);
+}
+
+void SymbolStatsDialog::writeGeometry() {
+  QSettings settings(QSettings::IniFormat, QSettings::UserScope,
+                     SETTING_ORGANIZATION, SETTING_APPLICATION);
+  settings.setValue("SymbolStats/Pos", pos());
+  settings.setValue("SymbolStats/Size", size());
+}
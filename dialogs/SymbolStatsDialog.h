@@ -0,0 +1,64 @@
+/**********************************************************************
+* File:        SymbolStatsDialog.h
+* Description: Statistics of symbols of all pages
+* Author:      Zdenko Podobny
+* Created:     2026-10-19
+*
+* (C) Copyright 2026, Zdenko Podobny
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**    http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*
+**********************************************************************/
+
+
+#ifndef DIALOGS_SYMBOLSTATSDIALOG_H_
+#define DIALOGS_SYMBOLSTATSDIALOG_H_
+
+#include <QCloseEvent>
+#include <QDialog>
+#include <QSettings>
+
+#include "SymbolStats.h"
+#include "ui_SymbolStatsDialog.h"
+
+/*
+ * Table of symbols with counts, size distributions and styles. Outliers of
+ * selected symbol are listed below; owner provides them (it knows pages).
+ */
+class SymbolStatsDialog : public QDialog, public Ui::SymbolStats {
+  Q_OBJECT
+
+  public:
+    explicit SymbolStatsDialog(QWidget* parent = 0, QString title = "");
+
+    void setStats(const SymbolStats& stats);
+    void setOutliers(const QString& symbol, const QVector<BoxRef>& boxes);
+    QString selectedSymbol() const;
+
+  signals:
+    void symbolSelected(const QString& symbol);
+    void boxActivated(int page, int row);
+
+  protected:
+    void closeEvent(QCloseEvent* event);
+
+  private slots:
+    void currentSymbolChanged();
+    void outlierClicked(QListWidgetItem* item);
+
+  private:
+    void getSettings();
+    void writeGeometry();
+};
+
+#endif  // DIALOGS_SYMBOLSTATSDIALOG_H_
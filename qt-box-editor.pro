@@ -40,29 +40,77 @@ FORMS += \
     dialogs/GetRowIDDialog.ui \
     dialogs/SettingsDialog.ui \
     dialogs/FindDialog.ui \
-    dialogs/DrawRectangle.ui
+    dialogs/DrawRectangle.ui \
+    dialogs/SymbolStatsDialog.ui \
+    dialogs/ClusterDialog.ui
 
 SOURCES += src/main.cpp \
+    src/BatchProcessor.cpp \
+    src/BoxFile.cpp \
+    src/BoxGrid.cpp \
+    src/BoxLinter.cpp \
+    src/BoxProposer.cpp \
+    src/BoxValidator.cpp \
+    src/DocumentLoader.cpp \
+    src/GlyphClusters.cpp \
+    src/GlyphGallery.cpp \
+    src/InkMap.cpp \
     src/MainWindow.cpp \
+    src/PageLayout.cpp \
+    src/PageStrip.cpp \
+    src/PerfCounters.cpp \
     src/ChildWidget.cpp \
     src/DelegateEditors.cpp \
+    src/EditJournal.cpp \
+    src/ImageCache.cpp \
+    src/ImageView.cpp \
+    src/SymbolStats.cpp \
+    src/SymbolTokenizer.cpp \
     src/TessTools.cpp \
+    src/TiffIndex.cpp \
+    src/Trace.cpp \
+    src/UndoStack.cpp \
     dialogs/SettingsDialog.cpp \
     dialogs/GetRowIDDialog.cpp \
     dialogs/ShortCutsDialog.cpp \
     dialogs/FindDialog.cpp \
-    dialogs/DrawRectangle.cpp
+    dialogs/DrawRectangle.cpp \
+    dialogs/SymbolStatsDialog.cpp \
+    dialogs/ClusterDialog.cpp
 
-HEADERS += src/MainWindow.h \
+HEADERS += src/BatchProcessor.h \
+    src/BoxFile.h \
+    src/BoxGrid.h \
+    src/BoxLinter.h \
+    src/BoxProposer.h \
+    src/BoxValidator.h \
+    src/DocumentLoader.h \
+    src/GlyphClusters.h \
+    src/GlyphGallery.h \
+    src/InkMap.h \
+    src/MainWindow.h \
+    src/PageLayout.h \
+    src/PageStrip.h \
+    src/PerfCounters.h \
     src/ChildWidget.h \
     src/Settings.h \
+    src/SymbolStats.h \
+    src/SymbolTokenizer.h \
     src/TessTools.h \
+    src/TiffIndex.h \
+    src/Trace.h \
     src/DelegateEditors.h \
+    src/EditJournal.h \
+    src/ImageCache.h \
+    src/ImageView.h \
+    src/UndoStack.h \
     dialogs/SettingsDialog.h \
     dialogs/GetRowIDDialog.h \
     dialogs/ShortCutsDialog.h \
     dialogs/FindDialog.h \
-    dialogs/DrawRectangle.h
+    dialogs/DrawRectangle.h \
+    dialogs/SymbolStatsDialog.h \
+    dialogs/ClusterDialog.h
 
 RESOURCES = resources/application.qrc \
     resources/QBE-GNOME.qrc \
@@ -0,0 +1,391 @@
+/**********************************************************************
+* File:        BatchProcessor.cpp
+* Description: Headless processing of box files (--batch)
+* Author:      Zdenko Podobny
+* Created:     2026-10-19
+*
+* (C) Copyright 2026, Zdenko Podobny
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**    http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*
+**********************************************************************/
+
+#include <algorithm>
+
+#include <QCommandLineOption>
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QRunnable>
+#include <QSettings>
+#include <QTextStream>
+#include <QThreadPool>
+
+#include "BatchProcessor.h"
+#include "BoxFile.h"
+#include "BoxProposer.h"
+#include "BoxValidator.h"
+#include "ImageCache.h"
+#include "PageLayout.h"
+#include "Settings.h"
+#include "TessTools.h"
+#include "Trace.h"
+
+struct BatchOptions {
+  bool validate;
+  bool normalize;
+  bool sort;
+  bool splitFont;
+  bool makeBoxes;
+  bool components;  // boxes from connected components instead of tesseract
+  ProposalOptions proposal;
+  int exportType;  // 0 = no export
+  int wordSpace;
+  int paraIndent;
+};
+
+// Output and result shared by all jobs
+struct BatchReport {
+  QMutex mutex;
+  int failed;
+  bool quiet;          // print only failed files
+  QJsonArray files;    // machine readable report (--report)
+};
+
+class BatchJob : public QRunnable {
+  public:
+    BatchJob(const QString& fileName, const BatchOptions& options,
+             BatchReport* report)
+        : m_fileName(fileName), m_options(options), m_report(report) {
+    }
+
+    void run() {
+        QStringList messages;
+        QJsonArray problems;
+        bool ok = process(&messages, &problems);
+        QMutexLocker locker(&m_report->mutex);
+        if (!ok || !m_report->quiet) {
+            QTextStream out(stdout);
+            out.setCodec("UTF-8");
+            out << (ok ? "OK     " : "FAILED ") << m_fileName << "\n";
+            for (int i = 0; i < messages.size(); ++i)
+                out << "  " << messages.at(i) << "\n";
+        }
+        if (!ok)
+            m_report->failed++;
+
+        QJsonObject file;
+        file.insert("file", m_fileName);
+        file.insert("status", ok ? "ok" : "failed");
+        file.insert("messages", QJsonArray::fromStringList(messages));
+        file.insert("problems", problems);
+        m_report->files.append(file);
+    }
+
+  private:
+    bool process(QStringList* messages, QJsonArray* problems);
+
+    QString m_fileName;
+    BatchOptions m_options;
+    BatchReport* m_report;
+};
+
+bool BatchJob::process(QStringList* messages, QJsonArray* problems) {
+  TRACE_SPAN(tcIO);
+  QString boxName, imageName, error;
+  if (QFileInfo(m_fileName).suffix().toLower() == "box") {
+    boxName = m_fileName;
+    imageName = BoxFile::findImageFile(m_fileName);
+  } else {
+    imageName = m_fileName;
+    boxName = BoxFile::boxFileName(m_fileName);
+  }
+
+  QVector<QSize> sizes;
+  if (!imageName.isEmpty() && !BoxFile::readImageInfo(imageName, &sizes)) {
+    messages->append(QObject::tr("Cannot read image %1.").arg(imageName));
+    return false;
+  }
+
+  BoxPages pages;
+  if (m_options.makeBoxes) {
+    if (imageName.isEmpty()) {
+      messages->append(QObject::tr("There is no image for box file."));
+      return false;
+    }
+    // TessTools sets locale and TESSDATA_PREFIX for every call, so
+    // tesseract is not run in parallel
+    static QMutex tessMutex;
+    TessTools tt;
+    for (int page = 0; page < sizes.size(); ++page) {
+      QImage image = ImageCache::image(imageName, page);
+      QString str;
+      if (!image.isNull() && !m_options.components) {
+        QMutexLocker locker(&tessMutex);
+        str = tt.makeBoxes(image, page);
+      }
+      if (str.isEmpty() && !image.isNull()) {
+        BoxPage boxes = BoxProposer::propose(image, page, m_options.proposal);
+        if (!boxes.isEmpty()) {
+          pages.append(boxes);
+          continue;
+        }
+      }
+      QTextStream boxdata(&str);
+      if (str.isEmpty() || !BoxFile::read(boxdata, &pages, &error)) {
+        messages->append(QObject::tr("Cannot create boxes for page %1.")
+                         .arg(page));
+        return false;
+      }
+    }
+    if (!BoxFile::save(boxName, pages, &error)) {
+      messages->append(error);
+      return false;
+    }
+    messages->append(QObject::tr("boxes created"));
+  }
+
+  bool ok = true;
+  if (m_options.validate) {
+    QVector<BoxProblem> found;
+    if (!BoxValidator::validateFile(boxName, imageName, &found, &error)) {
+      messages->append(error);
+      return false;
+    }
+    for (int i = 0; i < found.size(); ++i) {
+      const BoxProblem& problem = found.at(i);
+      messages->append(QObject::tr("line %1: %2").arg(problem.m_line)
+                       .arg(BoxValidator::description(problem)));
+      QJsonObject item;
+      item.insert("line", problem.m_line);
+      item.insert("page", problem.m_page);
+      item.insert("type", BoxValidator::typeName(problem.m_type));
+      if (problem.m_other >= 0)
+        item.insert("other", problem.m_other);
+      problems->append(item);
+    }
+    ok = found.isEmpty();
+  }
+
+  // only validation was requested - box file does not need to be loaded
+  if (!m_options.normalize && !m_options.sort && !m_options.splitFont &&
+      !m_options.exportType)
+    return ok;
+
+  if (!m_options.makeBoxes && !BoxFile::load(boxName, &pages, &error)) {
+    messages->append(error);
+    return false;
+  }
+
+  bool changed = false;
+  if (m_options.normalize) {
+    int count = BoxFile::normalize(&pages, sizes);
+    if (count) {
+      messages->append(QObject::tr("%1 box(es) normalized").arg(count));
+      changed = true;
+    }
+  }
+  if (m_options.sort) {
+    // the same order as Edit/Sort by reading order
+    int sorted = 0;
+    for (int page = 0; page < pages.size(); ++page) {
+      QVector<int> order = PageLayout(pages.at(page)).readingOrder();
+      BoxPage boxes;
+      bool moved = false;
+      for (int i = 0; i < order.size(); ++i) {
+        boxes.append(pages.at(page).at(order.at(i)));
+        moved = moved || order.at(i) != i;
+      }
+      if (moved) {
+        pages[page] = boxes;
+        ++sorted;
+      }
+    }
+    if (sorted) {
+      messages->append(QObject::tr("%1 page(s) sorted").arg(sorted));
+      changed = true;
+    }
+  }
+  if (changed && !BoxFile::save(boxName, pages, &error)) {
+    messages->append(error);
+    return false;
+  }
+
+  if (m_options.splitFont) {
+    // files of styles have one image, they can not keep more pages
+    if (pages.size() > 1 || sizes.size() > 1) {
+      messages->append(QObject::tr("Split by font supports only single "
+                                   "page files."));
+      return false;
+    }
+    QImage image = ImageCache::image(imageName, 0);
+    if (image.isNull()) {
+      messages->append(QObject::tr("There is no image for box file."));
+      return false;
+    }
+    if (!BoxFile::splitByFont(boxName, pages.value(0), image, &error)) {
+      messages->append(error);
+      return false;
+    }
+  }
+
+  if (m_options.exportType) {
+    QString text = BoxFile::exportText(pages, m_options.exportType,
+                                       m_options.wordSpace,
+                                       m_options.paraIndent);
+    QFileInfo fi(boxName);
+    QString txtName = fi.path() + "/" + fi.completeBaseName() + ".txt";
+    if (!BoxFile::saveString(txtName, text, &error)) {
+      messages->append(error);
+      return false;
+    }
+  }
+  return ok;
+}
+
+int BatchProcessor::run(const QStringList& commandLine) {
+  QCommandLineParser parser;
+  parser.setApplicationDescription(
+    QObject::tr("Process box files without GUI."));
+  parser.addHelpOption();
+  QCommandLineOption batchOption("batch", QObject::tr("Run in batch mode."));
+  QCommandLineOption validateOption("validate",
+    QObject::tr("Check box coordinates and image bounds."));
+  QCommandLineOption normalizeOption("normalize",
+    QObject::tr("Fix inverted coordinates, clip boxes to image."));
+  QCommandLineOption sortOption("sort",
+    QObject::tr("Sort boxes to reading order."));
+  QCommandLineOption splitOption("split-font",
+    QObject::tr("Split box file by font style (normal, bold...)."));
+  QCommandLineOption exportOption("export-txt",
+    QObject::tr("Export text: 1 symbol, 2 row, 3 paragraph per line."),
+    QObject::tr("type"));
+  QCommandLineOption makeBoxesOption("make-boxes",
+    QObject::tr("Create box files by tesseract (existing are replaced)."));
+  QCommandLineOption jobsOption(QStringList() << "j" << "jobs",
+    QObject::tr("Number of parallel jobs."), QObject::tr("n"));
+  QCommandLineOption reportOption("report",
+    QObject::tr("Write JSON report of all files."), QObject::tr("file"));
+  QCommandLineOption quietOption(QStringList() << "q" << "quiet",
+    QObject::tr("Print only failed files."));
+  QCommandLineOption traceOption("trace",
+    QObject::tr("Write Chrome trace (JSON) of processing."), QObject::tr("file"));
+  parser.addOption(batchOption);
+  parser.addOption(validateOption);
+  parser.addOption(normalizeOption);
+  parser.addOption(sortOption);
+  parser.addOption(splitOption);
+  parser.addOption(exportOption);
+  parser.addOption(makeBoxesOption);
+  parser.addOption(jobsOption);
+  parser.addOption(reportOption);
+  parser.addOption(quietOption);
+  parser.addOption(traceOption);
+  parser.addPositionalArgument("files",
+    QObject::tr("Box files, images or directories (all box files in "
+                "directory tree are processed)."), QObject::tr("files..."));
+  parser.process(commandLine);
+
+  QTextStream err(stderr);
+  QStringList files;
+  QStringList arguments = parser.positionalArguments();
+  for (int i = 0; i < arguments.size(); ++i) {
+    if (QFileInfo(arguments.at(i)).isDir()) {
+      QDirIterator it(arguments.at(i), QStringList() << "*.box", QDir::Files,
+                      QDirIterator::Subdirectories);
+      while (it.hasNext())
+        files.append(it.next());
+    } else {
+      files.append(arguments.at(i));
+    }
+  }
+  if (files.isEmpty()) {
+    err << parser.helpText();
+    return 2;
+  }
+
+  QSettings settings(QSettings::IniFormat, QSettings::UserScope,
+                     SETTING_ORGANIZATION, SETTING_APPLICATION);
+  BatchOptions options;
+  options.validate = parser.isSet(validateOption);
+  options.normalize = parser.isSet(normalizeOption);
+  options.sort = parser.isSet(sortOption);
+  options.splitFont = parser.isSet(splitOption);
+  options.makeBoxes = parser.isSet(makeBoxesOption);
+  options.components = settings.value("Boxes/Engine").toString() ==
+                       "components";
+  options.proposal = BoxProposer::options(settings);
+  options.exportType = parser.value(exportOption).toInt();
+  options.wordSpace = settings.value("Text/WordSpace").toInt();
+  options.paraIndent = settings.value("Text/ParagraphIndent").toInt();
+  if (options.exportType < 0 || options.exportType > 3) {
+    err << QObject::tr("Unknown export type %1.\n").arg(options.exportType);
+    return 2;
+  }
+
+  Trace::setEnabled(parser.isSet(traceOption));
+
+  QThreadPool* pool = QThreadPool::globalInstance();
+  if (parser.isSet(jobsOption) && parser.value(jobsOption).toInt() > 0)
+    pool->setMaxThreadCount(parser.value(jobsOption).toInt());
+
+  BatchReport report;
+  report.failed = 0;
+  report.quiet = parser.isSet(quietOption);
+  for (int i = 0; i < files.size(); ++i)
+    pool->start(new BatchJob(files.at(i), options, &report));
+  pool->waitForDone();
+
+  if (parser.isSet(reportOption)) {
+    // files are finished in random order
+    QList<QJsonObject> results;
+    for (int i = 0; i < report.files.size(); ++i)
+      results.append(report.files.at(i).toObject());
+    std::sort(results.begin(), results.end(),
+              [](const QJsonObject& a, const QJsonObject& b) {
+                return a.value("file").toString() < b.value("file").toString();
+              });
+    QJsonArray sorted;
+    for (int i = 0; i < results.size(); ++i)
+      sorted.append(results.at(i));
+    QJsonObject root;
+    root.insert("checked", files.size());
+    root.insert("failed", report.failed);
+    root.insert("files", sorted);
+
+    QString error;
+    if (!BoxFile::saveString(parser.value(reportOption),
+                             QString::fromUtf8(QJsonDocument(root).toJson()),
+                             &error)) {
+      err << error << "\n";
+      return 2;
+    }
+  }
+
+  if (parser.isSet(traceOption)) {
+    QString error;
+    if (!Trace::exportChromeTrace(parser.value(traceOption), &error)) {
+      err << error << "\n";
+      return 2;
+    }
+  }
+
+  return report.failed ? 1 : 0;
+}
@@ -0,0 +1,41 @@
+/**********************************************************************
+* File:        BatchProcessor.h
+* Description: Headless processing of box files (--batch)
+* Author:      Zdenko Podobny
+* Created:     2026-10-19
+*
+* (C) Copyright 2026, Zdenko Podobny
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**    http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*
+**********************************************************************/
+
+
+#ifndef SRC_BATCHPROCESSOR_H_
+#define SRC_BATCHPROCESSOR_H_
+
+#include <QStringList>
+
+/*
+ * Command line mode without GUI:
+ *   qt-box-editor --batch [options] files...
+ * Files (box files, images or directories) are processed in parallel by
+ * thread pool. Result can be written as JSON report (--report).
+ */
+class BatchProcessor {
+  public:
+    // Returns exit code: 0 on success, 1 if any file failed, 2 on bad usage
+    static int run(const QStringList& commandLine);
+};
+
+#endif  // SRC_BATCHPROCESSOR_H_
@@ -0,0 +1,445 @@
+/**********************************************************************
+* File:        BoxFile.cpp
+* Description: GUI-free box file functions (load, save, transform)
+* Author:      Zdenko Podobny
+* Created:     2026-10-19
+*
+* (C) Copyright 2026, Zdenko Podobny
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**    http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*
+**********************************************************************/
+
+
+#include <leptonica/allheaders.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QObject>
+#include <QRegExp>
+#include <QRunnable>
+#include <QStringBuilder>
+#include <QThread>
+#include <QThreadPool>
+
+#include "BoxFile.h"
+#include "PageLayout.h"
+#include "TiffIndex.h"
+#include "Trace.h"
+
+bool BoxFile::read(QTextStream& boxdata, BoxPages* pages, QString* error) {
+  TRACE_SPAN(tcIO);
+  boxdata.setCodec("UTF-8");
+  QString data = boxdata.readAll();
+  QStringList lineBoxes = data.split(QRegExp("\n"),
+                                     Qt::SkipEmptyParts);
+  QString pagePrev = "0";
+  BoxPage page;
+
+  for (int i = 0; i < lineBoxes.size(); ++i) {
+    QString line = lineBoxes.at(i);
+    QStringList box = line.split(" ");
+    if (box.size() == 7) {
+        if (line.startsWith(" "))
+            box.removeFirst ();  // tess2image generate also box for spaces
+    } else if (box.size() != 6) {
+      if (error)
+        *error = QObject::tr("File can not be loaded because of wrong "
+                             "(non tesseract-ocr 3.02) box "
+                             "file format at line '%1'! (box.size: %2)")
+                 .arg(i + 1).arg(box.size());
+      return false;
+    }
+
+    if (box[5] == pagePrev) {
+      page.append(box);
+    } else {
+      pagePrev = box[5];
+      pages->append(page);
+      page.clear();
+      page.append(box);
+    }
+  }
+  pages->append(page);
+  return true;
+}
+
+bool BoxFile::load(const QString& fileName, BoxPages* pages, QString* error) {
+  QFile file(fileName);
+  if (!file.open(QFile::ReadOnly | QFile::Text)) {
+    if (error)
+      *error = QObject::tr("Cannot read file %1:\n%2.").arg(fileName)
+               .arg(file.errorString());
+    return false;
+  }
+  QTextStream boxdata(&file);
+  return read(boxdata, pages, error);
+}
+
+bool BoxFile::save(const QString& fileName, const BoxPages& pages,
+                   QString* error) {
+  TRACE_SPAN(tcIO);
+  QFile file(fileName);
+  if (!file.open(QFile::WriteOnly)) {
+    if (error)
+      *error = QObject::tr("Cannot write file %1:\n%2.").arg(fileName)
+               .arg(file.errorString());
+    return false;
+  }
+
+  QTextStream out(&file);
+  out.setCodec("UTF-8");
+  for (int i = 0; i < pages.size(); ++i) {
+    const BoxPage& page = pages.at(i);
+    for (int j = 0; j < page.size(); ++j) {
+      out << page.at(j).join(" ") << "\n";
+    }
+  }
+  file.close();
+  return true;
+}
+
+bool BoxFile::saveString(const QString& fileName, const QString& data,
+                         QString* error) {
+  QFile file(fileName);
+  if (!file.open(QFile::WriteOnly | QFile::Text)) {
+    if (error)
+      *error = QObject::tr("Cannot write file %1:\n%2.").arg(fileName)
+               .arg(file.errorString());
+    return false;
+  }
+
+  QTextStream out(&file);
+  out.setCodec("UTF-8");
+  out << data;
+  file.close();
+  return true;
+}
+
+// Formatting is present only in case there are more than 2 letters.
+QString BoxFile::stripStyleFlags(const QString& symbol, bool* bold,
+                                 bool* italic, bool* underline) {
+  QString letter = symbol;
+  *bold = false;
+  *italic = false;
+  *underline = false;
+  if (letter.size() > 1 && letter.at(0) == '@') {
+    *bold = true;
+    letter.remove(0, 1);
+  }
+  if (letter.size() > 1 && letter.at(0) == '$') {
+    *italic = true;
+    letter.remove(0, 1);
+  }
+  if (letter.size() > 1 && letter.at(0) == '\'') {
+    *underline = true;
+    letter.remove(0, 1);
+  }
+  return letter;
+}
+
+QString BoxFile::styleFlags(bool bold, bool italic, bool underline) {
+  QString flags;
+  if (bold)
+    flags += "@";
+  if (italic)
+    flags += "$";
+  if (underline)
+    flags += "\'";
+  return flags;
+}
+
+QString BoxFile::findImageFile(const QString& boxFileName) {
+  QFileInfo fi(boxFileName);
+  QString base = fi.path() + "/" + fi.completeBaseName() + ".";
+  QStringList extensions;
+  extensions << "tif" << "tiff" << "png" << "jpg" << "jpeg" << "bmp"
+             << "TIF" << "TIFF" << "PNG" << "JPG" << "JPEG" << "BMP";
+  for (int i = 0; i < extensions.size(); ++i) {
+    if (QFile::exists(base + extensions.at(i)))
+      return base + extensions.at(i);
+  }
+  return QString();
+}
+
+QString BoxFile::boxFileName(const QString& imageFileName) {
+  QFileInfo fi(imageFileName);
+  return fi.path() + "/" + fi.completeBaseName() + ".box";
+}
+
+bool BoxFile::readImageInfo(const QString& imageFileName,
+                            QVector<QSize>* pageSizes) {
+  QByteArray fileName = imageFileName.toLocal8Bit();
+  l_int32 format, w, h, bps, spp, cmap;
+  if (findFileFormat(fileName.data(), &format))
+    return false;
+
+  if (L_FORMAT_IS_TIFF(format)) {
+    // sizes are in directories of pages, nothing is decoded
+    QSharedPointer<const TiffIndex> tiff = TiffIndex::open(imageFileName);
+    if (!tiff)
+      return false;
+    for (int n = 0; n < tiff->pageCount(); ++n) {
+      if (!tiff->pageSize(n).isValid())
+        return false;
+      pageSizes->append(tiff->pageSize(n));
+    }
+    return true;
+  }
+
+  if (pixReadHeader(fileName.data(), &format, &w, &h, &bps, &spp, &cmap))
+    return false;
+  pageSizes->append(QSize(w, h));
+  return true;
+}
+
+int BoxFile::normalize(BoxPages* pages, const QVector<QSize>& pageSizes) {
+  TRACE_SPAN(tcModel);
+  int changed = 0;
+  for (int p = 0; p < pages->size(); ++p) {
+    BoxPage& page = (*pages)[p];
+    for (int row = 0; row < page.size(); ++row) {
+      QStringList& box = page[row];
+      int left = box.at(1).toInt();
+      int bottom = box.at(2).toInt();
+      int right = box.at(3).toInt();
+      int top = box.at(4).toInt();
+      int pageNum = box.at(5).toInt();
+
+      if (left > right)
+        std::swap(left, right);
+      if (bottom > top)
+        std::swap(bottom, top);
+      if (pageNum >= 0 && pageNum < pageSizes.size()) {
+        const QSize& size = pageSizes.at(pageNum);
+        left = qBound(0, left, size.width());
+        right = qBound(0, right, size.width());
+        bottom = qBound(0, bottom, size.height());
+        top = qBound(0, top, size.height());
+      }
+
+      QStringList normalized;
+      normalized << box.at(0) << QString::number(left)
+                 << QString::number(bottom) << QString::number(right)
+                 << QString::number(top) << QString::number(pageNum);
+      if (normalized != box) {
+        box = normalized;
+        ++changed;
+      }
+    }
+  }
+  return changed;
+}
+
+/*
+ * Export type:
+ * 1 = symbolPerLine    => out file will have one symbol/box per line
+ * 2 = rowPerLine       => out file will have one text row per line
+ * 3 = paragraphPerLine => out file will have one paragraph per line
+ * Lines, columns and reading order are found by PageLayout, so boxes can be
+ * in any order.
+ */
+QString BoxFile::exportText(const BoxPage& page, int eType, int wordSpace,
+                            int paraIndent) {
+  TRACE_SPAN(tcModel);
+  return PageLayout(page).text(eType, wordSpace, paraIndent);
+}
+
+class PageTextJob : public QRunnable {
+  public:
+    PageTextJob(const BoxPage& page, int eType, int wordSpace,
+                int paraIndent, QString* text)
+        : m_page(page), m_eType(eType), m_wordSpace(wordSpace),
+          m_paraIndent(paraIndent), m_text(text) {
+    }
+
+    void run() {
+        *m_text = BoxFile::exportText(m_page, m_eType, m_wordSpace,
+                                      m_paraIndent);
+    }
+
+  private:
+    BoxPage m_page;
+    int m_eType;
+    int m_wordSpace;
+    int m_paraIndent;
+    QString* m_text;
+};
+
+QString BoxFile::exportText(const BoxPages& pages, int eType, int wordSpace,
+                            int paraIndent) {
+  TRACE_SPAN(tcModel);
+  QVector<QString> texts(pages.size());
+  // own pool: caller can be job of global pool (batch mode)
+  QThreadPool pool;
+  for (int page = 0; page < pages.size(); ++page) {
+    pool.start(new PageTextJob(pages.at(page), eType, wordSpace, paraIndent,
+                               &texts[page]));
+  }
+  pool.waitForDone();
+
+  QString text;
+  for (int page = 0; page < texts.size(); ++page)
+    text += texts.at(page);
+  return text;
+}
+
+bool BoxFile::exportTxt(const QString& fileName, const BoxPages& pages,
+                        int eType, int wordSpace, int paraIndent,
+                        QString* error) {
+  return saveString(fileName, exportText(pages, eType, wordSpace, paraIndent),
+                    error);
+}
+
+/*
+ * One style of font split: box file and image with boxes of the style.
+ * Jobs share source image (read-only) and write their own files.
+ */
+class FontSplitJob : public QRunnable {
+  public:
+    FontSplitJob(const QString& boxName, const QString& imageName,
+                 const BoxPage& boxes, const QImage& source, QString* error)
+        : m_boxName(boxName), m_imageName(imageName), m_boxes(boxes),
+          m_source(source), m_error(error) {
+    }
+
+    void run() {
+        TRACE_SCOPE("FontSplitJob", tcIO);
+        QString data;
+        data.reserve(m_boxes.size() * 24);
+        for (int row = 0; row < m_boxes.size(); ++row) {
+          const QStringList& box = m_boxes.at(row);
+          data += box.at(0) % QLatin1Char(' ') % box.at(1) % QLatin1Char(' ')
+                  % box.at(2) % QLatin1Char(' ') % box.at(3)
+                  % QLatin1Char(' ') % box.at(4) % QLatin1Char(' ')
+                  % box.at(5) % QLatin1Char('\n');
+        }
+        if (!BoxFile::saveString(m_boxName, data, m_error))
+          return;
+        if (!BoxFile::createStringImage(m_imageName, m_boxes, m_source))
+          *m_error = QObject::tr("Cannot write file %1.").arg(m_imageName);
+    }
+
+  private:
+    QString m_boxName;
+    QString m_imageName;
+    BoxPage m_boxes;
+    QImage m_source;
+    QString* m_error;
+};
+
+bool BoxFile::splitByFont(const QString& fileName, const BoxPage& page,
+                          const QImage& image, QString* error) {
+  TRACE_SPAN(tcIO);
+  enum { normal, bold, italic, boldItalic, underline, styleCount };
+  BoxPage styles[styleCount];
+  for (int row = 0; row < page.size(); ++row) {
+    QStringList box = page.at(row);
+    bool isBold, isItalic, isUnderline;
+    box[0] = stripStyleFlags(box.at(0), &isBold, &isItalic, &isUnderline);
+
+    if (isBold && isItalic)
+      styles[boldItalic].append(box);
+    else if (isBold)
+      styles[bold].append(box);
+    else if (isItalic)
+      styles[italic].append(box);
+    else if (isUnderline)
+      styles[underline].append(box);
+    else
+      styles[normal].append(box);
+  }
+
+  // find path + name + ext:
+  int dotCount = QFileInfo(fileName).fileName().count(".");
+  QStringList results = QFileInfo(fileName).fileName().split(".");
+  QString path, base, ext, imgExt;
+  path = QFileInfo(fileName).path() + QDir::separator();
+
+  if (dotCount < 3) {
+    base = QFileInfo(fileName).baseName();
+    ext = QFileInfo(fileName).completeSuffix();
+  } else  {
+    for (int dot = 0; dot < (dotCount - 1); ++dot) {
+      base += results[dot];
+      if (dot < (dotCount - 2))
+        base += ".";
+    }
+    ext = results[(dotCount - 1)] + "." + results[dotCount];
+  }
+  imgExt = ext;
+  imgExt.replace(imgExt.size() - 3 , 3, "png");
+
+  // decoded page can be mono/indexed; convert it only once for all styles
+  QImage source = image.convertToFormat(QImage::Format_RGB32);
+  const char* names[] = {"normal.", "bold.", "italic.", "bolditalic.",
+                         "underline."};
+  QString errors[styleCount];
+  // own pool: caller can be job of global pool (batch mode)
+  QThreadPool pool;
+  pool.setMaxThreadCount(qBound(1, QThread::idealThreadCount(),
+                                static_cast<int>(styleCount)));
+  for (int i = 0; i < styleCount; ++i) {
+    if (styles[i].isEmpty())
+      continue;
+    pool.start(new FontSplitJob(path + base + names[i] + ext,
+                                path + base + names[i] + imgExt, styles[i],
+                                source, &errors[i]));
+  }
+  pool.waitForDone();
+
+  for (int i = 0; i < styleCount; ++i) {
+    if (!errors[i].isEmpty()) {
+      if (error)
+        *error = errors[i];
+      return false;
+    }
+  }
+  return true;
+}
+
+/*
+ * Box regions are copied by scanlines: it is much faster than QPainter
+ * for pages with thousands of boxes.
+ */
+bool BoxFile::createStringImage(const QString& fileName, const BoxPage& boxes,
+                                const QImage& source) {
+  TRACE_SPAN(tcRender);
+  QImage result(source.size(), QImage::Format_RGB32);
+  result.fill(Qt::white);
+  int imageHeight = source.height();
+
+  for (int row = 0; row < boxes.size(); ++row) {
+    const QStringList& box = boxes.at(row);
+    int left = box.at(1).toInt();
+    int bottom = box.at(2).toInt();
+    int right = box.at(3).toInt();
+    int top = box.at(4).toInt();
+    QRect rect = QRect(left, imageHeight - top, right - left, top - bottom)
+                 .intersected(result.rect());
+    if (rect.isEmpty())
+      continue;
+    const int bytes = rect.width() * 4;
+    for (int y = rect.top(); y <= rect.bottom(); ++y) {
+      memcpy(result.scanLine(y) + rect.left() * 4,
+             source.constScanLine(y) + rect.left() * 4, bytes);
+    }
+  }
+  return result.save(fileName, 0);
+}
@@ -0,0 +1,100 @@
+/**********************************************************************
+* File:        BoxFile.h
+* Description: GUI-free box file functions (load, save, transform)
+* Author:      Zdenko Podobny
+* Created:     2026-10-19
+*
+* (C) Copyright 2026, Zdenko Podobny
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**    http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*
+**********************************************************************/
+
+
+#ifndef SRC_BOXFILE_H_
+#define SRC_BOXFILE_H_
+
+#include <QImage>
+#include <QSize>
+#include <QString>
+#include <QStringList>
+#include <QTextStream>
+#include <QVector>
+
+// Boxes of one page as they are stored in box file:
+// symbol (with font flags) left bottom right top page
+typedef QVector<QStringList> BoxPage;
+typedef QVector<BoxPage> BoxPages;
+
+/*
+ * Box file processing without GUI. It is used by editor and by batch mode
+ * (--batch), so functions report problems by return value and error text
+ * instead of message boxes.
+ */
+class BoxFile {
+  public:
+    enum exportType {
+        etSymbolPerLine = 1,
+        etRowPerLine = 2,
+        etParagraphPerLine = 3
+    };
+
+    // Parse box data and append them to pages
+    static bool read(QTextStream& boxdata, BoxPages* pages, QString* error);
+    static bool load(const QString& fileName, BoxPages* pages,
+                     QString* error);
+    static bool save(const QString& fileName, const BoxPages& pages,
+                     QString* error);
+    static bool saveString(const QString& fileName, const QString& data,
+                           QString* error);
+
+    // Strip font flags ('@' bold, '$' italic, '\'' underline) from symbol
+    static QString stripStyleFlags(const QString& symbol, bool* bold,
+                                   bool* italic, bool* underline);
+    // Prefix for symbol in box file based on font flags
+    static QString styleFlags(bool bold, bool italic, bool underline);
+
+    // Image file for box file (same base name) and box file for image
+    static QString findImageFile(const QString& boxFileName);
+    static QString boxFileName(const QString& imageFileName);
+    // Size of every page of image (only image headers are read)
+    static bool readImageInfo(const QString& imageFileName,
+                              QVector<QSize>* pageSizes);
+
+    /** Swap inverted coordinates, clip boxes to page size (if known) and
+     *  rewrite numbers to canonical form. Returns number of changed boxes.
+     */
+    static int normalize(BoxPages* pages, const QVector<QSize>& pageSizes);
+
+    static QString exportText(const BoxPage& page, int eType, int wordSpace,
+                              int paraIndent);
+    // Text of all pages; pages are processed in parallel
+    static QString exportText(const BoxPages& pages, int eType, int wordSpace,
+                              int paraIndent);
+    static bool exportTxt(const QString& fileName, const BoxPages& pages,
+                          int eType, int wordSpace, int paraIndent,
+                          QString* error);
+
+    /** Create box file and image per font style (normal, bold, italic,
+     *  bolditalic, underline) from boxes of page, e.g. eng.times.exp001.box
+     *  -> eng.timesbold.exp001.box + eng.timesbold.exp001.png
+     *  Styles are written in parallel.
+     */
+    static bool splitByFont(const QString& fileName, const BoxPage& page,
+                            const QImage& image, QString* error);
+    // Copy defined boxes to new image file; source must be Format_RGB32
+    static bool createStringImage(const QString& fileName,
+                                  const BoxPage& boxes, const QImage& source);
+};
+
+#endif  // SRC_BOXFILE_H_
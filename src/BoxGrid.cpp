@@ -0,0 +1,101 @@
+/**********************************************************************
+* File:        BoxGrid.cpp
+* Description: Spatial index of boxes (uniform grid)
+* Author:      Zdenko Podobny
+* Created:     2026-10-19
+*
+* (C) Copyright 2026, Zdenko Podobny
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**    http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*
+**********************************************************************/
+
+
+#include <algorithm>
+
+#include "BoxGrid.h"
+
+BoxGrid::BoxGrid() {
+  m_cellSize = 1;
+  m_columns = 0;
+  m_rows = 0;
+}
+
+BoxGrid::BoxGrid(const QVector<QRect>& rects, int cellSize)
+  : m_rects(rects) {
+  m_columns = 0;
+  m_rows = 0;
+  m_cellSize = 1;
+  if (rects.isEmpty())
+    return;
+
+  QVector<int> sizes;
+  sizes.reserve(rects.size());
+  for (int i = 0; i < rects.size(); ++i) {
+    m_bounds |= rects.at(i);
+    sizes.append(qMax(rects.at(i).width(), rects.at(i).height()));
+  }
+  if (cellSize <= 0) {
+    std::nth_element(sizes.begin(), sizes.begin() + sizes.size() / 2,
+                     sizes.end());
+    cellSize = 2 * sizes.at(sizes.size() / 2);
+  }
+  m_cellSize = qMax(1, cellSize);
+  // a few huge (wrong) boxes must not create millions of empty cells
+  qint64 maxCells = 4 * qint64(rects.size()) + 16;
+  while (qint64(m_bounds.width() / m_cellSize + 1) *
+         (m_bounds.height() / m_cellSize + 1) > maxCells)
+    m_cellSize *= 2;
+  m_columns = m_bounds.width() / m_cellSize + 1;
+  m_rows = m_bounds.height() / m_cellSize + 1;
+
+  m_cells.resize(m_columns * m_rows);
+  for (int i = 0; i < rects.size(); ++i) {
+    const QRect& r = rects.at(i);
+    for (int y = row(r.top()); y <= row(r.bottom()); ++y)
+      for (int x = column(r.left()); x <= column(r.right()); ++x)
+        m_cells[y * m_columns + x].append(i);
+  }
+}
+
+int BoxGrid::column(int x) const {
+  return qBound(0, (x - m_bounds.left()) / m_cellSize, m_columns - 1);
+}
+
+int BoxGrid::row(int y) const {
+  return qBound(0, (y - m_bounds.top()) / m_cellSize, m_rows - 1);
+}
+
+/*
+ * Box found in several cells is reported only from the cell with top left
+ * corner of its intersection with area.
+ */
+void BoxGrid::query(const QRect& area, QVector<int>* result) const {
+  QRect searched = area & m_bounds;
+  if (searched.isEmpty())
+    return;
+  for (int y = row(searched.top()); y <= row(searched.bottom()); ++y) {
+    for (int x = column(searched.left()); x <= column(searched.right());
+         ++x) {
+      const QVector<int>& cell = m_cells.at(y * m_columns + x);
+      for (int i = 0; i < cell.size(); ++i) {
+        const QRect& r = m_rects.at(cell.at(i));
+        if (!r.intersects(searched))
+          continue;
+        if (column(qMax(r.left(), searched.left())) == x &&
+            row(qMax(r.top(), searched.top())) == y)
+          result->append(cell.at(i));
+      }
+    }
+  }
+}
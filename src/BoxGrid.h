@@ -0,0 +1,63 @@
+/**********************************************************************
+* File:        BoxGrid.h
+* Description: Spatial index of boxes (uniform grid)
+* Author:      Zdenko Podobny
+* Created:     2026-10-19
+*
+* (C) Copyright 2026, Zdenko Podobny
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**    http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*
+**********************************************************************/
+
+
+#ifndef SRC_BOXGRID_H_
+#define SRC_BOXGRID_H_
+
+#include <QRect>
+#include <QVector>
+
+/*
+ * Boxes of page in uniform grid of cells. Box is stored in every cell it
+ * touches, so query costs only cells of searched area and boxes in them.
+ * Grid is not changed after construction; it can be shared by threads.
+ */
+class BoxGrid {
+  public:
+    BoxGrid();
+    // cellSize 0: twice the median box size
+    explicit BoxGrid(const QVector<QRect>& rects, int cellSize = 0);
+
+    // Append indexes of boxes intersecting area (every box only once)
+    void query(const QRect& area, QVector<int>* result) const;
+
+    int size() const {
+        return m_rects.size();
+    }
+    const QRect& rect(int index) const {
+        return m_rects.at(index);
+    }
+
+  private:
+    int column(int x) const;
+    int row(int y) const;
+
+    QVector<QRect> m_rects;
+    QRect m_bounds;
+    int m_cellSize;
+    int m_columns;
+    int m_rows;
+    QVector<QVector<int> > m_cells;
+};
+
+#endif  // SRC_BOXGRID_H_
@@ -0,0 +1,149 @@
+/**********************************************************************
+* File:        BoxLinter.cpp
+* Description: Background check of boxes in editor
+* Author:      Zdenko Podobny
+* Created:     2026-10-19
+*
+* (C) Copyright 2026, Zdenko Podobny
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**    http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*
+**********************************************************************/
+
+
+#include <QRunnable>
+
+#include "BoxLinter.h"
+
+class BoxLintJob : public QRunnable {
+  public:
+    BoxLintJob(BoxLinter* linter, int generation, const BoxPages& pages,
+               const QVector<QSize>& pageSizes)
+        : m_linter(linter), m_generation(generation), m_pages(pages),
+          m_pageSizes(pageSizes) {
+    }
+
+    void run() {
+        QVector<BoxProblem> problems;
+        BoxValidator::validatePages(m_pages, m_pageSizes, &problems);
+        QMetaObject::invokeMethod(m_linter, "jobFinished",
+                                  Qt::QueuedConnection,
+                                  Q_ARG(int, m_generation),
+                                  Q_ARG(QVector<BoxProblem>, problems));
+    }
+
+  private:
+    BoxLinter* m_linter;
+    int m_generation;
+    BoxPages m_pages;
+    QVector<QSize> m_pageSizes;
+};
+
+class PageLintJob : public QRunnable {
+  public:
+    PageLintJob(BoxLinter* linter, int generation, const BoxPage& boxes,
+                const QSize& pageSize, const BoxPage& previous,
+                const QVector<BoxProblem>& previousProblems)
+        : m_linter(linter), m_generation(generation), m_boxes(boxes),
+          m_pageSize(pageSize), m_previous(previous),
+          m_previousProblems(previousProblems) {
+    }
+
+    void run() {
+        QVector<BoxProblem> problems;
+        BoxValidator::checkPage(m_boxes, m_pageSize, m_previous,
+                                m_previousProblems, &problems);
+        QMetaObject::invokeMethod(m_linter, "pageJobFinished",
+                                  Qt::QueuedConnection,
+                                  Q_ARG(int, m_generation),
+                                  Q_ARG(QVector<BoxProblem>, problems));
+    }
+
+  private:
+    BoxLinter* m_linter;
+    int m_generation;
+    BoxPage m_boxes;
+    QSize m_pageSize;
+    BoxPage m_previous;
+    QVector<BoxProblem> m_previousProblems;
+};
+
+BoxLinter::BoxLinter(QObject* parent)
+  : QObject(parent) {
+  qRegisterMetaType<QVector<BoxProblem> >();
+  m_pool.setMaxThreadCount(1);
+  m_pagePool.setMaxThreadCount(1);
+  m_pending = false;
+  m_requestedPage = -1;
+  m_checkedPage = -1;
+}
+
+/*
+ * Job posts result to linter, so it must not outlive it
+ */
+BoxLinter::~BoxLinter() {
+  m_pool.clear();
+  m_pagePool.clear();
+  m_pool.waitForDone();
+  m_pagePool.waitForDone();
+}
+
+void BoxLinter::start(const BoxPages& pages,
+                      const QVector<QSize>& pageSizes) {
+  // results of older (waiting or running) job are ignored
+  m_pool.clear();
+  int generation = m_generation.fetchAndAddOrdered(1) + 1;
+  m_pending = true;
+  m_pool.start(new BoxLintJob(this, generation, pages, pageSizes));
+}
+
+/*
+ * Waiting job is replaced, so checks do not queue up during fast editing.
+ * Job always compares with the last finished check (not with the replaced
+ * request), so no change is lost.
+ */
+void BoxLinter::startPage(int page, const BoxPage& boxes,
+                          const QSize& pageSize) {
+  m_pagePool.clear();
+  int generation = m_pageGeneration.fetchAndAddOrdered(1) + 1;
+  m_requestedPage = page;
+  m_requestedBoxes = boxes;
+  bool samePage = page == m_checkedPage;
+  m_pagePool.start(new PageLintJob(this, generation, boxes, pageSize,
+                                   samePage ? m_checkedBoxes : BoxPage(),
+                                   samePage ? m_checkedProblems
+                                            : QVector<BoxProblem>()));
+}
+
+// Job can be finished while its result is still queued to jobFinished
+bool BoxLinter::isRunning() const {
+  return m_pending;
+}
+
+void BoxLinter::jobFinished(int generation,
+                            const QVector<BoxProblem>& problems) {
+  if (generation != m_generation.load())
+    return;
+  m_pending = false;
+  emit finished(problems);
+}
+
+void BoxLinter::pageJobFinished(int generation,
+                                const QVector<BoxProblem>& problems) {
+  if (generation != m_pageGeneration.load())
+    return;
+  m_checkedPage = m_requestedPage;
+  m_checkedBoxes = m_requestedBoxes;
+  m_checkedProblems = problems;
+  emit pageChecked(m_checkedPage, problems);
+}
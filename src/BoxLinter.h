@@ -0,0 +1,76 @@
+/**********************************************************************
+* File:        BoxLinter.h
+* Description: Background check of boxes in editor
+* Author:      Zdenko Podobny
+* Created:     2026-10-19
+*
+* (C) Copyright 2026, Zdenko Podobny
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**    http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*
+**********************************************************************/
+
+
+#ifndef SRC_BOXLINTER_H_
+#define SRC_BOXLINTER_H_
+
+#include <QAtomicInt>
+#include <QObject>
+#include <QThreadPool>
+
+#include "BoxValidator.h"
+
+/*
+ * Runs BoxValidator on copy of document in worker thread. Result of the
+ * latest request is delivered by signal finished() in GUI thread.
+ * Check of edited page (startPage) has own worker, so it does not cancel
+ * check of whole document.
+ */
+class BoxLinter : public QObject {
+    Q_OBJECT
+
+  public:
+    explicit BoxLinter(QObject* parent = 0);
+    ~BoxLinter();
+
+    void start(const BoxPages& pages, const QVector<QSize>& pageSizes);
+    // True until result of the last start() is delivered
+    bool isRunning() const;
+    // Incremental check of page (BoxValidator::checkPage) against the last
+    // finished check of the same page
+    void startPage(int page, const BoxPage& boxes, const QSize& pageSize);
+
+  signals:
+    void finished(const QVector<BoxProblem>& problems);
+    void pageChecked(int page, const QVector<BoxProblem>& problems);
+
+  private slots:
+    void jobFinished(int generation, const QVector<BoxProblem>& problems);
+    void pageJobFinished(int generation, const QVector<BoxProblem>& problems);
+
+  private:
+    QThreadPool m_pool;
+    QAtomicInt m_generation;
+    bool m_pending;
+
+    QThreadPool m_pagePool;
+    QAtomicInt m_pageGeneration;
+    // requested check and the last finished one
+    int m_requestedPage;
+    BoxPage m_requestedBoxes;
+    int m_checkedPage;
+    BoxPage m_checkedBoxes;
+    QVector<BoxProblem> m_checkedProblems;
+};
+
+#endif  // SRC_BOXLINTER_H_
@@ -0,0 +1,310 @@
+/**********************************************************************
+* File:        BoxProposer.cpp
+* Description: Boxes from connected components (without tesseract)
+* Author:      Zdenko Podobny
+* Created:     2026-10-19
+*
+* (C) Copyright 2026, Zdenko Podobny
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**    http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*
+**********************************************************************/
+
+
+#include <climits>
+
+#include <algorithm>
+
+#include <QRunnable>
+#include <QSettings>
+#include <QThread>
+#include <QThreadPool>
+
+#include "BoxGrid.h"
+#include "BoxProposer.h"
+#include "InkMap.h"
+#include "PageLayout.h"
+#include "Trace.h"
+
+namespace {
+
+struct InkRun {
+    int m_y;
+    int m_x0;
+    int m_x1;
+};
+
+int findRoot(int* parent, int i) {
+  while (parent[i] != i) {
+    parent[i] = parent[parent[i]];
+    i = parent[i];
+  }
+  return i;
+}
+
+void unite(int* parent, int a, int b) {
+  a = findRoot(parent, a);
+  b = findRoot(parent, b);
+  if (a != b)
+    parent[qMax(a, b)] = qMin(a, b);
+}
+
+// Unite runs of row (current) with touching runs of row above (previous)
+void uniteRows(const QVector<InkRun>& runs, int* parent, int prevStart,
+               int prevEnd, int curStart, int curEnd) {
+  int j = prevStart;
+  for (int i = curStart; i < curEnd; ++i) {
+    const InkRun& run = runs.at(i);
+    while (j < prevEnd && runs.at(j).m_x1 < run.m_x0 - 1)
+      ++j;
+    for (int k = j; k < prevEnd && runs.at(k).m_x0 <= run.m_x1 + 1; ++k)
+      unite(parent, i, k);
+  }
+}
+
+// Runs of image stripe and their labels (union-find inside of stripe)
+struct InkStripe {
+    int m_top;
+    int m_bottom;
+    QVector<InkRun> m_runs;
+    QVector<int> m_rowStart;  // first run of row, one more for end
+    QVector<int> m_parent;
+};
+
+class StripeJob : public QRunnable {
+  public:
+    StripeJob(const InkMap& ink, InkStripe* stripe)
+        : m_ink(ink), m_stripe(stripe) {
+    }
+
+    void run() {
+        TRACE_SCOPE("StripeJob", tcOCR);
+        InkStripe& s = *m_stripe;
+        for (int y = s.m_top; y < s.m_bottom; ++y) {
+          s.m_rowStart.append(s.m_runs.size());
+          const uchar* line = m_ink.scanLine(y);
+          int x = 0;
+          while (x < m_ink.width()) {
+            if (!line[x]) {
+              ++x;
+              continue;
+            }
+            InkRun run = {y, x, x};
+            while (x < m_ink.width() && line[x])
+              run.m_x1 = x++;
+            s.m_runs.append(run);
+          }
+        }
+        s.m_rowStart.append(s.m_runs.size());
+
+        s.m_parent.resize(s.m_runs.size());
+        for (int i = 0; i < s.m_parent.size(); ++i)
+          s.m_parent[i] = i;
+        for (int row = 1; row < s.m_rowStart.size() - 1; ++row) {
+          uniteRows(s.m_runs, s.m_parent.data(), s.m_rowStart.at(row - 1),
+                    s.m_rowStart.at(row), s.m_rowStart.at(row),
+                    s.m_rowStart.at(row + 1));
+        }
+    }
+
+  private:
+    const InkMap& m_ink;
+    InkStripe* m_stripe;
+};
+
+}  // namespace
+
+ProposalOptions BoxProposer::options(const QSettings& settings) {
+  ProposalOptions options;
+  options.m_minArea = 4;
+  options.m_mergeDiacritics = true;
+  options.m_mergeGap = -1;
+  if (settings.contains("Boxes/MinArea"))
+    options.m_minArea = settings.value("Boxes/MinArea").toInt();
+  if (settings.contains("Boxes/MergeDiacritics"))
+    options.m_mergeDiacritics = settings.value("Boxes/MergeDiacritics")
+                                .toBool();
+  if (settings.contains("Boxes/MergeGap"))
+    options.m_mergeGap = settings.value("Boxes/MergeGap").toInt();
+  return options;
+}
+
+/*
+ * Stripes are labelled in parallel; labels of neighbouring stripes are
+ * joined afterwards through their border rows.
+ */
+QVector<QRect> BoxProposer::components(const InkMap& ink,
+                                       QVector<int>* areas) {
+  TRACE_SPAN(tcOCR);
+  int count = qBound(1, QThread::idealThreadCount(),
+                     qMax(1, ink.height() / 64));
+  QVector<InkStripe> stripes(count);
+  QThreadPool pool;
+  for (int i = 0; i < count; ++i) {
+    stripes[i].m_top = ink.height() * i / count;
+    stripes[i].m_bottom = ink.height() * (i + 1) / count;
+    pool.start(new StripeJob(ink, &stripes[i]));
+  }
+  pool.waitForDone();
+
+  QVector<InkRun> runs;
+  QVector<int> parent;
+  QVector<int> offsets;
+  for (int i = 0; i < count; ++i) {
+    const InkStripe& s = stripes.at(i);
+    offsets.append(runs.size());
+    runs += s.m_runs;
+    for (int r = 0; r < s.m_parent.size(); ++r)
+      parent.append(s.m_parent.at(r) + offsets.last());
+  }
+  for (int i = 1; i < count; ++i) {
+    const InkStripe& above = stripes.at(i - 1);
+    const InkStripe& below = stripes.at(i);
+    if (above.m_rowStart.size() < 2 || below.m_rowStart.size() < 2)
+      continue;
+    int rows = above.m_rowStart.size() - 1;
+    uniteRows(runs, parent.data(),
+              offsets.at(i - 1) + above.m_rowStart.at(rows - 1),
+              offsets.at(i - 1) + above.m_rowStart.at(rows),
+              offsets.at(i) + below.m_rowStart.at(0),
+              offsets.at(i) + below.m_rowStart.at(1));
+  }
+
+  QVector<int> componentOfRoot(runs.size(), -1);
+  QVector<QRect> rects;
+  areas->clear();
+  for (int i = 0; i < runs.size(); ++i) {
+    int root = findRoot(parent.data(), i);
+    if (componentOfRoot.at(root) < 0) {
+      componentOfRoot[root] = rects.size();
+      rects.append(QRect());
+      areas->append(0);
+    }
+    int c = componentOfRoot.at(root);
+    const InkRun& run = runs.at(i);
+    rects[c] |= QRect(QPoint(run.m_x0, run.m_y), QPoint(run.m_x1, run.m_y));
+    (*areas)[c] += run.m_x1 - run.m_x0 + 1;
+  }
+  return rects;
+}
+
+BoxPage BoxProposer::propose(const QImage& image, int page,
+                             const ProposalOptions& options) {
+  TRACE_SPAN(tcOCR);
+  InkMap ink(image);
+  QVector<int> areas;
+  QVector<QRect> all = components(ink, &areas);
+  QVector<QRect> rects;
+  for (int i = 0; i < all.size(); ++i) {
+    if (areas.at(i) >= options.m_minArea)
+      rects.append(all.at(i));
+  }
+  if (rects.isEmpty())
+    return BoxPage();
+
+  QVector<int> heights;
+  for (int i = 0; i < rects.size(); ++i)
+    heights.append(rects.at(i).height());
+  std::nth_element(heights.begin(), heights.begin() + heights.size() / 2,
+                   heights.end());
+  int glyphHeight = heights.at(heights.size() / 2);
+
+  // merge components: broken glyphs, diacritics and close neighbours
+  BoxGrid grid(rects);
+  QVector<int> parent(rects.size());
+  for (int i = 0; i < parent.size(); ++i)
+    parent[i] = i;
+  QVector<int> found;
+  for (int i = 0; i < rects.size(); ++i) {
+    const QRect& r = rects.at(i);
+    qint64 area = qint64(r.width()) * r.height();
+
+    // piece (mostly) inside of bigger component
+    found.clear();
+    grid.query(r, &found);
+    for (int k = 0; k < found.size(); ++k) {
+      const QRect& other = rects.at(found.at(k));
+      QRect common = r & other;
+      if (found.at(k) != i &&
+          qint64(other.width()) * other.height() > area &&
+          2 * qint64(common.width()) * common.height() >= area)
+        unite(parent.data(), i, found.at(k));
+    }
+
+    // dot, accent... above or below the nearest glyph
+    if (options.m_mergeDiacritics && 2 * r.height() < glyphHeight) {
+      int maxGap = glyphHeight / 2;
+      found.clear();
+      grid.query(r.adjusted(0, -maxGap - 1, 0, maxGap + 1), &found);
+      int best = -1;
+      int bestGap = INT_MAX;
+      for (int k = 0; k < found.size(); ++k) {
+        const QRect& other = rects.at(found.at(k));
+        if (found.at(k) == i || other.height() < r.height())
+          continue;
+        int overlap = qMin(r.right(), other.right()) -
+                      qMax(r.left(), other.left()) + 1;
+        int gap = qMax(other.top() - r.bottom(), r.top() - other.bottom());
+        if (2 * overlap >= r.width() && gap >= 0 && gap <= maxGap &&
+            gap < bestGap) {
+          best = found.at(k);
+          bestGap = gap;
+        }
+      }
+      if (best >= 0)
+        unite(parent.data(), i, best);
+    }
+
+    // pieces of broken glyph next to each other
+    if (options.m_mergeGap >= 0) {
+      found.clear();
+      grid.query(r.adjusted(0, 0, options.m_mergeGap + 1, 0), &found);
+      for (int k = 0; k < found.size(); ++k) {
+        const QRect& other = rects.at(found.at(k));
+        if (found.at(k) == i || other.left() <= r.right())
+          continue;
+        int overlap = qMin(r.bottom(), other.bottom()) -
+                      qMax(r.top(), other.top()) + 1;
+        if (2 * overlap >= qMin(r.height(), other.height()) &&
+            other.left() - r.right() - 1 <= options.m_mergeGap)
+          unite(parent.data(), i, found.at(k));
+      }
+    }
+  }
+
+  QVector<QRect> merged(rects.size());
+  for (int i = 0; i < rects.size(); ++i)
+    merged[findRoot(parent.data(), i)] |= rects.at(i);
+
+  BoxPage boxes;
+  QString pageNum = QString::number(page);
+  int height = image.height();
+  for (int i = 0; i < merged.size(); ++i) {
+    const QRect& r = merged.at(i);
+    if (r.isNull())
+      continue;
+    QStringList box;
+    box << "*" << QString::number(r.left())
+        << QString::number(height - r.bottom() - 1)
+        << QString::number(r.right() + 1) << QString::number(height - r.top())
+        << pageNum;
+    boxes.append(box);
+  }
+
+  QVector<int> order = PageLayout(boxes).readingOrder();
+  BoxPage sorted;
+  sorted.reserve(boxes.size());
+  for (int i = 0; i < order.size(); ++i)
+    sorted.append(boxes.at(order.at(i)));
+  return sorted;
+}
@@ -0,0 +1,60 @@
+/**********************************************************************
+* File:        BoxProposer.h
+* Description: Boxes from connected components (without tesseract)
+* Author:      Zdenko Podobny
+* Created:     2026-10-19
+*
+* (C) Copyright 2026, Zdenko Podobny
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**    http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*
+**********************************************************************/
+
+
+#ifndef SRC_BOXPROPOSER_H_
+#define SRC_BOXPROPOSER_H_
+
+#include <QImage>
+#include <QRect>
+#include <QVector>
+
+#include "BoxFile.h"
+
+class InkMap;
+class QSettings;
+
+struct ProposalOptions {
+    int m_minArea;          // smaller components (pixels) are noise
+    bool m_mergeDiacritics; // small component above/below glyph is joined
+    int m_mergeGap;         // join neighbours closer than gap (-1 = off)
+};
+
+/*
+ * Box proposal for scripts without tesseract language data. Page is
+ * binarized, 8-connected components are labelled in image stripes in
+ * parallel (runs + union-find), components are merged by options and boxes
+ * are put to reading order. Symbol of every box is '*'.
+ */
+class BoxProposer {
+  public:
+    // Boxes/MinArea, Boxes/MergeDiacritics and Boxes/MergeGap
+    static ProposalOptions options(const QSettings& settings);
+
+    static BoxPage propose(const QImage& image, int page,
+                           const ProposalOptions& options);
+    // Bounding boxes of 8-connected ink components (top-down coordinates)
+    static QVector<QRect> components(const InkMap& ink,
+                                     QVector<int>* areas);
+};
+
+#endif  // SRC_BOXPROPOSER_H_
@@ -0,0 +1,449 @@
+/**********************************************************************
+* File:        BoxValidator.cpp
+* Description: Consistency checks of box files
+* Author:      Zdenko Podobny
+* Created:     2026-10-19
+*
+* (C) Copyright 2026, Zdenko Podobny
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**    http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*
+**********************************************************************/
+
+
+#include <algorithm>
+
+#include <QFile>
+#include <QHash>
+#include <QObject>
+#include <QTextStream>
+
+#include "BoxGrid.h"
+#include "BoxValidator.h"
+#include "Trace.h"
+
+// Boxes with bigger intersection over union are reported as duplicates
+static const double kDuplicateOverlap = 0.8;
+// Part of smaller box covered by other box reported as overlap
+static const double kOverlap = 0.3;
+// Size outlier: height or width differs more than this from median of symbol
+static const double kSizeRatio = 2.0;
+static const int kMinSymbolSamples = 5;
+
+bool BoxValidator::validateFile(const QString& boxFileName,
+                                const QString& imageFileName,
+                                QVector<BoxProblem>* problems,
+                                QString* error) {
+  TRACE_SPAN(tcIO);
+  QVector<QSize> pageSizes;
+  if (!imageFileName.isEmpty() &&
+      !BoxFile::readImageInfo(imageFileName, &pageSizes)) {
+    if (error)
+      *error = QObject::tr("Cannot read image %1.").arg(imageFileName);
+    return false;
+  }
+
+  QFile file(boxFileName);
+  if (!file.open(QFile::ReadOnly | QFile::Text)) {
+    if (error)
+      *error = QObject::tr("Cannot read file %1:\n%2.").arg(boxFileName)
+               .arg(file.errorString());
+    return false;
+  }
+  QTextStream in(&file);
+  in.setCodec("UTF-8");
+
+  // pages are separated in the same way as in BoxFile::read
+  QString pagePrev = "0";
+  QVector<Box> boxes;
+  int page = 0;
+  int line = 0;
+  while (!in.atEnd()) {
+    QString text = in.readLine();
+    ++line;
+    if (text.isEmpty())
+      continue;
+    QStringList box = text.split(" ");
+    if (box.size() == 7 && text.startsWith(" "))
+      box.removeFirst();
+    if (box.size() != 6) {
+      BoxProblem problem = {bptColumns, line, page, boxes.size(), -1};
+      problems->append(problem);
+      continue;
+    }
+    if (box.at(5) != pagePrev) {
+      pagePrev = box.at(5);
+      findDuplicates(&boxes, page, problems);
+      boxes.clear();
+      ++page;
+    }
+    Box b;
+    if (checkBox(box, line, page, boxes.size(), pageSizes, &b, problems))
+      boxes.append(b);
+  }
+  findDuplicates(&boxes, page, problems);
+  sortProblems(problems);
+  return true;
+}
+
+void BoxValidator::validatePages(const BoxPages& pages,
+                                 const QVector<QSize>& pageSizes,
+                                 QVector<BoxProblem>* problems) {
+  TRACE_SPAN(tcModel);
+  int line = 0;
+  for (int page = 0; page < pages.size(); ++page) {
+    QVector<Box> boxes;
+    boxes.reserve(pages.at(page).size());
+    for (int row = 0; row < pages.at(page).size(); ++row) {
+      Box b;
+      if (checkBox(pages.at(page).at(row), ++line, page, row, pageSizes, &b,
+                   problems))
+        boxes.append(b);
+    }
+    findDuplicates(&boxes, page, problems);
+  }
+  sortProblems(problems);
+}
+
+bool BoxValidator::checkBox(const QStringList& box, int line, int page,
+                            int row, const QVector<QSize>& pageSizes,
+                            Box* result, QVector<BoxProblem>* problems) {
+  bool ok = true;
+  int values[5];
+  for (int i = 0; i < 5 && ok; ++i)
+    values[i] = box.at(i + 1).toInt(&ok);
+  BoxProblem problem = {bptNumber, line, page, row, -1};
+  if (!ok) {
+    problems->append(problem);
+    return false;
+  }
+
+  result->line = line;
+  result->row = row;
+  result->left = values[0];
+  result->bottom = values[1];
+  result->right = values[2];
+  result->top = values[3];
+  if (result->left > result->right || result->bottom > result->top) {
+    problem.m_type = bptInverted;
+    problems->append(problem);
+    return false;
+  }
+  if (result->left == result->right || result->bottom == result->top) {
+    problem.m_type = bptEmpty;
+    problems->append(problem);
+    return false;
+  }
+
+  if (pageSizes.isEmpty())
+    return true;  // no image - bounds are not known
+  int pageNum = values[4];
+  if (pageNum < 0 || pageNum >= pageSizes.size()) {
+    problem.m_type = bptPage;
+    problems->append(problem);
+  } else {
+    const QSize& size = pageSizes.at(pageNum);
+    if (result->left < 0 || result->bottom < 0 ||
+        result->right > size.width() || result->top > size.height()) {
+      problem.m_type = bptOutside;
+      problems->append(problem);
+    }
+  }
+  return true;
+}
+
+/*
+ * Boxes are sorted by left edge, so only boxes starting before right edge
+ * of box have to be compared.
+ */
+void BoxValidator::findDuplicates(QVector<Box>* boxes, int page,
+                                  QVector<BoxProblem>* problems) {
+  std::sort(boxes->begin(), boxes->end(), [](const Box& a, const Box& b) {
+    return a.left < b.left;
+  });
+  for (int i = 0; i < boxes->size(); ++i) {
+    const Box& a = boxes->at(i);
+    qint64 areaA = qint64(a.right - a.left) * (a.top - a.bottom);
+    if (areaA == 0)
+      continue;
+    for (int j = i + 1; j < boxes->size() && boxes->at(j).left < a.right;
+         ++j) {
+      const Box& b = boxes->at(j);
+      qint64 areaB = qint64(b.right - b.left) * (b.top - b.bottom);
+      int w = qMin(a.right, b.right) - b.left;
+      int h = qMin(a.top, b.top) - qMax(a.bottom, b.bottom);
+      if (areaB == 0 || w <= 0 || h <= 0)
+        continue;
+      qint64 intersection = qint64(w) * h;
+      if (intersection >= kDuplicateOverlap *
+          (areaA + areaB - intersection)) {
+        const Box& later = a.line > b.line ? a : b;
+        const Box& first = a.line > b.line ? b : a;
+        BoxProblem problem = {bptDuplicate, later.line, page, later.row,
+                              first.line};
+        problems->append(problem);
+      }
+    }
+  }
+}
+
+/*
+ * Rows are compared with previous check by content, so any edit (also undo,
+ * replace or reload) is found. Rows are aligned by common head and tail of
+ * both pages: inserted or removed rows only shift rows of the tail, so
+ * problems of unaffected rows are kept (with new row numbers) also then.
+ */
+void BoxValidator::checkPage(const BoxPage& boxes, const QSize& pageSize,
+                             const BoxPage& previous,
+                             const QVector<BoxProblem>& previousProblems,
+                             QVector<BoxProblem>* problems) {
+  TRACE_SPAN(tcModel);
+  // all boxes of edited page have the same page number
+  int page = boxes.isEmpty() ? 0 : boxes.first().value(5).toInt();
+  QVector<QSize> pageSizes;
+  if (pageSize.isValid() && page >= 0) {
+    pageSizes.resize(page + 1);
+    pageSizes[page] = pageSize;
+  }
+  QVector<QRect> rects(boxes.size());
+  QVector<int> rowOfRect;
+  QVector<QRect> usable;
+  for (int row = 0; row < boxes.size(); ++row) {
+    Box b;
+    if (!checkBox(boxes.at(row), row + 1, page, row, pageSizes, &b,
+                  problems))
+      continue;
+    rects[row] = QRect(QPoint(b.left, b.bottom), QPoint(b.right - 1,
+                                                        b.top - 1));
+    rowOfRect.append(row);
+    usable.append(rects.at(row));
+  }
+  BoxGrid grid(usable);
+
+  bool incremental = !previous.isEmpty();
+  QVector<bool> affected(boxes.size(), !incremental);
+  QVector<int> found;
+  if (incremental) {
+    int count = boxes.size();
+    int previousCount = previous.size();
+    int head = 0;
+    while (head < qMin(count, previousCount) &&
+           boxes.at(head) == previous.at(head))
+      ++head;
+    int tail = 0;
+    while (tail < qMin(count, previousCount) - head &&
+           boxes.at(count - 1 - tail) == previous.at(previousCount - 1 - tail))
+      ++tail;
+    // previous row -> current row (-1 for changed rows)
+    int shift = count - previousCount;
+    QVector<int> currentRow(previousCount, -1);
+    for (int row = 0; row < head; ++row)
+      currentRow[row] = row;
+    for (int row = previousCount - tail; row < previousCount; ++row)
+      currentRow[row] = row + shift;
+
+    QVector<QRect> dirty;
+    if (shift == 0) {
+      for (int row = head; row < count - tail; ++row) {
+        if (boxes.at(row) == previous.at(row)) {
+          currentRow[row] = row;
+          continue;
+        }
+        affected[row] = true;
+        dirty << boxRect(previous.at(row)) << rects.at(row);
+      }
+    } else {
+      for (int row = head; row < previousCount - tail; ++row)
+        dirty << boxRect(previous.at(row));
+      for (int row = head; row < count - tail; ++row) {
+        affected[row] = true;
+        dirty << rects.at(row);
+      }
+    }
+    for (int i = 0; i < dirty.size(); ++i) {
+      if (dirty.at(i).isNull())
+        continue;
+      found.clear();
+      grid.query(dirty.at(i), &found);
+      for (int k = 0; k < found.size(); ++k)
+        affected[rowOfRect.at(found.at(k))] = true;
+    }
+    for (int i = 0; i < previousProblems.size(); ++i) {
+      BoxProblem problem = previousProblems.at(i);
+      if (problem.m_type != bptDuplicate && problem.m_type != bptOverlap)
+        continue;
+      if (problem.m_row >= previousCount || problem.m_other < 1 ||
+          problem.m_other > previousCount)
+        continue;
+      int row = currentRow.at(problem.m_row);
+      int other = currentRow.at(problem.m_other - 1);
+      if (row < 0 || other < 0 || affected.at(row) || affected.at(other))
+        continue;
+      problem.m_row = row;
+      problem.m_line = row + 1;
+      problem.m_other = other + 1;
+      problems->append(problem);
+    }
+  }
+
+  // pair is reported for the later row; pair of two affected rows only once
+  for (int row = 0; row < boxes.size(); ++row) {
+    if (!affected.at(row) || rects.at(row).isNull())
+      continue;
+    found.clear();
+    grid.query(rects.at(row), &found);
+    for (int k = 0; k < found.size(); ++k) {
+      int other = rowOfRect.at(found.at(k));
+      if (other == row || (affected.at(other) && other < row))
+        continue;
+      int type = pairProblem(rects.at(row), rects.at(other));
+      if (type) {
+        int later = qMax(row, other);
+        BoxProblem problem = {boxProblemType(type), later + 1, page, later,
+                              qMin(row, other) + 1};
+        problems->append(problem);
+      }
+    }
+  }
+
+  findSizeOutliers(boxes, rects, problems);
+  sortProblems(problems);
+}
+
+QRect BoxValidator::boxRect(const QStringList& box) {
+  if (box.size() < 5)
+    return QRect();
+  int left = box.at(1).toInt();
+  int bottom = box.at(2).toInt();
+  int right = box.at(3).toInt();
+  int top = box.at(4).toInt();
+  if (left >= right || bottom >= top)
+    return QRect();
+  return QRect(QPoint(left, bottom), QPoint(right - 1, top - 1));
+}
+
+int BoxValidator::pairProblem(const QRect& a, const QRect& b) {
+  QRect common = a & b;
+  if (common.isEmpty())
+    return 0;
+  qint64 areaA = qint64(a.width()) * a.height();
+  qint64 areaB = qint64(b.width()) * b.height();
+  qint64 intersection = qint64(common.width()) * common.height();
+  if (intersection >= kDuplicateOverlap * (areaA + areaB - intersection))
+    return bptDuplicate;
+  if (intersection >= kOverlap * qMin(areaA, areaB))
+    return bptOverlap;
+  return 0;
+}
+
+/*
+ * Sizes of the same symbol (style flags are ignored) are compared with their
+ * median. Symbols with only a few boxes are not checked.
+ */
+void BoxValidator::findSizeOutliers(const BoxPage& boxes,
+                                    const QVector<QRect>& rects,
+                                    QVector<BoxProblem>* problems) {
+  QHash<QString, QVector<int> > rowsOfSymbol;
+  for (int row = 0; row < boxes.size(); ++row) {
+    if (rects.at(row).isNull())
+      continue;
+    bool bold, italic, underline;
+    rowsOfSymbol[BoxFile::stripStyleFlags(boxes.at(row).at(0), &bold,
+                                          &italic, &underline)].append(row);
+  }
+
+  QHash<QString, QVector<int> >::const_iterator it;
+  for (it = rowsOfSymbol.constBegin(); it != rowsOfSymbol.constEnd(); ++it) {
+    const QVector<int>& rows = it.value();
+    if (rows.size() < kMinSymbolSamples)
+      continue;
+    QVector<int> widths;
+    QVector<int> heights;
+    for (int i = 0; i < rows.size(); ++i) {
+      widths.append(rects.at(rows.at(i)).width());
+      heights.append(rects.at(rows.at(i)).height());
+    }
+    int middle = rows.size() / 2;
+    std::nth_element(widths.begin(), widths.begin() + middle, widths.end());
+    std::nth_element(heights.begin(), heights.begin() + middle,
+                     heights.end());
+    double width = widths.at(middle);
+    double height = heights.at(middle);
+    for (int i = 0; i < rows.size(); ++i) {
+      const QRect& r = rects.at(rows.at(i));
+      if (r.width() > kSizeRatio * width || r.width() * kSizeRatio < width ||
+          r.height() > kSizeRatio * height ||
+          r.height() * kSizeRatio < height) {
+        BoxProblem problem = {bptSize, rows.at(i) + 1,
+                              boxes.at(rows.at(i)).value(5).toInt(),
+                              rows.at(i), -1};
+        problems->append(problem);
+      }
+    }
+  }
+}
+
+void BoxValidator::sortProblems(QVector<BoxProblem>* problems) {
+  std::stable_sort(problems->begin(), problems->end(),
+                   [](const BoxProblem& a, const BoxProblem& b) {
+                     return a.m_line < b.m_line;
+                   });
+}
+
+QString BoxValidator::typeName(boxProblemType type) {
+  switch (type) {
+  case bptColumns:
+    return "columns";
+  case bptNumber:
+    return "number";
+  case bptInverted:
+    return "inverted";
+  case bptOutside:
+    return "outside";
+  case bptPage:
+    return "page";
+  case bptDuplicate:
+    return "duplicate";
+  case bptEmpty:
+    return "empty";
+  case bptOverlap:
+    return "overlap";
+  case bptSize:
+    return "size";
+  }
+  return QString();
+}
+
+QString BoxValidator::description(const BoxProblem& problem) {
+  switch (problem.m_type) {
+  case bptColumns:
+    return QObject::tr("wrong number of columns");
+  case bptNumber:
+    return QObject::tr("invalid number");
+  case bptInverted:
+    return QObject::tr("inverted coordinates");
+  case bptOutside:
+    return QObject::tr("box is outside of image");
+  case bptPage:
+    return QObject::tr("page is not in image");
+  case bptDuplicate:
+    return QObject::tr("duplicate of box at line %1").arg(problem.m_other);
+  case bptEmpty:
+    return QObject::tr("box has zero width or height");
+  case bptOverlap:
+    return QObject::tr("box overlaps box at line %1").arg(problem.m_other);
+  case bptSize:
+    return QObject::tr("size differs from other boxes of the symbol");
+  }
+  return QString();
+}
@@ -0,0 +1,107 @@
+/**********************************************************************
+* File:        BoxValidator.h
+* Description: Consistency checks of box files
+* Author:      Zdenko Podobny
+* Created:     2026-10-19
+*
+* (C) Copyright 2026, Zdenko Podobny
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**    http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*
+**********************************************************************/
+
+
+#ifndef SRC_BOXVALIDATOR_H_
+#define SRC_BOXVALIDATOR_H_
+
+#include <QMetaType>
+#include <QRect>
+#include <QSize>
+#include <QString>
+#include <QVector>
+
+#include "BoxFile.h"
+
+enum boxProblemType {
+    bptColumns = 1,    // wrong number of columns in line
+    bptNumber,         // coordinate or page is not a number
+    bptInverted,       // left > right or bottom > top
+    bptOutside,        // box is outside of image
+    bptPage,           // page index is not in image
+    bptDuplicate,      // box overlaps other box of the same size
+    bptEmpty,          // zero width or height
+    bptOverlap,        // box covers big part of other (smaller) box
+    bptSize            // size is far from other boxes of the same symbol
+};
+
+struct BoxProblem {
+    boxProblemType m_type;
+    int m_line;        // line in box file (1-based)
+    int m_page;        // index of page in BoxPages
+    int m_row;         // row in page
+    int m_other;       // line of other box (duplicate, overlap) or -1
+};
+Q_DECLARE_METATYPE(QVector<BoxProblem>)
+
+/*
+ * Checks used by batch validation (--validate) and by editor. Box file is
+ * parsed line by line and only image headers are read.
+ */
+class BoxValidator {
+  public:
+    static bool validateFile(const QString& boxFileName,
+                             const QString& imageFileName,
+                             QVector<BoxProblem>* problems, QString* error);
+    // Check boxes which are already loaded (wrong lines are not possible)
+    static void validatePages(const BoxPages& pages,
+                              const QVector<QSize>& pageSizes,
+                              QVector<BoxProblem>* problems);
+    /** Check of page edited in GUI (line is row + 1). Duplicates and overlaps
+     *  of previous check of the same page are kept for rows far from rows
+     *  changed since then; only boxes near changed rows are compared again.
+     */
+    static void checkPage(const BoxPage& boxes, const QSize& pageSize,
+                          const BoxPage& previous,
+                          const QVector<BoxProblem>& previousProblems,
+                          QVector<BoxProblem>* problems);
+
+    static QString typeName(boxProblemType type);
+    static QString description(const BoxProblem& problem);
+
+  private:
+    struct Box {
+        int line;
+        int row;
+        int left;
+        int bottom;
+        int right;
+        int top;
+    };
+    // Check coordinates of one box; returns false if box is not usable
+    static bool checkBox(const QStringList& box, int line, int page, int row,
+                         const QVector<QSize>& pageSizes, Box* result,
+                         QVector<BoxProblem>* problems);
+    static void findDuplicates(QVector<Box>* boxes, int page,
+                               QVector<BoxProblem>* problems);
+    // Box as rectangle (box coordinates); null if box is not usable
+    static QRect boxRect(const QStringList& box);
+    // Duplicate or overlap of two boxes (0 if there is no problem)
+    static int pairProblem(const QRect& a, const QRect& b);
+    static void findSizeOutliers(const BoxPage& boxes,
+                                 const QVector<QRect>& rects,
+                                 QVector<BoxProblem>* problems);
+    // Problems ordered by line of box file
+    static void sortProblems(QVector<BoxProblem>* problems);
+};
+
+#endif  // SRC_BOXVALIDATOR_H_
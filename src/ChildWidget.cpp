@@ -27,13 +27,31 @@
 #include <algorithm>
 #include <leptonica/allheaders.h>
 
+#include <QRegularExpression>
+#include <QRunnable>
+
 #include "ChildWidget.h"
+#include "BoxFile.h"
+#include "BoxProposer.h"
+#include "BoxValidator.h"
+#include "PageLayout.h"
+#include "PageStrip.h"
 #include "Settings.h"
+#include "SymbolTokenizer.h"
 #include "DelegateEditors.h"
+#include "DocumentLoader.h"
+#include "GlyphClusters.h"
+#include "GlyphGallery.h"
+#include "ImageCache.h"
+#include "InkMap.h"
+#include "PerfCounters.h"
 #include "TessTools.h"
+#include "Trace.h"
 #include "dialogs/SettingsDialog.h"
 #include "dialogs/GetRowIDDialog.h"
 #include "dialogs/FindDialog.h"
+#include "dialogs/SymbolStatsDialog.h"
+#include "dialogs/ClusterDialog.h"
 #include "dialogs/DrawRectangle.h"
 
 // This allows storing QGraphicsRectItem's in table model data
@@ -42,6 +60,32 @@ Q_DECLARE_METATYPE(QGraphicsRectItem*)
 // Print debug message
 int DMESS = 10;
 
+class GlyphClusterJob : public QRunnable {
+  public:
+    GlyphClusterJob(ChildWidget* child, const QString& imageFile,
+                    const BoxPages& pages, double similarity)
+        : m_child(child), m_imageFile(imageFile), m_pages(pages),
+          m_similarity(similarity) {
+    }
+
+    void run() {
+        QString imageFile = m_imageFile;
+        QVector<GlyphCluster> clusters = GlyphClusters::mixedClusters(
+          [imageFile](int page) {
+            return ImageCache::image(imageFile, page);
+          }, m_pages, m_similarity);
+        QMetaObject::invokeMethod(m_child, "glyphsClustered",
+                                  Qt::QueuedConnection,
+                                  Q_ARG(QVector<GlyphCluster>, clusters));
+    }
+
+  private:
+    ChildWidget* m_child;
+    QString m_imageFile;
+    BoxPages m_pages;
+    double m_similarity;
+};
+
 // Min/max macros
 int my_min(int arg1, int arg2) {
   return((arg1 < arg2) ? arg1 : arg2);
@@ -51,6 +95,23 @@ int my_max(int arg1, int arg2) {
   return((arg1 > arg2) ? arg1 : arg2);
 }
 
+// Check if symbol font flags fits to filter from Find dialog
+bool matchStyleFilter(int styleFilter, bool bold, bool italic,
+                      bool underline) {
+  switch (styleFilter) {
+  case rsfNormal:
+    return !bold && !italic && !underline;
+  case rsfBold:
+    return bold;
+  case rsfItalic:
+    return italic;
+  case rsfUnderline:
+    return underline;
+  default:
+    return true;
+  }
+}
+
 // STATICS INITIALIZATION
 const Qt::CursorShape DragResizer::gripCursor[dirCount] = {
   Qt::SizeHorCursor, Qt::SizeBDiagCursor, Qt::SizeVerCursor,
@@ -61,7 +122,7 @@ const Qt::CursorShape DragResizer::gripCursor[dirCount] = {
 ////////////////////////////////////////////////////////////////////////////////
 
 void DragResizer::init(QGraphicsScene* scene) {
-  if (DMESS > 10) qDebug() << Q_FUNC_INFO;
+  TRACE_SPAN(tcRender);
   // NOTE: QGraphicsScene takes ownership for all these objects
 
   // This is required to be able to process all drag rectangles' messages
@@ -82,7 +143,7 @@ void DragResizer::init(QGraphicsScene* scene) {
 }
 
 void DragResizer::setFromRect(const QRect& arect) {
-  if (DMESS > 10) qDebug() << Q_FUNC_INFO;
+  TRACE_SPAN(tcRender);
   rect = arect;
 
   gripRect[dirE]->setRect(rect.right() - gripMargin,
@@ -123,13 +184,11 @@ void DragResizer::setFromRect(const QRect& arect) {
 }
 
 void DragResizer::disable() {
-  if (DMESS > 10) qDebug() << Q_FUNC_INFO;
   for (int i = 0; i < dirCount; ++i)
     gripRect[i]->setVisible(false);
 }
 
 bool DragResizer::enabled() {
-  if (DMESS > 10) qDebug() << Q_FUNC_INFO;
   return gripRect[0]->isVisible();
 }
 
@@ -187,6 +246,7 @@ bool DragResizer::sceneEventFilter(QGraphicsItem* watched, QEvent* event) {
     return true;
   case QEvent::GraphicsSceneMouseRelease:
     setFromRect(rect);
+    emit finished();
     return true;
   default:
     break;
@@ -199,7 +259,7 @@ bool DragResizer::sceneEventFilter(QGraphicsItem* watched, QEvent* event) {
 
 ChildWidget::ChildWidget(QWidget* parent)
   : QSplitter(Qt::Horizontal, parent) {
-  if (DMESS > 10) qDebug() << Q_FUNC_INFO;
+  TRACE_SPAN(tcModel);
   table = new QTableView;
   table->resize(1, 1);
   table->setAlternatingRowColors(true);
@@ -214,7 +274,7 @@ ChildWidget::ChildWidget(QWidget* parent)
   // Make graphics Scene and View
   imageScene = new QGraphicsScene;
   imageScene->installEventFilter(this);
-  imageView = new QGraphicsView(imageScene);
+  imageView = new ImageView(imageScene);
   imageView->setTransformationAnchor(QGraphicsView::AnchorUnderMouse);
   imageView->setRenderHints(QPainter::Antialiasing |
                             QPainter::SmoothPixmapTransform);
@@ -224,6 +284,7 @@ ChildWidget::ChildWidget(QWidget* parent)
   resizer = new DragResizer;
   resizer->init(imageScene);
   connect(resizer, SIGNAL(changed()), this, SLOT(boxDragChanged()));
+  connect(resizer, SIGNAL(finished()), this, SLOT(boxDragFinished()));
 
   readSettings();
 
@@ -308,13 +369,29 @@ ChildWidget::ChildWidget(QWidget* parent)
   QVBoxLayout* verticalLayout = new QVBoxLayout(tableWidget);
   verticalLayout->setContentsMargins(0, 0, 0, 0);
   verticalLayout->addWidget(table);
+  m_problemList = new QListWidget(tableWidget);
+  m_problemList->setUniformItemSizes(true);
+  m_problemList->setMaximumHeight(120);
+  m_problemList->hide();
+  connect(m_problemList, SIGNAL(itemClicked(QListWidgetItem*)), this,
+          SLOT(problemClicked(QListWidgetItem*)));
+  verticalLayout->addWidget(m_problemList);
   verticalLayout->addLayout(gridLayout);
 
   // Image part of display
   QWidget* imageWidget = new QWidget(this);
   QVBoxLayout* imageLayout = new QVBoxLayout(imageWidget);
   imageLayout->setContentsMargins(0, 0, 0, 2);
+  m_loadProgress = new QProgressBar(imageWidget);
+  m_loadProgress->setRange(0, DocumentLoader::kLoadSteps);
+  m_loadProgress->hide();
+  imageLayout->addWidget(m_loadProgress);
   imageLayout->addWidget(imageView);
+  m_pageStrip = new PageStrip(imageWidget);
+  m_pageStrip->hide();
+  connect(m_pageStrip, SIGNAL(pageActivated(int)), this,
+          SLOT(pageStripActivated(int)));
+  imageLayout->addWidget(m_pageStrip);
 
   pageWidget = new QWidget(this);
   QHBoxLayout* pageControlLayout = new QHBoxLayout();
@@ -349,6 +426,10 @@ ChildWidget::ChildWidget(QWidget* parent)
   symbolShown = true;
   directTypingMode = false;
   f_dialog = 0;
+  m_statsDialog = 0;
+  m_gallery = 0;
+  m_loadId = 0;
+  m_clusterDialog = 0;
   m_DrawRectangle = 0;
   rectangle = 0;
   vertLineLeft = 0;
@@ -359,14 +440,39 @@ ChildWidget::ChildWidget(QWidget* parent)
 
   rubberBand = new QRubberBand(QRubberBand::Rectangle, imageView);
 
-  m_undostack.SetRedoStack(&m_redostack);
-  bIsSpinBoxChanged = false;
-  bIsLineEditChanged = false;
+  m_editRow = -1;
+  m_editByDrag = false;
+  m_undostack.setJournal(&m_journal);
+  m_linter = new BoxLinter(this);
+  connect(m_linter, SIGNAL(finished(QVector<BoxProblem>)), this,
+          SLOT(boxesChecked(QVector<BoxProblem>)));
+  connect(m_linter, SIGNAL(pageChecked(int, QVector<BoxProblem>)), this,
+          SLOT(pageChecked(int, QVector<BoxProblem>)));
+  m_checkTimer = new QTimer(this);
+  m_checkTimer->setSingleShot(true);
+  m_checkTimer->setInterval(500);
+  connect(m_checkTimer, SIGNAL(timeout()), this, SLOT(startPageCheck()));
+  m_suspended = false;
+  m_suspendedRow = 0;
+  m_inkMapKey = 0;
+  m_perfHudTimer = new QTimer(this);
+  m_perfHudTimer->setInterval(500);
+  connect(m_perfHudTimer, SIGNAL(timeout()), this, SLOT(updatePerfHud()));
   fileWatcher = 0;
+  qRegisterMetaType<QVector<GlyphCluster> >();
+  m_clusterPool.setMaxThreadCount(1);
+}
+
+/*
+ * Clustering job posts result to widget, so it must not outlive it
+ */
+ChildWidget::~ChildWidget() {
+  m_clusterPool.clear();
+  m_clusterPool.waitForDone();
 }
 
 void ChildWidget::initTable() {
-  if (DMESS > 10) qDebug() << Q_FUNC_INFO;
+  TRACE_SPAN(tcModel);
   model = new QStandardItemModel(0, 10, this);
   model->setHeaderData(0, Qt::Horizontal, tr("Letter"));
   model->setHeaderData(1, Qt::Horizontal, tr("Left"));
@@ -386,6 +492,18 @@ void ChildWidget::initTable() {
     this, SLOT(selectionChanged(const QItemSelection&, const QItemSelection&)));
   table->setSelectionModel(selectionModel);
   table->setSelectionBehavior(QAbstractItemView::SelectRows);
+  connect(model, SIGNAL(itemChanged(QStandardItem*)), this,
+          SLOT(modelItemChanged(QStandardItem*)));
+  m_checkSnapshot.clear();
+  m_snapshotValid = false;
+  connect(model, SIGNAL(dataChanged(QModelIndex, QModelIndex, QVector<int>)),
+          this, SLOT(snapshotRowsChanged(QModelIndex, QModelIndex)));
+  connect(model, SIGNAL(rowsInserted(QModelIndex, int, int)), this,
+          SLOT(snapshotRowsInserted(QModelIndex, int, int)));
+  connect(model, SIGNAL(rowsRemoved(QModelIndex, int, int)), this,
+          SLOT(snapshotRowsRemoved(QModelIndex, int, int)));
+  connect(model, SIGNAL(layoutChanged()), this, SLOT(invalidateSnapshot()));
+  connect(model, SIGNAL(modelReset()), this, SLOT(invalidateSnapshot()));
 
   table->hideColumn(5);
   table->hideColumn(6);
@@ -399,8 +517,6 @@ void ChildWidget::initTable() {
 
   connect(leDelegate, SIGNAL(led_editstarted()), this,
           SLOT(letterStartEdit()));
-  connect(leDelegate, SIGNAL(led_editfinished()), this,
-          SLOT(letterEditFinished()));
 
   SpinBoxDelegate* sbDelegate = new SpinBoxDelegate;
   // TODO(zdenop): setMaximum for delegates after changing box
@@ -410,8 +526,6 @@ void ChildWidget::initTable() {
   table->setItemDelegateForColumn(4, sbDelegate);
   connect(sbDelegate, SIGNAL(sbd_valueChanged(int)), this,
           SLOT(sbValueChanged(int)));
-  connect(sbDelegate, SIGNAL(sbd_editingFinished()), this,
-          SLOT(sbFinished()));
 
   CheckboxDelegate* cbDelegate = new CheckboxDelegate;
   table->setItemDelegateForColumn(6, cbDelegate);
@@ -422,7 +536,7 @@ void ChildWidget::initTable() {
 }
 
 void ChildWidget::readSettings() {
-  if (DMESS > 10) qDebug() << Q_FUNC_INFO;
+  TRACE_SPAN(tcIO);
   // Font for table
   QSettings settings(QSettings::IniFormat, QSettings::UserScope,
                      SETTING_ORGANIZATION, SETTING_APPLICATION);
@@ -491,6 +605,24 @@ void ChildWidget::readSettings() {
   }
   imageView->setBackgroundBrush(backgroundColor);
 
+  if (settings.contains("GUI/BackgroundCheck")) {
+    m_backgroundCheck = settings.value("GUI/BackgroundCheck").toBool();
+  } else {
+    m_backgroundCheck = true;
+  }
+
+  if (settings.contains("GUI/ProblemColor")) {
+    m_problemColor = settings.value("GUI/ProblemColor").value<QColor>();
+  } else {
+    m_problemColor = QColor(255, 160, 0, 96);
+  }
+
+  // Memory limit for undo/redo in MB
+  if (settings.contains("GUI/UndoMemoryLimit")) {
+    m_undostack.setMemoryLimit(
+      settings.value("GUI/UndoMemoryLimit").toLongLong() * 1024 * 1024);
+  }
+
   if (model->rowCount() > 0) {
     table->resizeRowsToContents();
     calculateTableWidth();
@@ -498,7 +630,7 @@ void ChildWidget::readSettings() {
 }
 
 void ChildWidget::calculateTableWidth() {
-  if (DMESS > 10) qDebug() << Q_FUNC_INFO;
+  TRACE_SPAN(tcRender);
   // set optimum size of table
   table->resizeColumnsToContents();
   int tableVisibleWidth = 0;
@@ -518,64 +650,89 @@ void ChildWidget::calculateTableWidth() {
   setSizes(splitterSizes);
 }
 void ChildWidget::updateColWidthsOnSplitter(int /*pos*/, int /*index*/) {
-  if (DMESS > 10) qDebug() << Q_FUNC_INFO;
+  TRACE_SPAN(tcRender);
   table->horizontalHeader()->resizeSections(QHeaderView::Stretch);
 }
 
 bool ChildWidget::loadImage(const QString& fileName) {
-  if (DMESS > 10) qDebug() << Q_FUNC_INFO;
-
-  QImage image;
-  FILE   *fp;
-  PIX    *pix;
-  char   *filein;
-  int    nPages = 0;
-
-  filein = fileName.toLocal8Bit().data();
-  fp = lept_fopen(filein, "rb");
-  if (fileFormatIsTiff(fp)) {
-    tiffGetCount(fp, &nPages);
-    pix = pixReadStreamTiff(fp, currPage);  // open first page
-    image = TessTools::PIX2qImage(pix);
-    pixDestroy(&pix);
-    lept_fclose(fp);
-  } else {
-    //  pixReadStream/PIX2qImage was not able to display png image
-    //  So lets use QImage for other format than tiff...
-    image.load(fileName);
-  }
+  TRACE_SPAN(tcIO);
+  PerfTimer perfTimer(pcLoadTime);
+  return attachDocument(DocumentLoader::read(fileName));
+}
+
+/*
+ * Placeholder with progress is shown until document is read by worker
+ * (DocumentLoader) and attached by attachDocument().
+ */
+void ChildWidget::startLoading(const QString& fileName, int loadId) {
+  TRACE_SPAN(tcIO);
+  m_loadId = loadId;
+  setCurrentImageFile(fileName);
+  pageWidget->hide();
+  m_loadProgress->setFormat(tr("Loading %1: %p%")
+                            .arg(userFriendlyCurrentFile()));
+  m_loadProgress->setValue(0);
+  m_loadProgress->show();
+}
 
+void ChildWidget::setLoadProgress(int step) {
+  m_loadProgress->setValue(step);
+}
+
+// GUI part of loading: table model, scene and page controls
+bool ChildWidget::attachDocument(const LoadedDocument& document) {
+  TRACE_SPAN(tcModel);
+  m_loadId = 0;
+  m_loadProgress->hide();
+  QString fileName = document.m_imageFile;
+  QImage image = document.m_image;
   if (image.isNull()) {
-    QMessageBox::information(this, tr("Wrong file"),
-                             tr("Cannot load %1.").arg(fileName));
+    QMessageBox::information(this, tr("Wrong file"), document.m_error);
+    return false;
+  }
+  if (!document.m_error.isEmpty()) {
+    QMessageBox::warning(this, SETTING_APPLICATION, document.m_error);
     return false;
   }
+  int nPages = document.m_pageCount;
   if (nPages > 1) {
+    pageWidget->show();
     currentPage->setMaximum(nPages);
     currentPage->setMinimum(1);
     numberOfPages->setText(tr("of %1").arg(nPages));
     connect(currentPage, SIGNAL(valueChanged(int)), this,
             SLOT(slotChangePage(int)));
+    QSettings settings(QSettings::IniFormat, QSettings::UserScope,
+                       SETTING_ORGANIZATION, SETTING_APPLICATION);
+    if (!settings.contains("GUI/PageStrip") ||
+        settings.value("GUI/PageStrip").toBool()) {
+      m_pageStrip->stripModel()->setImage(fileName, nPages);
+      m_pageStrip->show();
+    }
   } else {
     pageWidget->hide();
   }
   imageHeight = image.height();
   imageWidth = image.width();
   setCurrentImageFile(fileName);
-  QString boxFileName = QFileInfo(fileName).path() + "/"  // QDir::separator()
-                        + QFileInfo(fileName).completeBaseName() + ".box";
+  QString boxFileName = document.m_boxFile;
 
-  if (!QFile::exists(boxFileName)) {
-      qCreateBoxes(boxFileName);
+  if (!document.m_hasBoxes) {
+    qCreateBoxes(boxFileName);
   } else {
-    if (!loadBoxes(boxFileName)) return false;
+    pages = document.m_pages;
+    m_savedPages = pages;
+    if (!fillTableData(0))
+      return false;
   }
 
   setCurrentBoxFile(boxFileName);
   setFileWatcher(boxFileName);
+  m_pageImage = image;
   imageItem = imageScene->addPixmap(QPixmap::fromImage(image));
   modified = false;
   emit modifiedChanged();
+  recoverJournal();
   connect(model, SIGNAL(itemChanged(QStandardItem*)), this,
           SLOT(emitBoxChanged()));
   connect(model, SIGNAL(itemChanged(QStandardItem*)), this,
@@ -584,7 +741,7 @@ bool ChildWidget::loadImage(const QString& fileName) {
 }
 
 bool ChildWidget::qCreateBoxes(const QString &boxFileName) {
-  if (DMESS > 10) qDebug() << Q_FUNC_INFO;
+  TRACE_SPAN(tcOCR);
   loadTable();
   save(boxFileName);
   modified = false;
@@ -593,21 +750,31 @@ bool ChildWidget::qCreateBoxes(const QString &boxFileName) {
 }
 
 bool ChildWidget::makeBoxPage() {
+  TRACE_SPAN(tcOCR);
   if (imageFile.isEmpty())
         return false;
-  QImage image;
-  if (pageWidget->isHidden()) {  // one page - QImage is ok
-    image.load(imageFile);
-  } else {  // multipage - use leptonica
-    PIX    *pix;
-    pix = pixReadTiff(imageFile.toLocal8Bit().data(), currPage);
-    image = TessTools::PIX2qImage(pix);
-    pixDestroy(&pix);
-  }
-
-  TessTools tt;
-  QString str = tt.makeBoxes(image, currPage);
-  if (str == "")
+  QImage image = ImageCache::image(imageFile, currPage);
+
+  QSettings settings(QSettings::IniFormat, QSettings::UserScope,
+                     SETTING_ORGANIZATION, SETTING_APPLICATION);
+  QString str;
+  bool components = settings.value("Boxes/Engine").toString() == "components";
+  if (!components) {
+    TessTools tt;
+    str = tt.makeBoxes(image, currPage);
+  }
+  // no tesseract (or language data for script) - use connected components
+  if (str.isEmpty()) {
+    BoxPage boxes = BoxProposer::propose(image, currPage,
+                                         BoxProposer::options(settings));
+    for (int i = 0; i < boxes.size(); ++i)
+      str += boxes.at(i).join(" ") + "\n";
+    if (!components && !boxes.isEmpty())
+      emit statusBarMessage(tr("Tesseract found no boxes on page %1; boxes "
+                               "were proposed from connected components.")
+                            .arg(currPage + 1));
+  }
+  if (str.isEmpty())
     return false;
 
   QTextStream boxdata(&str);
@@ -616,6 +783,7 @@ bool ChildWidget::makeBoxPage() {
 }
 
 void ChildWidget::loadTable() {
+  TRACE_SPAN(tcModel);
   bool showFontColumns = isFontColumnsShown();
   cleanTable();
   initTable();
@@ -628,46 +796,18 @@ void ChildWidget::loadTable() {
 }
 
 bool ChildWidget::readToVector(QTextStream &boxdata) {
-  if (DMESS > 10) qDebug() << Q_FUNC_INFO;
-  boxdata.setCodec("UTF-8");
-  QString data = boxdata.readAll();
-  QStringList lineBoxes = data.split(QRegExp("\n"),
-                                     Qt::SkipEmptyParts);
-  QString pagePrev = "0";
-  QVector<QStringList> page;
-
-  for (int i = 0; i < lineBoxes.size(); ++i) {
-    QString line = lineBoxes.at(i);
-    QStringList box = line.split(" ");
-    if (box.size() == 7) {
-        if (line.startsWith(" "))
-            box.removeFirst ();  // tess2image generate also box for spaces
-    } else if (box.size() != 6) {
-      qDebug() << "box:" << box;
-      QMessageBox::warning(this, SETTING_APPLICATION,
-                           tr("File can not be loaded because of wrong "
-                              "(non tesseract-ocr 3.02) box "
-                              "file format at line '%1'! (box.size: %2)")
-                              .arg(i + 1).arg (box.size()));
-      QApplication::restoreOverrideCursor();
-      return false;
-    }
-
-    if (box[5] == pagePrev) {
-      page.append(box);
-    } else {
-      pagePrev = box[5];
-      pages.append(page);
-      page.clear();
-      page.append(box);
-    }
+  TRACE_SPAN(tcModel);
+  QString error;
+  if (!BoxFile::read(boxdata, &pages, &error)) {
+    QMessageBox::warning(this, SETTING_APPLICATION, error);
+    QApplication::restoreOverrideCursor();
+    return false;
   }
-  pages.append(page);
   return true;
 }
 
 bool ChildWidget::fillTableData(int pageNum) {
-  if (DMESS > 10) qDebug() << Q_FUNC_INFO;
+  TRACE_SPAN(tcModel);
 
   if (pageNum > (pages.size() - 1)) {
     switch (QMessageBox::question(
@@ -709,24 +849,12 @@ bool ChildWidget::fillTableData(int pageNum) {
   for (int i = 0; i < pageData.size(); ++i) {
     QFont letterFont;
     QStringList pieces = pageData[i];
-    QString letter = pieces.value(0);
-    bool bold = false, italic = false, underline = false;
-    // formatting is present only in case there are more than 2 letters
-    if (letter.at(0) == '@' && letter.size() > 1) {
-      bold = true;
-      letterFont.setBold(true);
-      letter.remove(0, 1);
-    }
-    if (letter.at(0) == '$' && letter.size() > 1) {
-      italic = true;
-      letterFont.setItalic(true);
-      letter.remove(0, 1);
-    }
-    if (letter.at(0) == '\'' && letter.size() > 1) {
-      underline = true;
-      letterFont.setUnderline(true);
-      letter.remove(0, 1);
-    }
+    bool bold, italic, underline;
+    QString letter = BoxFile::stripStyleFlags(pieces.value(0), &bold, &italic,
+                                     &underline);
+    letterFont.setBold(bold);
+    letterFont.setItalic(italic);
+    letterFont.setUnderline(underline);
     int left = pieces.value(1).toInt();
     int bottom = imageHeight - pieces.value(2).toInt();
     int right = pieces.value(3).toInt();
@@ -760,11 +888,12 @@ bool ChildWidget::fillTableData(int pageNum) {
   table->setUpdatesEnabled(true);
 
   QApplication::restoreOverrideCursor();
+  scheduleCheck();
   return true;
 }
 
 bool ChildWidget::loadBoxes(const QString& fileName) {
-  if (DMESS > 10) qDebug() << Q_FUNC_INFO;
+  TRACE_SPAN(tcIO);
   QFile file(fileName);
 
   if (!file.open(QFile::ReadOnly | QFile::Text)) {
@@ -777,6 +906,7 @@ bool ChildWidget::loadBoxes(const QString& fileName) {
   if (!readToVector(boxdata)) {
     return false;
   }
+  m_savedPages = pages;
   if (!fillTableData(0)) {
     return false;
   }
@@ -785,7 +915,7 @@ bool ChildWidget::loadBoxes(const QString& fileName) {
 }
 
 void ChildWidget::setFileWatcher(const QString & fileName) {
-  if (DMESS > 10) qDebug() << Q_FUNC_INFO;
+  TRACE_SPAN(tcIO);
   if (fileWatcher) {
     fileWatcher->removePaths(fileWatcher->files());
   } else {
@@ -797,7 +927,7 @@ void ChildWidget::setFileWatcher(const QString & fileName) {
 }
 
 void ChildWidget::slotfileChanged(const QString &fileName) {
-  if (DMESS > 10) qDebug() << Q_FUNC_INFO;
+  TRACE_SPAN(tcIO);
   if (!QFile::exists(fileName)) {
       switch (QMessageBox::question(
                 this,
@@ -844,11 +974,16 @@ void ChildWidget::slotfileChanged(const QString &fileName) {
 }
 
 bool ChildWidget::reload(const QString& fileName) {
+  TRACE_SPAN(tcIO);
+  resume();
   if (boxesVisible) {
     drawBoxes();
   }
   deleteModelItemBox(table->currentIndex().row());
   bool showFontColumns = isFontColumnsShown();
+  // undo history is not valid for reloaded file
+  m_editRow = -1;
+  m_undostack.clear();
   model->clear();
   delete selectionModel;
   delete model;
@@ -859,6 +994,7 @@ bool ChildWidget::reload(const QString& fileName) {
   setShowFontColumns(showFontColumns);
   loadBoxes(fileName);
   updateSelectionRects();
+  m_journal.start(boxFile);
 
   modified = false;
   emit modifiedChanged();
@@ -869,207 +1005,64 @@ bool ChildWidget::reload(const QString& fileName) {
  * @brief reload current image/page from image file
   */
 bool ChildWidget::reloadImg() {
-  if (DMESS > 10) qDebug() << Q_FUNC_INFO;
-  imageScene->removeItem(static_cast<QGraphicsItem*>(imageItem));
-  delete imageItem;
-  QImage image;
-  if (pageWidget->isHidden()) {  // one page - QImage is ok
-    image.load(imageFile);
-  } else {  // multipage - use leptonica
-    PIX    *pix;
-    pix = pixReadTiff(imageFile.toLocal8Bit().data(), currPage);
-    image = TessTools::PIX2qImage(pix);
-    pixDestroy(&pix);
+  TRACE_SPAN(tcIO);
+  if (imageItem) {
+    imageScene->removeItem(static_cast<QGraphicsItem*>(imageItem));
+    delete imageItem;
   }
-  imageItem = imageScene->addPixmap(QPixmap::fromImage(image));
+  m_pageImage = ImageCache::image(imageFile, currPage);
+  imageItem = imageScene->addPixmap(QPixmap::fromImage(m_pageImage));
   return true;
 }
 
 bool ChildWidget::save(const QString& fileName) {
   // TODO(zdenop): support multipage!
-  if (DMESS > 10) qDebug() << Q_FUNC_INFO;
+  TRACE_SPAN(tcIO);
+  PerfTimer perfTimer(pcSaveTime);
 
   storePage();
-  QFile file(fileName);
-  if (!file.open(QFile::WriteOnly)) {
-    QMessageBox::warning(
-      this,
-      SETTING_APPLICATION,
-      tr("Cannot write file %1:\n%2.").arg(fileName).arg(file.errorString()));
-    return false;
-  }
-
   if (fileWatcher) {
     delete fileWatcher;
     fileWatcher = 0;
   }
 
-  QTextStream out(&file);
-  out.setCodec("UTF-8");
+  QString error;
   QApplication::setOverrideCursor(Qt::WaitCursor);
-
-  for (int i = 0; i < pages.size(); ++i) {
-    QVector<QStringList> page = pages[i];
-    for (int j = 0; j < page.size(); ++j) {
-      QStringList box = page[j];
-      for ( QStringList::Iterator it = box.begin(); it != box.end(); ++it ) {
-        out << *it;
-        if (it != (box.end() - 1))
-          out << " ";
-      }
-      out << "\n";
-    }
-  }
-
-  file.close();
+  bool saved = BoxFile::save(fileName, pages, &error);
   QApplication::restoreOverrideCursor();
+  if (!saved) {
+    QMessageBox::warning(this, SETTING_APPLICATION, error);
+    return false;
+  }
 
   modified = false;
   emit modifiedChanged();
+  m_savedPages = pages;
+  scheduleCheck();  // clear modification markers of pages
   setFileWatcher(fileName);
+  // saved edits are not needed for recovery
+  if (QFileInfo(fileName).canonicalFilePath() == boxFile)
+    m_journal.start(boxFile);
   return true;
 }
 
 bool ChildWidget::splitToFeatureBF(const QString& fileName) {
-  if (DMESS > 10) qDebug() << Q_FUNC_INFO;
-  // Todo(zdenop): there must be a smarter way how to do this
-
+  TRACE_SPAN(tcIO);
+  storePage();
+  QString error;
   QApplication::setOverrideCursor(Qt::WaitCursor);
-  QString normBoxes = "", boldBoxes = "", italicBoxes = "", boldItaBoxes = "";
-  QString underBoxes = "";
-  for (int row = 0; row < model->rowCount(); ++row) {
-    QString letter = model->index(row, 0).data().toString();
-    int left = model->index(row, 1).data().toInt();
-    int bottom = model->index(row, 2).data().toInt();
-    int right = model->index(row, 3).data().toInt();
-    int top = model->index(row, 4).data().toInt();
-    int page = model->index(row, 5).data().toInt();
-    bool italic = model->index(row, 6).data().toBool();
-    bool bold = model->index(row, 7).data().toBool();
-    bool underline = model->index(row, 8).data().toBool();
-
-    if (bold && !italic) {
-      boldBoxes += QString("%1 %2 %3 %4 %5 %6\n").arg(letter).arg(left)
-                   .arg(imageHeight - bottom).arg(right).arg(imageHeight - top)
-                   .arg(page);
-    } else if (italic && !bold) {
-      italicBoxes += QString("%1 %2 %3 %4 %5 %6\n").arg(letter).arg(left)
-                     .arg(imageHeight - bottom).arg(right)
-                     .arg(imageHeight - top).arg(page);
-    } else if (italic && bold) {
-      boldItaBoxes += QString("%1 %2 %3 %4 %5 %6\n").arg(letter).arg(left)
-                      .arg(imageHeight - bottom).arg(right)
-                      .arg(imageHeight - top).arg(page);
-    } else if (underline) {
-      underBoxes += QString("%1 %2 %3 %4 %5 %6\n").arg(letter).arg(left)
-                    .arg(imageHeight - bottom).arg(right).arg(imageHeight - top)
-                    .arg(page);
-    } else {
-      normBoxes += QString("%1 %2 %3 %4 %5 %6\n").arg(letter).arg(left)
-                   .arg(imageHeight - bottom).arg(right).arg(imageHeight - top)
-                   .arg(page);
-    }
-  }
-
-  // find path + name + ext:
-  int dotCount = QFileInfo(fileName).fileName().count(".");
-  QStringList results = QFileInfo(fileName).fileName().split(".");
-  QString path, base, ext, imgExt;
-  path = QFileInfo(fileName).path() + QDir::separator();
-
-  if (dotCount < 3) {
-    base = QFileInfo(fileName).baseName();
-    ext = QFileInfo(fileName).completeSuffix();
-  } else  {
-    for (int dot = 0; dot < (dotCount - 1); ++dot) {
-      base += results[dot];
-      if (dot < (dotCount - 2))
-        base += ".";
-    }
-    ext = results[(dotCount - 1)] + "." + results[dotCount];
-  }
-  imgExt = ext;
-  imgExt.replace(imgExt.size() - 3 , 3, "png");
-
-  if (normBoxes.size()) {
-    saveString(path + base + "normal." + ext, normBoxes);
-    createStringImage(path + base + "normal." + imgExt, normBoxes);
-  }
-
-  if (boldBoxes.size()) {
-    saveString(path + base + "bold." + ext, boldBoxes);
-    createStringImage(path + base + "bold." + imgExt, boldBoxes);
-  }
-
-  if (italicBoxes.size()) {
-    saveString(path + base + "italic." + ext, italicBoxes);
-    createStringImage(path + base + "italic." + imgExt, italicBoxes);
-  }
-
-  if (boldItaBoxes.size()) {
-    saveString(path + base + "bolditalic." + ext, boldItaBoxes);
-    createStringImage(path + base + "bolditalic." + imgExt, boldItaBoxes);
-  }
-
-  if (underBoxes.size()) {
-    saveString(path + base + "underline." + ext, underBoxes);
-    createStringImage(path + base + "underline." + imgExt, underBoxes);
-  }
-
+  bool saved = BoxFile::splitByFont(fileName, pages.value(currPage),
+                                    m_pageImage, &error);
   QApplication::restoreOverrideCursor();
-  return true;
-}
-
-bool ChildWidget::saveString(const QString& fileName, const QString& qData) {
-  if (DMESS > 10) qDebug() << Q_FUNC_INFO;
-  QFile file(fileName);
-
-  if (!file.open(QFile::WriteOnly | QFile::Text)) {
-    QMessageBox::warning(
-      this,
-      SETTING_APPLICATION,
-      tr("Cannot write file %1:\n%2.").arg(fileName).arg(file.errorString()));
+  if (!saved) {
+    QMessageBox::warning(this, SETTING_APPLICATION, error);
     return false;
   }
-
-  QTextStream out(&file);
-  out.setCodec("UTF-8");
-  out << qData;
-  file.close();
-  return true;
-}
-
-/*
- * Copy defined boxes to new image file
- */
-
-bool ChildWidget::createStringImage(const QString& fileName,
-                                    const QString& qData) {
-  if (DMESS > 10) qDebug() << Q_FUNC_INFO;
-  QImage image = gItem2qImage();
-  QImage result = image;
-  result.fill(Qt::white);
-
-  QPainter painter(&result);
-  QStringList rowOfData = qData.split("\n");
-  for (int x = 0; x < rowOfData.size(); x++) {
-    QStringList rowData = rowOfData.at(x).split(" ");
-    if (rowData.size() < 4)
-            continue;  // skip rows without enough items
-    int x0 = rowData[1].toInt();
-    int y0 = imageHeight - rowData[2].toInt();
-    int w = rowData[3].toInt() - x0;
-    int h = rowData[4].toInt() - rowData[2].toInt() ;
-    QImage srcImage = image.copy(x0, y0 - h, w, h);
-    painter.drawImage(QPoint(x0, y0 - h), srcImage);
-  }
-  painter.end();
-  result.save(fileName, 0);
   return true;
 }
 
 bool ChildWidget::importSPLToChild(const QString& fileName) {
-  if (DMESS > 10) qDebug() << Q_FUNC_INFO;
+  TRACE_SPAN(tcIO);
   QFile file(fileName);
 
   if (!file.open(QFile::ReadOnly | QFile::Text)) {
@@ -1085,43 +1078,30 @@ bool ChildWidget::importSPLToChild(const QString& fileName) {
   // format_1: 1 line = 1 symbol
   // format_2: 1 letter = 1 symbol
 
-  QApplication::setOverrideCursor(Qt::WaitCursor);
   QString line;
-  int row = 0;
+  QStringList symbols;
   do {
     line = in.readLine();
-    if (!line.isEmpty()) {
-      if (row > model->rowCount()) {
-        QMessageBox::warning(this, SETTING_APPLICATION,
-                             tr("There are more symbols in import file than " \
-                                "boxes!\nRest of symbols are ignored."));
-        file.close();
-        QApplication::restoreOverrideCursor();
-        return true;
-      }
-      model->setData(model->index(row, 0, QModelIndex()), line);
-      row++;
-    }
+    if (!line.isEmpty())
+      symbols.append(line);
   } while (!line.isEmpty());
+  file.close();
 
-  if (row < model->rowCount()) {
+  setSymbols(symbols, tr("Import symbols"));
+  if (symbols.size() > model->rowCount()) {
+    QMessageBox::warning(this, SETTING_APPLICATION,
+                         tr("There are more symbols in import file than " \
+                            "boxes!\nRest of symbols are ignored."));
+  } else if (symbols.size() < model->rowCount()) {
     QMessageBox::warning(this, SETTING_APPLICATION,
-                         tr("There are less symbols in import file than boxes!")
-                         .arg(fileName).arg(file.errorString()));
+                         tr("There are less symbols in import file than boxes!"));
   }
-
-  file.close();
-  QApplication::restoreOverrideCursor();
-
-  modified = true;
-  emit modifiedChanged();
-
   return true;
 }
 
 
 bool ChildWidget::importTextToChild(const QString& fileName) {
-  if (DMESS > 10) qDebug() << Q_FUNC_INFO;
+  TRACE_SPAN(tcIO);
   // TODO(zdenop): code clean up, and join with importSPLToChild
 
   QSettings settings(QSettings::IniFormat, QSettings::UserScope,
@@ -1141,67 +1121,54 @@ bool ChildWidget::importTextToChild(const QString& fileName) {
     runSettingsDialog->exec();
   }
 
-  QList<QString> ligatures = settings.value("Text/Ligatures").toString()
-                             .split("\n");
+  QStringList ligatures = settings.value("Text/Ligatures").toString()
+                         .split("\n", Qt::SkipEmptyParts);
 
   QTextStream in(&file);
   in.setCodec("UTF-8");
 
   QApplication::setOverrideCursor(Qt::WaitCursor);
-  QString line;
-  QString symbolText;
-
-  do {
-    line = in.readLine();
-    if (!line.isEmpty()) {
-      symbolText += line;
-    }
-  } while (!line.isEmpty());
+  QStringList symbols = SymbolTokenizer::tokenize(&in, ligatures);
   file.close();
+  QApplication::restoreOverrideCursor();
 
-  // check if there are ligatures in line
-  for (int i = 0; i < ligatures.size(); ++i) {
-    symbolText.replace(ligatures[i], QString("\n%1\n").arg(ligatures[i]));
-  }
-
-  QStringList lines;
-  QString oneLetter, letters;
-  QList<QString> symbols;
-
-  lines = symbolText.split("\n");  // split string to lines
-  for (int i = 0; i < lines.size(); ++i) {
-    letters = lines.at(i);
-    bool ligature = false;
-    for (int m = 0; m < ligatures.size(); ++m) {
-      if (ligatures.at(m) == letters) {  // this is ligature
-        symbols.append(letters);
-        ligature = true;
-      }
-    }
-    if (ligature == false) {
-      letters = letters.remove(QRegExp("\\s+"));  // remove whitespace
-      for (int j = 0; j < letters.size(); ++j) {  // split lines to letters
-        oneLetter = letters[j];
-        symbols.append(oneLetter);
-      }
-    }
-  }
   if (symbols.size() != model->rowCount()) {
     QMessageBox::warning(this, SETTING_APPLICATION,
                          tr("Number of symbols in import file differ with " \
                             "number of boxes!"));
   }
 
-  for (int i = 0; i < symbols.size(); ++i) {
-    model->setData(model->index(i, 0, QModelIndex()), symbols.at(i));
-  }
+  setSymbols(symbols, tr("Import text"));
+  return true;
+}
 
+/*
+ * Set symbols of current page from the first row as one undo step. Symbols
+ * over number of rows are ignored.
+ */
+void ChildWidget::setSymbols(const QStringList& symbols, const QString& text) {
+  TRACE_SPAN(tcModel);
+  QApplication::setOverrideCursor(Qt::WaitCursor);
+  commitRowEdit();
+  UndoCommand command;
+  command.m_text = text;
+  command.m_page = currPage;
+  int count = qMin(symbols.size(), model->rowCount());
+  for (int row = 0; row < count; ++row) {
+    QString letter = model->index(row, 0).data().toString();
+    if (letter != symbols.at(row)) {
+      UndoStep step = {euoChange, row, 0, letter, symbols.at(row)};
+      command.m_steps.append(step);
+    }
+  }
+  if (!command.m_steps.isEmpty()) {
+    applyUndoSteps(command.m_steps, false);
+    m_undostack.push(command);
+    updateSelectionRects();
+    documentWasModified();
+    emit boxChanged();
+  }
   QApplication::restoreOverrideCursor();
-
-  modified = true;
-  emit modifiedChanged();
-
-  return true;
 }
 
 /**
@@ -1211,102 +1178,35 @@ bool ChildWidget::importTextToChild(const QString& fileName) {
    * 3 - one paragraph per line
    * Returns false if export was not possible for some reason.
    *
-   * Export will work only on one column text correctly.
-   * Words are identified if space between boxes is bigger than 6.
-   * Lines are identified if space between boxes is bigger than -6.
-   * Paragraph is identified based on left indentation (15) of from last left
-   * margin.
+   * All pages are exported. Lines, columns and reading order are found from
+   * box positions (see PageLayout); words are separated by Text/WordSpace
+   * and paragraphs by Text/ParagraphIndent.
 */
 bool ChildWidget::exportTxt(const int& eType, const QString& fileName) {
-  if (DMESS > 10) qDebug() << Q_FUNC_INFO;
-  QFile file(fileName);
-
-  if (!file.open(QFile::WriteOnly | QFile::Text)) {
-    QMessageBox::warning(
-      this,
-      SETTING_APPLICATION,
-      tr("Cannot write file %1:\n%2.").arg(boxFile).arg(file.errorString()));
-    return false;
-  }
-
-  QTextStream out(&file);
-  out.setCodec("UTF-8");
-  QApplication::setOverrideCursor(Qt::WaitCursor);
+  TRACE_SPAN(tcIO);
+  storePage();
   QSettings settings(QSettings::IniFormat, QSettings::UserScope,
                      SETTING_ORGANIZATION, SETTING_APPLICATION);
-  int line_start_prev = 0;
-  int line_end_prev = 0;
-  int right_prev = -1;
-  int last_bottom = -1;
   int wordSpace = settings.value("Text/WordSpace").toInt();
   int paraIndent = settings.value("Text/ParagraphIndent").toInt();
 
-  for (int row = 0; row < model->rowCount(); ++row) {
-    QString letter = model->index(row, 0).data().toString();
-    int left = model->index(row, 1).data().toInt();
-    int bottom = model->index(row, 2).data().toInt();
-    int right = model->index(row, 3).data().toInt();
-    int top = model->index(row, 4).data().toInt();
-
-    if (last_bottom == -1)
-      last_bottom = top;
-
-    if (eType == 1 && (right_prev != -1)) {
-      out << "\n";
-    }
-
-    // line by line
-    if (eType == 2) {
-      if (((left - right_prev) >= wordSpace) && (right_prev != -1)) {
-        // new word
-        out << " ";
-      } else if (((left - right_prev) <= (2 * (left - right))) &&
-                 (right_prev != -1)) {
-        // new line -> if negative difference is bigger than double of letter
-        // width
-        out << "\n";
-      }
-    }
-
-    if (eType == 3) {
-      if (((left - right_prev) >= wordSpace) && (right_prev != -1))
-        // new word
-        out << " ";
-
-      if (((left - right_prev) <= (2 * (left - right))) && (right_prev != -1)) {
-        // new line -> if negative difference is bigger than double of letter
-        // width
-        if (line_end_prev == 0)  // first line
-          line_end_prev = right;
-        if ((left - line_start_prev >= paraIndent) ||  // distance from left
-            (top - last_bottom >= paraIndent) ||   // distance between lines
-            (abs(right - line_end_prev) >= (paraIndent / 2)))
-          // distance from right
-          out << "\n";
-        else
-          out << " ";
-        line_start_prev = left;
-        line_end_prev = right_prev;
-      }
-    }
-
-    out << letter;
-    right_prev = right;
-    last_bottom = bottom;
-  }
-
-  out << "\n";
+  QString error;
+  QApplication::setOverrideCursor(Qt::WaitCursor);
+  bool saved = BoxFile::exportTxt(fileName, pages, eType, wordSpace,
+                                  paraIndent, &error);
   QApplication::restoreOverrideCursor();
+  if (!saved) {
+    QMessageBox::warning(this, SETTING_APPLICATION, error);
+    return false;
+  }
   return true;
 }
 
 bool ChildWidget::isBoxSelected() {
-  if (DMESS > 10) qDebug() << Q_FUNC_INFO;
   return selectionModel->hasSelection();
 }
 
 bool ChildWidget::isItalic() {
-  if (DMESS > 10) qDebug() << Q_FUNC_INFO;
   QModelIndex index = selectionModel->currentIndex();
 
   if (index.isValid()) {
@@ -1316,7 +1216,6 @@ bool ChildWidget::isItalic() {
 }
 
 bool ChildWidget::isBold() {
-  if (DMESS > 10) qDebug() << Q_FUNC_INFO;
   QModelIndex index = selectionModel->currentIndex();
 
   if (index.isValid()) {
@@ -1326,7 +1225,6 @@ bool ChildWidget::isBold() {
 }
 
 bool ChildWidget::isUnderLine() {
-  if (DMESS > 10) qDebug() << Q_FUNC_INFO;
   QModelIndex index = selectionModel->currentIndex();
 
   if (index.isValid()) {
@@ -1336,27 +1234,23 @@ bool ChildWidget::isUnderLine() {
 }
 
 bool ChildWidget::isShowSymbol() {
-  if (DMESS > 10) qDebug() << Q_FUNC_INFO;
   return symbolShown;
 }
 
 bool ChildWidget::isDirectTypingMode() {
-  if (DMESS > 10) qDebug() << Q_FUNC_INFO;
   return directTypingMode;
 }
 
 bool ChildWidget::isFontColumnsShown() {
-  if (DMESS > 10) qDebug() << Q_FUNC_INFO;
   return (!table->isColumnHidden(6));
 }
 
 void ChildWidget::setDirectTypingMode(bool v) {
-  if (DMESS > 10) qDebug() << Q_FUNC_INFO;
   directTypingMode = v;
 }
 
 void ChildWidget::setShowFontColumns(bool v) {
-  if (DMESS > 10) qDebug() << Q_FUNC_INFO;
+  TRACE_SPAN(tcRender);
   table->setColumnHidden(6, !v);
   table->setColumnHidden(7, !v);
   table->setColumnHidden(8, !v);
@@ -1365,130 +1259,136 @@ void ChildWidget::setShowFontColumns(bool v) {
 }
 
 bool ChildWidget::isDrawBoxes() {
-  if (DMESS > 10) qDebug() << Q_FUNC_INFO;
   return boxesVisible;
 }
 
 bool ChildWidget::isDrawRect() {
-  if (DMESS > 10) qDebug() << Q_FUNC_INFO;
   return drawnRectangle;
 }
 
+bool ChildWidget::isPerfHudVisible() {
+  return imageView->isHudVisible();
+}
+
 void ChildWidget::setItalic(bool v) {
-  if (DMESS > 10) qDebug() << Q_FUNC_INFO;
+  TRACE_SPAN(tcModel);
   QModelIndexList indexes = table->selectionModel()->selectedRows();
   QModelIndex index;
-  QFont letterFont;
 
+  beginUndoMacro(tr("Italic"));
   foreach(index, indexes) {
-    // IsItalic?
-    bool current = model->index(index.row(), 6).data().toBool();
-    if (current != v) {
-      UndoItem ui;
-      ui.m_eop = euoChange;
-      ui.m_origrow = index.row();
-
-      for (int ii = 0; ii < model->columnCount(); ii++)
-        ui.m_vdata[ii] = model->index(ui.m_origrow, ii).data();
-
-      m_undostack.push(ui);
-
-      letterFont = model->data(model->index(index.row(), 0, QModelIndex()),
-                               Qt::FontRole).value<QFont>();
-      letterFont.setItalic(v);
-      model->setData(model->index(index.row(), 0, QModelIndex()), letterFont,
-                     Qt::FontRole);
-      model->setData(model->index(index.row(), 6, QModelIndex()), v);
-    }
+    setCell(index.row(), 6, v);
   }
+  endUndoMacro();
 }
 
 void ChildWidget::setBolded(bool v) {
-  if (DMESS > 10) qDebug() << Q_FUNC_INFO;
+  TRACE_SPAN(tcModel);
   QModelIndexList indexes = table->selectionModel()->selectedRows();
   QModelIndex index;
-  QFont letterFont;
 
+  beginUndoMacro(tr("Bold"));
   foreach(index, indexes) {
-    // IsBool?
-    bool current = model->index(index.row(), 7).data().toBool();
-    if (current != v) {
-      UndoItem ui;
-      ui.m_eop = euoChange;
-      ui.m_origrow = index.row();
-
-      for (int ii = 0; ii < model->columnCount(); ii++)
-        ui.m_vdata[ii] = model->index(ui.m_origrow, ii).data();
-
-      m_undostack.push(ui);
-
-      letterFont = model->data(model->index(index.row(), 0, QModelIndex()),
-                               Qt::FontRole).value<QFont>();
-      letterFont.setBold(v);
-
-      model->setData(model->index(index.row(), 0, QModelIndex()), letterFont,
-                     Qt::FontRole);
-      model->setData(model->index(index.row(), 7, QModelIndex()), v);
-    }
+    setCell(index.row(), 7, v);
   }
+  endUndoMacro();
 }
 
 void ChildWidget::setUnderline(bool v) {
-  if (DMESS > 10) qDebug() << Q_FUNC_INFO;
+  TRACE_SPAN(tcModel);
   QModelIndexList indexes = table->selectionModel()->selectedRows();
   QModelIndex index;
-  QFont letterFont;
 
+  beginUndoMacro(tr("Underline"));
   foreach(index, indexes) {
-    // IsUnderLine?
-    bool current = model->index(index.row(), 8).data().toBool();
-    if (current != v) {
-      UndoItem ui;
-      ui.m_eop = euoChange;
-      ui.m_origrow = index.row();
-
-      for (int ii = 0; ii < model->columnCount(); ii++)
-        ui.m_vdata[ii] = model->index(ui.m_origrow, ii).data();
-
-      m_undostack.push(ui);
-
-      letterFont = model->data(model->index(index.row(), 0, QModelIndex()),
-                               Qt::FontRole).value<QFont>();
-      letterFont.setUnderline(v);
-      model->setData(model->index(index.row(), 0, QModelIndex()), letterFont,
-                     Qt::FontRole);
-      model->setData(model->index(index.row(), 8, QModelIndex()), v);
-    }
+    setCell(index.row(), 8, v);
   }
+  endUndoMacro();
 }
 
 /*
  * Replace original image with Thresholded image from tesseract
  */
 void ChildWidget::binarizeImage() {
-  if (DMESS > 10) qDebug() << Q_FUNC_INFO;
+  TRACE_SPAN(tcOCR);
   imageScene->removeItem(imageItem);
-  QImage image = gItem2qImage();
   delete imageItem;
-  QImage bImage = TessTools::GetThresholded(image);
-  imageItem = imageScene->addPixmap(QPixmap::fromImage(bImage));
+  m_pageImage = TessTools::GetThresholded(
+                  m_pageImage.convertToFormat(QImage::Format_RGB32));
+  imageItem = imageScene->addPixmap(QPixmap::fromImage(m_pageImage));
+}
+
+/*
+ * Binarized current page; it is built again only when page image changes
+ */
+const InkMap& ChildWidget::inkMap() {
+  if (m_inkMapKey != m_pageImage.cacheKey()) {
+    m_inkMap = InkMap(m_pageImage);
+    m_inkMapKey = m_pageImage.cacheKey();
+  }
+  return m_inkMap;
 }
 
 /*
- * Convert QGraphicsItem to QImage
+ * Shrink selected boxes to ink inside box extended by GUI/InkMargin pixels.
+ * Boxes without ink are not changed. It is one undo step.
  */
-QImage ChildWidget::gItem2qImage(){
-  if (DMESS > 10) qDebug() << Q_FUNC_INFO;
-  QImage image(imageItem->boundingRect().size().toSize(),  QImage::Format_RGB32);
-  QPainter painter(&image);
-  QStyleOptionGraphicsItem styleOption;
-  imageItem->paint(&painter, &styleOption);
-  painter.end();
-  return image;
+void ChildWidget::fitToInk() {
+  TRACE_SPAN(tcModel);
+  QVector<int> rows = selectedRowNumbers();
+  if (rows.isEmpty())
+    return;
+  QSettings settings(QSettings::IniFormat, QSettings::UserScope,
+                     SETTING_ORGANIZATION, SETTING_APPLICATION);
+  int margin = 2;
+  if (settings.contains("GUI/InkMargin"))
+    margin = settings.value("GUI/InkMargin").toInt();
+
+  QApplication::setOverrideCursor(Qt::WaitCursor);
+  commitRowEdit();
+  const InkMap& ink = inkMap();
+  UndoCommand command;
+  command.m_text = tr("Fit to ink");
+  command.m_page = currPage;
+  int fitted = 0;
+  for (int i = 0; i < rows.size(); ++i) {
+    int row = rows.at(i);
+    int left = model->index(row, 1).data().toInt();
+    int bottom = model->index(row, 2).data().toInt();
+    int right = model->index(row, 3).data().toInt();
+    int top = model->index(row, 4).data().toInt();
+    QRect bounds = ink.inkBounds(QRect(left, top, right - left, bottom - top)
+                                 .adjusted(-margin, -margin, margin, margin));
+    if (bounds.isNull())
+      continue;
+    int values[5] = {0, bounds.left(), bounds.bottom() + 1, bounds.right() + 1,
+                     bounds.top()};
+    bool changed = false;
+    for (int col = 1; col < 5; ++col) {
+      int before = model->index(row, col).data().toInt();
+      if (before != values[col]) {
+        UndoStep step = {euoChange, row, col, before, values[col]};
+        command.m_steps.append(step);
+        changed = true;
+      }
+    }
+    if (changed)
+      ++fitted;
+  }
+
+  if (!command.m_steps.isEmpty()) {
+    applyUndoSteps(command.m_steps, false);
+    m_undostack.push(command);
+    updateSelectionRects();
+    documentWasModified();
+    emit boxChanged();
+  }
+  QApplication::restoreOverrideCursor();
+  emit statusBarMessage(tr("%1 box(es) fitted to ink").arg(fitted));
 }
 
 void ChildWidget::setSelectionRect() {
-  if (DMESS > 10) qDebug() << Q_FUNC_INFO;
+  TRACE_SPAN(tcRender);
   QSettings settings(QSettings::IniFormat, QSettings::UserScope,
                      SETTING_ORGANIZATION, SETTING_APPLICATION);
   QFont imageFont = settings.value("GUI/ImageFont").value<QFont>();
@@ -1502,13 +1402,13 @@ void ChildWidget::setSelectionRect() {
 }
 
 void ChildWidget::setZoomStatus() {
-  if (DMESS > 10) qDebug() << Q_FUNC_INFO;
+  TRACE_SPAN(tcRender);
   qreal _zoomratio = imageView->transform().m11();
   emit zoomRatioChanged(_zoomratio);
 }
 
 void ChildWidget::setZoom(float scale) {
-  if (DMESS > 10) qDebug() << Q_FUNC_INFO;
+  TRACE_SPAN(tcRender);
   QTransform transform;
 
   transform.scale(scale, scale);
@@ -1518,7 +1418,7 @@ void ChildWidget::setZoom(float scale) {
 }
 
 void ChildWidget::zoomIn() {
-  if (DMESS > 10) qDebug() << Q_FUNC_INFO;
+  TRACE_SPAN(tcRender);
   imageView->scale(1.2, 1.2);
   if (selectionModel->hasSelection())
     imageView->ensureVisible(modelItemBox());
@@ -1526,7 +1426,7 @@ void ChildWidget::zoomIn() {
 }
 
 void ChildWidget::zoomOut() {
-  if (DMESS > 10) qDebug() << Q_FUNC_INFO;
+  TRACE_SPAN(tcRender);
   imageView->scale(1 / 1.2, 1 / 1.2);
   if (selectionModel->hasSelection())
     imageView->ensureVisible(modelItemBox());
@@ -1534,7 +1434,7 @@ void ChildWidget::zoomOut() {
 }
 
 void ChildWidget::zoomToFit() {
-  if (DMESS > 10) qDebug() << Q_FUNC_INFO;
+  TRACE_SPAN(tcRender);
   float viewWidth = imageView->viewport()->width();
   float viewHeight = imageView->viewport()->height();
   float zoomFactor;
@@ -1551,7 +1451,7 @@ void ChildWidget::zoomToFit() {
 }
 
 void ChildWidget::zoomToHeight() {
-  if (DMESS > 10) qDebug() << Q_FUNC_INFO;
+  TRACE_SPAN(tcRender);
   float viewHeight = imageView->viewport()->height();
   float zoomFactor = viewHeight / imageHeight;
 
@@ -1561,7 +1461,7 @@ void ChildWidget::zoomToHeight() {
 }
 
 void ChildWidget::zoomToWidth() {
-  if (DMESS > 10) qDebug() << Q_FUNC_INFO;
+  TRACE_SPAN(tcRender);
   float viewWidth = imageView->viewport()->width();
   float zoomFactor = viewWidth / imageWidth;
 
@@ -1571,14 +1471,14 @@ void ChildWidget::zoomToWidth() {
 }
 
 void ChildWidget::zoomOriginal() {
-  if (DMESS > 10) qDebug() << Q_FUNC_INFO;
+  TRACE_SPAN(tcRender);
   setZoom(1);
   if (selectionModel->hasSelection())
     imageView->ensureVisible(modelItemBox());
 }
 
 void ChildWidget::zoomToSelection() {
-  if (DMESS > 10) qDebug() << Q_FUNC_INFO;
+  TRACE_SPAN(tcRender);
   if (selectionModel->hasSelection()) {
     imageView->fitInView(modelItemBox(), Qt::KeepAspectRatio);
     imageView->scale(1 / 1.1, 1 / 1.1);    // make small border
@@ -1590,7 +1490,7 @@ void ChildWidget::zoomToSelection() {
 }
 
 void ChildWidget::showSymbol() {
-  if (DMESS > 10) qDebug() << Q_FUNC_INFO;
+  TRACE_SPAN(tcRender);
   if (symbolShown == false)
     symbolShown = true;
   else
@@ -1599,7 +1499,7 @@ void ChildWidget::showSymbol() {
 }
 
 void ChildWidget::drawRectangle(bool checked) {
-  if (DMESS > 10) qDebug() << Q_FUNC_INFO;
+  TRACE_SPAN(tcRender);
   if (checked) {
     if (!m_DrawRectangle) {
       m_DrawRectangle = new DrawRectangle(this, userFriendlyCurrentFile(),
@@ -1676,53 +1576,277 @@ void ChildWidget::drawRectangle(bool checked) {
   emit drawRectangleChoosen();
 }
 
-QGraphicsRectItem* ChildWidget::modelItemBox(int row) {
-  if (DMESS > 10) qDebug() << Q_FUNC_INFO;
-  if (selectionModel->hasSelection()) {
-    if (row == -1)
-      row = table->selectionModel()->selectedRows().last().row();
-    return model->index(row, 9).data().value<QGraphicsRectItem*>();
+void ChildWidget::setPerfHudVisible(bool v) {
+  imageView->setHudVisible(v);
+  if (v) {
+    updatePerfHud();
+    m_perfHudTimer->start();
   } else {
-    return NULL;
+    m_perfHudTimer->stop();
   }
 }
 
-QGraphicsRectItem* ChildWidget::createModelItemBox(int row) {
-  if (DMESS > 10) qDebug() << Q_FUNC_INFO;
-  int left = model->index(row, 1).data().toInt();
-  int bottom = model->index(row, 2).data().toInt();
-  int right = model->index(row, 3).data().toInt();
-  int top = model->index(row, 4).data().toInt();
-  QGraphicsRectItem* rectItem =
-    imageScene->addRect(left, top, right - left, bottom - top, QPen(boxColor));
-  rectItem->setZValue(2);
-  rectItem->hide();
+/*
+ * Collect data for performance overlay. It is called by timer only while
+ * overlay is shown.
+ */
+void ChildWidget::updatePerfHud() {
+  qint64 hits = PerfCounters::value(pcCacheHits);
+  qint64 lookups = hits + PerfCounters::value(pcCacheMisses);
 
-  model->setData(model->index(row, 9), QVariant::fromValue(rectItem));
+  QStringList lines;
+  lines << tr("Frame:         %1 ms")
+           .arg(imageView->frameTime() / 1e6, 0, 'f', 1)
+        << tr("Scene items:   %1").arg(imageScene->items().size())
+        << tr("Visible boxes: %1").arg(imageView->visibleBoxes())
+        << tr("Image memory:  %1 MB").arg(imageBytes() / 1048576.0, 0, 'f', 1)
+        << tr("Cache hits:    %1").arg(lookups > 0 ?
+                                       tr("%1 %").arg(100 * hits / lookups) :
+                                       tr("n/a"))
+        << tr("Last load:     %1 ms")
+           .arg(PerfCounters::value(pcLoadTime) / 1e6, 0, 'f', 1)
+        << tr("Last save:     %1 ms")
+           .arg(PerfCounters::value(pcSaveTime) / 1e6, 0, 'f', 1)
+        << tr("Page change:   %1 ms")
+           .arg(PerfCounters::value(pcPageTime) / 1e6, 0, 'f', 1)
+        << tr("Undo memory:   %1 kB").arg(m_undostack.memoryUsage() / 1024);
+  imageView->setHudText(lines);
+}
+
+qint64 ChildWidget::imageBytes() {
+  QGraphicsPixmapItem* pixmapItem =
+    qgraphicsitem_cast<QGraphicsPixmapItem*>(imageItem);
+  if (!pixmapItem)
+    return 0;
+  const QPixmap& pixmap = pixmapItem->pixmap();
+  return qint64(pixmap.width()) * pixmap.height() * pixmap.depth() / 8;
+}
+
+qint64 ChildWidget::residentBytes() {
+  // estimation for 10 model items and scene rectangle per box
+  static const qint64 kRowBytes = 2048;
+  if (m_suspended)
+    return 0;
+  return imageBytes() + model->rowCount() * kRowBytes;
+}
+
+void ChildWidget::suspend() {
+  TRACE_SPAN(tcModel);
+  if (m_suspended || !imageItem)
+    return;
+  commitRowEdit();
+  // storePage() needs current index
+  if (!selectionModel->currentIndex().isValid() && model->rowCount() > 0)
+    table->setCurrentIndex(model->index(0, 0));
+  storePage();
 
-  return rectItem;
-}
+  m_suspendedRow = qMax(0, selectionModel->currentIndex().row());
+  m_suspendedSelection = selectionRanges();
+  m_suspendedTransform = imageView->transform();
+  m_suspendedScroll = QPoint(imageView->horizontalScrollBar()->value(),
+                             imageView->verticalScrollBar()->value());
+  clearBalloons();
+  resizer->disable();
 
-void ChildWidget::updateModelItemBox(int row) {
-  if (DMESS > 10) qDebug() << Q_FUNC_INFO;
-  int left = model->index(row, 1).data().toInt();
-  int bottom = model->index(row, 2).data().toInt();
-  int right = model->index(row, 3).data().toInt();
-  int top = model->index(row, 4).data().toInt();
-  modelItemBox(row)->setRect(left, top, right - left, bottom - top);
+  bool showFontColumns = isFontColumnsShown();
+  cleanTable();
+  initTable();
+  setShowFontColumns(showFontColumns);
+  imageScene->removeItem(imageItem);
+  delete imageItem;
+  imageItem = 0;
+  m_pageImage = QImage();
+  m_inkMap = InkMap();
+  m_suspended = true;
 }
 
-void ChildWidget::deleteModelItemBox(int row) {
-  if (DMESS > 10) qDebug() << Q_FUNC_INFO;
-  // we can not use modelItemBox(row) because we clear selections...
-  QGraphicsRectItem* rectItem =
-          model->index(row, 9).data().value<QGraphicsRectItem*>();
-  imageScene->removeItem(rectItem);
-  delete rectItem;
-}
+void ChildWidget::resume() {
+  TRACE_SPAN(tcIO);
+  if (!m_suspended)
+    return;
+  m_suspended = false;
+  reloadImg();
+
+  bool showFontColumns = isFontColumnsShown();
+  cleanTable();
+  initTable();
+  setShowFontColumns(showFontColumns);
+  if (fillTableData(currPage)) {
+    for (int row = 0; row < model->rowCount(); ++row)
+      model->index(row, 9).data().value<QGraphicsRectItem*>()
+        ->setVisible(boxesVisible);
+  }
+  connect(model, SIGNAL(itemChanged(QStandardItem*)), this,
+          SLOT(emitBoxChanged()));
+  connect(model, SIGNAL(itemChanged(QStandardItem*)), this,
+          SLOT(documentWasModified()));
+  restoreViewState(m_suspendedRow, m_suspendedSelection,
+                   m_suspendedTransform, m_suspendedScroll);
+}
+
+QVariantList ChildWidget::selectionRanges() {
+  QVariantList ranges;
+  QVector<int> rows = selectedRowNumbers();
+  for (int i = 0; i < rows.size(); ++i) {
+    if (i > 0 && rows.at(i) == rows.at(i - 1) + 1)
+      continue;
+    if (i > 0)
+      ranges << rows.at(i - 1);
+    ranges << rows.at(i);
+  }
+  if (!rows.isEmpty())
+    ranges << rows.last();
+  return ranges;
+}
+
+void ChildWidget::restoreViewState(int row, const QVariantList& selection,
+                                   const QTransform& transform,
+                                   const QPoint& scroll) {
+  int lastRow = model->rowCount() - 1;
+  if (lastRow >= 0) {
+    table->setCurrentIndex(model->index(qBound(0, row, lastRow), 0));
+    QItemSelection selected;
+    for (int i = 0; i + 1 < selection.size(); i += 2) {
+      int first = qMax(0, selection.at(i).toInt());
+      int last = qMin(lastRow, selection.at(i + 1).toInt());
+      if (first <= last)
+        selected.select(model->index(first, 0), model->index(last, 0));
+    }
+    if (!selected.isEmpty())
+      selectionModel->select(selected, QItemSelectionModel::ClearAndSelect |
+                             QItemSelectionModel::Rows);
+    updateSelectionRects();
+  }
+  imageView->setTransform(transform);
+  setZoomStatus();
+  // scroll range is known after layout of (just shown) view
+  m_restoreScroll = scroll;
+  applyViewScroll();
+  QTimer::singleShot(0, this, SLOT(applyViewScroll()));
+}
+
+void ChildWidget::applyViewScroll() {
+  imageView->horizontalScrollBar()->setValue(m_restoreScroll.x());
+  imageView->verticalScrollBar()->setValue(m_restoreScroll.y());
+}
+
+QVariantMap ChildWidget::sessionState() {
+  // not attached yet - keep requested state (restored page, zoom, ...)
+  if (isPending() || isLoading()) {
+    QVariantMap state = m_pendingState;
+    state["image"] = imageFile;
+    return state;
+  }
+
+  QTransform transform = imageView->transform();
+  QPoint scroll(imageView->horizontalScrollBar()->value(),
+                imageView->verticalScrollBar()->value());
+  int row = selectionModel->currentIndex().row();
+  QVariantList selection = selectionRanges();
+  if (m_suspended) {
+    transform = m_suspendedTransform;
+    scroll = m_suspendedScroll;
+    row = m_suspendedRow;
+    selection = m_suspendedSelection;
+  }
+  QVariantMap state;
+  state["image"] = imageFile;
+  state["page"] = currPage;
+  state["row"] = qMax(0, row);
+  state["selection"] = selection;
+  state["transform"] = QVariantList() << transform.m11() << transform.m12()
+                       << transform.m21() << transform.m22()
+                       << transform.dx() << transform.dy();
+  state["scrollX"] = scroll.x();
+  state["scrollY"] = scroll.y();
+  return state;
+}
+
+void ChildWidget::setPendingState(const QVariantMap& state) {
+  m_pendingState = state;
+  QString fileName = state.value("image").toString();
+  setCurrentImageFile(fileName);
+  // box file does not need to exist yet, but tab needs title
+  boxFile = QFileInfo(BoxFile::boxFileName(fileName)).absoluteFilePath();
+}
+
+bool ChildWidget::loadPending(const LoadedDocument& document) {
+  TRACE_SPAN(tcModel);
+  QVariantMap state = m_pendingState;
+  m_pendingState.clear();
+  if (!attachDocument(document))
+    return false;
+
+  int page = state.value("page").toInt();
+  if (page > 0 && !pageWidget->isHidden())
+    currentPage->setValue(page + 1);
+
+  QTransform transform;
+  QVariantList values = state.value("transform").toList();
+  if (values.size() == 6) {
+    transform.setMatrix(values.at(0).toReal(), values.at(1).toReal(), 0,
+                        values.at(2).toReal(), values.at(3).toReal(), 0,
+                        values.at(4).toReal(), values.at(5).toReal(), 1);
+  }
+  restoreViewState(state.value("row").toInt(),
+                   state.value("selection").toList(), transform,
+                   QPoint(state.value("scrollX").toInt(),
+                          state.value("scrollY").toInt()));
+  return true;
+}
+
+QGraphicsRectItem* ChildWidget::modelItemBox(int row) {
+  TRACE_SPAN(tcRender);
+  if (selectionModel->hasSelection()) {
+    if (row == -1)
+      row = table->selectionModel()->selectedRows().last().row();
+    return model->index(row, 9).data().value<QGraphicsRectItem*>();
+  } else {
+    return NULL;
+  }
+}
+
+QGraphicsRectItem* ChildWidget::createModelItemBox(int row) {
+  TRACE_SPAN(tcRender);
+  int left = model->index(row, 1).data().toInt();
+  int bottom = model->index(row, 2).data().toInt();
+  int right = model->index(row, 3).data().toInt();
+  int top = model->index(row, 4).data().toInt();
+  QGraphicsRectItem* rectItem =
+    imageScene->addRect(left, top, right - left, bottom - top, QPen(boxColor));
+  rectItem->setZValue(2);
+  rectItem->hide();
+
+  model->setData(model->index(row, 9), QVariant::fromValue(rectItem));
+
+  return rectItem;
+}
+
+void ChildWidget::updateModelItemBox(int row) {
+  TRACE_SPAN(tcRender);
+  // modelItemBox(row) can not be used - row does not need to be selected
+  QGraphicsRectItem* rectItem =
+          model->index(row, 9).data().value<QGraphicsRectItem*>();
+  if (!rectItem)
+    return;
+  int left = model->index(row, 1).data().toInt();
+  int bottom = model->index(row, 2).data().toInt();
+  int right = model->index(row, 3).data().toInt();
+  int top = model->index(row, 4).data().toInt();
+  rectItem->setRect(left, top, right - left, bottom - top);
+}
+
+void ChildWidget::deleteModelItemBox(int row) {
+  TRACE_SPAN(tcRender);
+  // we can not use modelItemBox(row) because we clear selections...
+  QGraphicsRectItem* rectItem =
+          model->index(row, 9).data().value<QGraphicsRectItem*>();
+  imageScene->removeItem(rectItem);
+  delete rectItem;
+}
 
 void ChildWidget::drawBoxes() {
-  if (DMESS > 10) qDebug() << Q_FUNC_INFO;
+  TRACE_SPAN(tcRender);
   boxesVisible = !boxesVisible;
   // workaround:  modelItemBox(row) requires selection to not segfault
   if (!selectionModel->hasSelection())
@@ -1734,7 +1858,7 @@ void ChildWidget::drawBoxes() {
 }
 
 void ChildWidget::mousePressEvent(QMouseEvent* event) {
-  if (DMESS > 10) qDebug() << Q_FUNC_INFO;
+  TRACE_SPAN(tcRender);
   // This handler is for left click events only
   if (event->button() != Qt::LeftButton)
     return;
@@ -1771,7 +1895,7 @@ void ChildWidget::mousePressEvent(QMouseEvent* event) {
 }
 
 void ChildWidget::mouseMoveEvent(QMouseEvent* event) {
-  if (DMESS > 10) qDebug() << Q_FUNC_INFO;
+  TRACE_SPAN(tcRender);
   QPoint topleft;
   QPoint botright;
   int offset = this->sizes().first() + 6;  // 6 is estimated width  of splitter
@@ -1795,7 +1919,7 @@ void ChildWidget::mouseMoveEvent(QMouseEvent* event) {
 }
 
 void ChildWidget::mouseReleaseEvent(QMouseEvent* /*event*/) {
-  if (DMESS > 10) qDebug() << Q_FUNC_INFO;
+  TRACE_SPAN(tcRender);
   setCursor(Qt::ArrowCursor);
   releaseMouse();
   rubberBand->hide();
@@ -1902,115 +2026,127 @@ bool ChildWidget::eventFilter(QObject* object, QEvent* event) {
   return false;
 }
 
+/*
+ * Selected rows (or current row) are moved as one block; direction is
+ * offset of the first row of block.
+ */
 void ChildWidget::moveSymbolRow(int direction) {
-  if (DMESS > 10) qDebug() << Q_FUNC_INFO;
-  QModelIndex index = selectionModel->currentIndex();
-
-  int currentRow = index.row();
-  // check if any row is selected
-  if (currentRow < 0)
+  TRACE_SPAN(tcModel);
+  QVector<int> rows = selectedRowNumbers();
+  if (rows.isEmpty())
     return;
+  moveRowBlock(rows, rows.first() + direction);
+}
 
-  // check top/bottom movements
-  if ((direction + currentRow < 0) ||
-     (direction + currentRow + 1 > model->rowCount())) {
-    QString message = tr("Non existing destination row!");
-    emit statusBarMessage(message);
-    return;
-  } else {
-    if (abs(direction) == 1) {  // This works only for moveUp/moveDown!!!
-      UndoItem ui;
-      ui.m_eop = euoReplace;
-      ui.m_origrow = currentRow;
-      ui.m_extrarow = currentRow + direction;
-
-      for (int j = 0; j < model->columnCount() - 1; j++) {
-        ui.m_vdata[j] = model->index(currentRow, j).data();
-        ui.m_vextradata[j] = model->index(ui.m_extrarow, j).data();
-
-        model->setData(model->index(ui.m_extrarow, j), ui.m_vdata[j]);
-        model->setData(model->index(ui.m_origrow, j), ui.m_vextradata[j]);
-      }
-
-      m_undostack.push(ui);
-      updateModelItemBox(ui.m_extrarow);
-      updateModelItemBox(ui.m_origrow);
-      // activate new row
-      table->setCurrentIndex(model->index(ui.m_extrarow, 0));
-    } else {
-      // TODO(zdenop): implement undo, or rewrite whole function
-      UndoItem ui;
-      ui.m_eop = euoMove;
-      ui.m_origrow = currentRow;
-      ui.m_extrarow = currentRow + direction;
-
-      int newRow = ui.m_extrarow;
-      if (direction > 0)  // insertRow change row id!
-        newRow++;
-      else
-        currentRow++;
-      model->insertRow(newRow);
-
-      for (int i = 0; i < (model->columnCount() - 1); ++i) {
-        ui.m_vdata[i] = model->index(currentRow, i).data();
-        model->setData(model->index(newRow, i),
-                       model->index(currentRow, i).data());
-      }
-      m_undostack.push(ui);
+// Rows of selection (or current row) in ascending order
+QVector<int> ChildWidget::selectedRowNumbers() {
+  QVector<int> rows;
+  QModelIndexList indexes = selectionModel->selectedRows();
+  for (int i = 0; i < indexes.size(); ++i)
+    rows.append(indexes.at(i).row());
+  if (rows.isEmpty() && selectionModel->currentIndex().isValid())
+    rows.append(selectionModel->currentIndex().row());
+  std::sort(rows.begin(), rows.end());
+  return rows;
+}
 
-      QGraphicsRectItem* rectItem = createModelItemBox(newRow);
-      // activate new row
-      table->setCurrentIndex(model->index(newRow, 0));
-      if (boxesVisible)
-        rectItem->show();
-      // delete original row
-      model->removeRow(currentRow);
+/*
+ * Rows (ascending) are moved to block starting at destination, or back
+ * with inverse. Move is one reorder of model (permuteRows), so items keep
+ * their values and boxes and rows between are only shifted.
+ */
+void ChildWidget::moveRows(const QVector<int>& rows, int destination,
+                           bool inverse) {
+  TRACE_SPAN(tcModel);
+  int count = model->rowCount();
+  if (rows.isEmpty() || destination < 0 ||
+      destination + rows.size() > count)
+    return;
+  QVector<bool> moved(count, false);
+  for (int i = 0; i < rows.size(); ++i) {
+    if (rows.at(i) < 0 || rows.at(i) >= count)
+      return;
+    moved[rows.at(i)] = true;
+  }
+  // order[i] is row moved to i; other rows keep their order
+  QVector<int> order(count);
+  int rest = 0;
+  for (int i = 0; i < count; ++i) {
+    if (i >= destination && i < destination + rows.size()) {
+      order[i] = rows.at(i - destination);
+      continue;
     }
-    updateSelectionRects();
-    emit modifiedChanged();
+    while (moved.at(rest))
+      ++rest;
+    order[i] = rest++;
+  }
+  permuteRows(order, inverse);
+}
+
+void ChildWidget::moveRowBlock(const QVector<int>& rows, int destination) {
+  TRACE_SPAN(tcModel);
+  if (destination < 0 || destination + rows.size() > model->rowCount()) {
+    emit statusBarMessage(tr("Non existing destination row!"));
+    return;
   }
+  bool contiguous = rows.last() - rows.first() + 1 == rows.size();
+  if (contiguous && rows.first() == destination)
+    return;
+
+  commitRowEdit();
+  QVariantList original;
+  for (int i = 0; i < rows.size(); ++i)
+    original.append(rows.at(i));
+  UndoCommand command;
+  command.m_text = tr("Move symbol");
+  command.m_page = currPage;
+  UndoStep step = {euoMove, destination, destination, original, QVariant()};
+  command.m_steps.append(step);
+  applyUndoSteps(command.m_steps, false);
+  m_undostack.push(command);
+
+  table->setCurrentIndex(model->index(destination, 0));
+  selectionModel->select(
+    QItemSelection(model->index(destination, 0),
+                   model->index(destination + rows.size() - 1, 0)),
+    QItemSelectionModel::ClearAndSelect | QItemSelectionModel::Rows);
+  updateSelectionRects();
+  documentWasModified();
+  emit boxChanged();
 }
 
 void ChildWidget::copyFromCell() {
-  if (DMESS > 10) qDebug() << Q_FUNC_INFO;
+  TRACE_SPAN(tcModel);
   QClipboard* clipboard = QApplication::clipboard();
   clipboard->setText(table->currentIndex().data().toString());
 }
 
 void ChildWidget::pasteToCell() {
-  if (DMESS > 10) qDebug() << Q_FUNC_INFO;
+  TRACE_SPAN(tcModel);
   const QClipboard* clipboard = QApplication::clipboard();
   QModelIndex index = selectionModel->currentIndex();
-
-  UndoItem ui;
-  ui.m_eop = euoChange;
-  ui.m_origrow = index.row();
-
-  for (int i = 0; i < model->columnCount(); i++)
-    ui.m_vdata[i] = model->index(ui.m_origrow, i).data();
+  if (!index.isValid())
+    return;
 
   // do not paste string to int fields
   if ((index.column() > 0 && index.column() < 5) &&
       (clipboard->text().toInt() > 0)) {
-    model->setData(table->currentIndex(), clipboard->text().toInt());
-    m_undostack.push(ui);
+    setCell(index.row(), index.column(), clipboard->text().toInt());
   }
 
   // paste string only to string field
   if (index.column() == 0) {
-    model->setData(table->currentIndex(), clipboard->text());
-    m_undostack.push(ui);
+    setCell(index.row(), index.column(), clipboard->text());
   }
 
   if (directTypingMode)
     table->setCurrentIndex(model->index(index.row() + 1, 0));
 
-  updateModelItemBox(index.row());
   updateSelectionRects();
 }
 
 bool ChildWidget::directType(QKeyEvent* event) {
-  if (DMESS > 10) qDebug() << Q_FUNC_INFO;
+  TRACE_SPAN(tcModel);
   QModelIndex index = selectionModel->currentIndex();
 
   if (index.column() > 0) {
@@ -2025,17 +2161,7 @@ bool ChildWidget::directType(QKeyEvent* event) {
     #endif
         (event->key() !=  Qt::Key_Delete))  {
       // enter only text
-      model->setData(model->index(index.row(), 0, QModelIndex()),
-                     event->text());
-
-      UndoItem ui;
-      ui.m_eop = euoChange;
-      ui.m_origrow = index.row();
-
-      for (int i = 0; i < model->columnCount(); i++)
-        ui.m_vdata[i] = model->index(ui.m_origrow, i).data();
-
-      m_undostack.push(ui);
+      setCell(index.row(), 0, event->text());
       table->setCurrentIndex(model->index(index.row() + 1, 0));
     } else {
       if ((event->key() ==  Qt::Key_Enter) ||
@@ -2053,7 +2179,7 @@ bool ChildWidget::directType(QKeyEvent* event) {
 }
 
 void ChildWidget::insertSymbol() {
-  if (DMESS > 10) qDebug() << Q_FUNC_INFO;
+  TRACE_SPAN(tcModel);
   QModelIndex index = selectionModel->currentIndex();
   if (!index.isValid())
     return;
@@ -2065,37 +2191,14 @@ void ChildWidget::insertSymbol() {
     rightBorder = leftBorder +
                   (leftBorder - model->index(index.row(), 1).data().toInt());
 
+  // new symbol takes rest of values from current row
   int newrow = index.row() + 1;
-  model->insertRow(newrow);
-  model->setData(model->index(newrow, 0), "*");
-  model->setData(model->index(newrow, 1), leftBorder);
-  model->setData(model->index(newrow, 2),
-                 model->index(index.row(), 2).data().toInt());
-  model->setData(model->index(newrow, 3), rightBorder);
-  model->setData(model->index(newrow, 4),
-                 model->index(index.row(), 4).data().toInt());
-  model->setData(model->index(newrow, 5),
-                 model->index(index.row(), 5).data().toInt());
-  model->setData(model->index(newrow, 6),
-                 model->index(index.row(), 6).data().toBool());
-  model->setData(model->index(newrow, 7),
-                 model->index(index.row(), 7).data().toBool());
-  model->setData(model->index(newrow, 8),
-                 model->index(index.row(), 8).data().toBool());
-
-  UndoItem ui;
-  ui.m_eop = euoAdd;
-  ui.m_origrow = newrow;
-
-  // For redo
-  for (int ii = 0; ii < model->columnCount(); ii++)
-    ui.m_vdata[ii] = model->index(ui.m_origrow, ii).data();
-
-  m_undostack.push(ui);
-
-  QGraphicsRectItem* rectItem = createModelItemBox(newrow);
-  if (boxesVisible)
-    rectItem->show();
+  QVariantList values = rowValues(index.row());
+  values[0] = "*";
+  values[1] = leftBorder;
+  values[3] = rightBorder;
+  insertBoxRow(newrow, values);
+
   table->setCurrentIndex(model->index(newrow, 0));
   table->setFocus();
 
@@ -2104,61 +2207,45 @@ void ChildWidget::insertSymbol() {
 }
 
 void ChildWidget::splitSymbol() {
-  if (DMESS > 10) qDebug() << Q_FUNC_INFO;
+  TRACE_SPAN(tcModel);
   QModelIndex index = selectionModel->currentIndex();
   if (!index.isValid())
     return;
 
-  UndoItem ui;
-  ui.m_eop = euoSplit;
-  ui.m_origrow = index.row();
-  ui.m_extrarow = ui.m_origrow + 1;
-
-  for (int i = 0; i < model->columnCount(); i++)
-    ui.m_vdata[i] = model->index(ui.m_origrow, i).data();
-
-  m_undostack.push(ui);
-
-  QModelIndex left = model->index(index.row(), 1);
-  QModelIndex right = model->index(index.row(), 3);
-  int width = right.data().toInt() - left.data().toInt();
-  model->insertRow(index.row() + 1);
-  model->setData(model->index(index.row() + 1, 0), "*");
-  model->setData(model->index(index.row() + 1, 1),
-                 right.data().toInt() - width / 2);
-  model->setData(model->index(index.row() + 1, 2),
-                 model->index(index.row(), 2).data().toInt());
-  model->setData(model->index(index.row() + 1, 3), right.data().toInt());
-  model->setData(model->index(index.row() + 1, 4),
-                 model->index(index.row(), 4).data().toInt());
-  model->setData(model->index(index.row() + 1, 5),
-                 model->index(index.row(), 5).data().toInt());
-  model->setData(model->index(index.row() + 1, 6),
-                 model->index(index.row(), 6).data().toBool());
-  model->setData(model->index(index.row() + 1, 7),
-                 model->index(index.row(), 7).data().toBool());
-  model->setData(model->index(index.row() + 1, 8),
-                 model->index(index.row(), 8).data().toBool());
-  model->setData(right, right.data().toInt() - width / 2);
-
-  updateModelItemBox(index.row());
-  QGraphicsRectItem* rectItem = createModelItemBox(index.row() + 1);
-  if (boxesVisible)
-    rectItem->show();
+  int row = index.row();
+  int left = model->index(row, 1).data().toInt();
+  int right = model->index(row, 3).data().toInt();
+  int width = right - left;
+
+  beginUndoMacro(tr("Split symbol"));
+  QVariantList values = rowValues(row);
+  values[0] = "*";
+  values[1] = right - width / 2;
+  values[3] = right;
+  insertBoxRow(row + 1, values);
+  setCell(row, 3, right - width / 2);
+  endUndoMacro();
+
   updateSelectionRects();
   emit modifiedChanged();
 }
 
 void ChildWidget::joinSymbol() {
-  if (DMESS > 10) qDebug() << Q_FUNC_INFO;
+  TRACE_SPAN(tcModel);
   QModelIndexList indexes = selectionModel->selectedRows();
   if (indexes.empty())
     return;
+
+  QList<int> rows;
+  for (int i = 0; i < indexes.size(); ++i)
+    rows.append(indexes[i].row());
+  std::sort(rows.begin(), rows.end());
+
   // On single selected item join with the next ...
-  if (indexes.size() == 1) {
+  if (rows.size() == 1) {
     // ... if selected is not the last
-    if (indexes.back().row() != model->rowCount() - 1) {
-      indexes.push_back(model->index(indexes.back().row() + 1, 0));
+    if (rows.back() != model->rowCount() - 1) {
+      rows.append(rows.back() + 1);
     } else {
       return;
     }
@@ -2174,15 +2261,10 @@ void ChildWidget::joinSymbol() {
   bool bold = false;
   bool underline = false;
 
-  int targetRow = indexes.front().row();
-
-  QStack<UndoItem> joinstack;
-  UndoItem tempJoin;
-  tempJoin.m_origrow = targetRow;
-  tempJoin.m_eop = euoChange;
+  int targetRow = rows.front();
 
-  for (int i = 0; i < indexes.size(); ++i) {
-    int row = indexes[i].row();
+  for (int i = 0; i < rows.size(); ++i) {
+    int row = rows[i];
     letter += model->data(model->index(row, 0)).toString();
     left = my_min(left, model->data(model->index(row, 1)).toInt());
     bottom = my_max(bottom, model->data(model->index(row, 2)).toInt());
@@ -2192,44 +2274,26 @@ void ChildWidget::joinSymbol() {
     italic = italic || model->data(model->index(row, 6)).toBool();
     bold = bold || model->data(model->index(row, 7)).toBool();
     underline = underline || model->data(model->index(row, 8)).toBool();
+  }
 
-    tempJoin.m_vdata[0] = letter;
-    tempJoin.m_vdata[1] = left;
-    tempJoin.m_vdata[2] = bottom;
-    tempJoin.m_vdata[3] = right;
-    tempJoin.m_vdata[4] = top;
-    tempJoin.m_vdata[5] = page;
-    tempJoin.m_vdata[6] = italic;
-    tempJoin.m_vdata[7] = bold;
-    tempJoin.m_vdata[8] = underline;
-
-    joinstack.push_front(tempJoin);
-  }
-
-  model->setData(model->index(targetRow, 0), letter);
-  model->setData(model->index(targetRow, 1), left);
-  model->setData(model->index(targetRow, 2), bottom);
-  model->setData(model->index(targetRow, 3), right);
-  model->setData(model->index(targetRow, 4), top);
-  model->setData(model->index(targetRow, 5), page);
-  model->setData(model->index(targetRow, 6), italic);
-  model->setData(model->index(targetRow, 7), bold);
-  model->setData(model->index(targetRow, 8), underline);
-  updateModelItemBox(targetRow);
+  // whole join is one undo command
+  beginUndoMacro(tr("Join symbols"));
+  setCell(targetRow, 0, letter);
+  setCell(targetRow, 1, left);
+  setCell(targetRow, 2, bottom);
+  setCell(targetRow, 3, right);
+  setCell(targetRow, 4, top);
+  setCell(targetRow, 5, page);
+  setCell(targetRow, 6, italic);
+  setCell(targetRow, 7, bold);
+  setCell(targetRow, 8, underline);
 
   selectionModel->clearSelection();
 
-  int rowstodelete = indexes.size();
-  int rownum = indexes.front().row();
-
   // Keep the first row with joined data
-  rownum++;
-  rowstodelete--;
-
-  for (int i = rowstodelete; i > 0; i--) {
-    m_undostack.push(joinstack.pop());
-    deleteSymbolByRow(rownum);
-  }
+  for (int i = rows.size() - 1; i > 0; i--)
+    removeBoxRow(rows[i]);
+  endUndoMacro();
 
   table->setCurrentIndex(model->index(targetRow, 0));
   table->setFocus();
@@ -2237,40 +2301,31 @@ void ChildWidget::joinSymbol() {
   emit modifiedChanged();
 }
 
-void ChildWidget::deleteSymbolByRow(int row) {
-  if (DMESS > 10) qDebug() << Q_FUNC_INFO;
-  UndoItem ui;
-  ui.m_eop = euoDelete;
-  ui.m_origrow = row;
-  for (int j = 0; j < model->columnCount(); ++j)
-    ui.m_vdata[j] = model->index(ui.m_origrow, j).data();
-  m_undostack.push(ui);
-
-  deleteModelItemBox(ui.m_origrow);
-  model->removeRow(ui.m_origrow);
-}
-
 void ChildWidget::deleteSymbol() {
-  if (DMESS > 10) qDebug() << Q_FUNC_INFO;
+  TRACE_SPAN(tcModel);
   QModelIndexList indexes = selectionModel->selectedRows();
   if (indexes.empty())
     return;
   // This prevents deselecting dead rows in selectionChanged() on removeRow()
   selectionModel->clearSelection();
 
-  int rowstodelete = indexes.size();
-  int rownum = indexes.front().row();
-  int afterRow = my_min(indexes.back().row() - indexes.size() + 1,
-			model->rowCount() - 1);
+  // rows have to be removed from the bottom to keep row ids valid
+  QList<int> rows;
+  for (int i = 0; i < indexes.size(); ++i)
+    rows.append(indexes[i].row());
+  std::sort(rows.begin(), rows.end());
+  int afterRow = my_min(rows.back() - rows.size() + 1,
+                        model->rowCount() - rows.size() - 1);
 
-  while (!indexes.empty())
-  {
-    deleteSymbolByRow(indexes.back().row());
-    indexes.pop_back();
+  beginUndoMacro(tr("Delete symbols"));
+  while (!rows.empty()) {
+    removeBoxRow(rows.back());
+    rows.pop_back();
   }
+  endUndoMacro();
 
   if (model->rowCount() != 0) {
-    table->setCurrentIndex(model->index(afterRow, 0));
+    table->setCurrentIndex(model->index(my_max(afterRow, 0), 0));
   }
   table->setFocus();
   updateSelectionRects();
@@ -2278,42 +2333,33 @@ void ChildWidget::deleteSymbol() {
 }
 
 void ChildWidget::moveUp() {
-  if (DMESS > 10) qDebug() << Q_FUNC_INFO;
+  TRACE_SPAN(tcModel);
   moveSymbolRow(-1);
 }
 
 void ChildWidget::moveDown() {
-  if (DMESS > 10) qDebug() << Q_FUNC_INFO;
+  TRACE_SPAN(tcModel);
   moveSymbolRow(1);
 }
 
 void ChildWidget::moveTo() {
-  if (DMESS > 10) qDebug() << Q_FUNC_INFO;
+  TRACE_SPAN(tcModel);
   if (table->currentIndex().row() < 0)
     return;
 
-  int sourceRow = table->currentIndex().row();
-  int destRow = 0;
+  QVector<int> rows = selectedRowNumbers();
   GetRowIDDialog dialog(this);
+  if (!dialog.exec())
+    return;
 
-  if (dialog.exec()) {
-    QString string = dialog.lineEdit->text();
-
-    if (string.toInt() == 0)
-      destRow = string.toInt();
-    else
-      destRow = string.toInt() - 1;
-
-    if (destRow > model->rowCount())
-      destRow = model->rowCount() - 1;
-  }
-
-  moveSymbolRow(destRow - sourceRow);
+  int destRow = dialog.lineEdit->text().toInt() - 1;
+  destRow = qBound(0, destRow, model->rowCount() - rows.size());
+  moveRowBlock(rows, destRow);
   table->resizeRowToContents(destRow);
 }
 
 void ChildWidget::goToRow() {
-  if (DMESS > 10) qDebug() << Q_FUNC_INFO;
+  TRACE_SPAN(tcModel);
   GetRowIDDialog dialog(this);
   if (dialog.exec()) {
     QString string = dialog.lineEdit->text();
@@ -2333,7 +2379,7 @@ void ChildWidget::goToRow() {
 }
 
 void ChildWidget::find() {
-  if (DMESS > 10) qDebug() << Q_FUNC_INFO;
+  TRACE_SPAN(tcModel);
   if (!f_dialog) {
     f_dialog = new FindDialog(this, userFriendlyCurrentFile());
     connect(f_dialog, SIGNAL(findNext(const QString &,
@@ -2344,6 +2390,11 @@ void ChildWidget::find() {
                                       Qt::CaseSensitivity)),
             this, SLOT(findPrev(const QString &,
                                 Qt::CaseSensitivity)));
+    connect(f_dialog, SIGNAL(replaceAll(const QString &, const QString &,
+                                        Qt::CaseSensitivity, bool, bool,
+                                        int)),
+            this, SLOT(replaceAll(const QString &, const QString &,
+                                  Qt::CaseSensitivity, bool, bool, int)));
   }
 
   f_dialog->show();
@@ -2352,13 +2403,11 @@ void ChildWidget::find() {
 }
 
 QString ChildWidget::userFriendlyCurrentFile() {
-  if (DMESS > 10) qDebug() << Q_FUNC_INFO;
   return strippedName(boxFile);
 }
 
 /* Get symbol string and convert it to hexadecimal codes */
 QString ChildWidget::getSymbolHexCode() {
-  if (DMESS > 10) qDebug() << Q_FUNC_INFO;
   QModelIndex index = selectionModel->currentIndex();
 
   if (index.isValid()) {
@@ -2376,7 +2425,6 @@ QString ChildWidget::getSymbolHexCode() {
 
 /* Get size of box */
 QString ChildWidget::getBoxSize() {
-  if (DMESS > 10) qDebug() << Q_FUNC_INFO;
   QModelIndex index = selectionModel->currentIndex();
 
   if (index.isValid()) {
@@ -2392,18 +2440,16 @@ QString ChildWidget::getBoxSize() {
 }
 
 QString ChildWidget::currentBoxFile() {
-  if (DMESS > 10) qDebug() << Q_FUNC_INFO;
   return QFileInfo(boxFile).absoluteFilePath();
 }
 
 void ChildWidget::documentWasModified() {
-  if (DMESS > 10) qDebug() << Q_FUNC_INFO;
   modified = true;
   emit modifiedChanged();
+  scheduleCheck();
 }
 
 void ChildWidget::emitBoxChanged() {
-  if (DMESS > 10) qDebug() << Q_FUNC_INFO;
   clearBalloons();
   // updateBalloons();
   emit boxChanged();
@@ -2411,7 +2457,7 @@ void ChildWidget::emitBoxChanged() {
 
 void ChildWidget::selectionChanged(const QItemSelection& /*selected*/,
                                    const QItemSelection& deselected) {
-  if (DMESS > 10) qDebug() << Q_FUNC_INFO;
+  TRACE_SPAN(tcRender);
   // Set deselected bboxes' colors back to normal
   QModelIndexList indexes = deselected.indexes();
   if (!modelItemBox()) {
@@ -2435,7 +2481,7 @@ void ChildWidget::selectionChanged(const QItemSelection& /*selected*/,
 }
 
 void ChildWidget::clearBalloons() {
-  if (DMESS > 10) qDebug() << Q_FUNC_INFO;
+  TRACE_SPAN(tcRender);
   for (int i = 0; i < balloons.size(); ++i) {
     imageScene->removeItem(balloons[i].symbol);
     delete balloons[i].symbol;
@@ -2448,7 +2494,7 @@ void ChildWidget::clearBalloons() {
 }
 
 void ChildWidget::updateBalloons() {
-  if (DMESS > 10) qDebug() << Q_FUNC_INFO;
+  TRACE_SPAN(tcRender);
   int idx = table->selectionModel()->selectedRows().last().row();
   int min_idx = my_max(idx - balloonCount/2, 0);
   int max_idx = my_min(idx + balloonCount/2, model->rowCount() - 1);
@@ -2512,7 +2558,7 @@ void ChildWidget::updateBalloons() {
 }
 
 void ChildWidget::updateSelectionRects() {
-  if (DMESS > 10) qDebug() << Q_FUNC_INFO;
+  TRACE_SPAN(tcRender);
   QModelIndexList indexes = table->selectionModel()->selectedRows();
   if (!indexes.empty()) {
     clearBalloons();
@@ -2538,18 +2584,26 @@ void ChildWidget::updateSelectionRects() {
 }
 
 void ChildWidget::closeEvent(QCloseEvent* event) {
-  if (DMESS > 10) qDebug() << Q_FUNC_INFO;
+  TRACE_SPAN(tcIO);
   if (!maybeSave()) {
     event->ignore();
+    return;  // tab stays open with its dialogs
   }
-  if (fileWatcher)
-    delete fileWatcher;
-  if (f_dialog)
-    delete f_dialog;
+  m_journal.close(true);
+  delete fileWatcher;
+  fileWatcher = 0;
+  delete f_dialog;
+  f_dialog = 0;
+  delete m_statsDialog;
+  m_statsDialog = 0;
+  delete m_gallery;
+  m_gallery = 0;
+  delete m_clusterDialog;
+  m_clusterDialog = 0;
 }
 
 bool ChildWidget::maybeSave() {
-  if (DMESS > 10) qDebug() << Q_FUNC_INFO;
+  TRACE_SPAN(tcIO);
   if (isModified()) {
     QMessageBox::StandardButton ret;
     ret = QMessageBox::warning(this, SETTING_APPLICATION,
@@ -2566,22 +2620,19 @@ bool ChildWidget::maybeSave() {
 }
 
 void ChildWidget::setCurrentImageFile(const QString& fileName) {
-  if (DMESS > 10) qDebug() << Q_FUNC_INFO;
   imageFile = QFileInfo(fileName).canonicalFilePath();
 }
 
 void ChildWidget::setCurrentBoxFile(const QString& fileName) {
-  if (DMESS > 10) qDebug() << Q_FUNC_INFO;
   boxFile = QFileInfo(fileName).canonicalFilePath();
 }
 
 QString ChildWidget::strippedName(const QString& fullFileName) {
-  if (DMESS > 10) qDebug() << Q_FUNC_INFO;
   return QFileInfo(fullFileName).fileName();
 }
 
 void ChildWidget::cbFontToggleProxy(bool checked, int column) {
-  if (DMESS > 10) qDebug() << Q_FUNC_INFO;
+  TRACE_SPAN(tcModel);
   switch (column) {
   case 6 :
     setItalic(checked);
@@ -2598,31 +2649,12 @@ void ChildWidget::cbFontToggleProxy(bool checked, int column) {
 }
 
 void ChildWidget::letterStartEdit() {
-  if (DMESS > 10) qDebug() << Q_FUNC_INFO;
-  QModelIndex index = selectionModel->currentIndex();
-  int row = index.row();
-  if (!bIsLineEditChanged) {
-    // First event. Save undo
-    UndoItem ui;
-    ui.m_eop = euoChange;
-    ui.m_origrow = row;
-
-    for (int i = 0; i < model->columnCount(); i++)
-      ui.m_vdata[i] = model->index(ui.m_origrow, i).data();
-
-    m_undostack.push(ui);
-
-    bIsLineEditChanged = true;
-  }
-}
-
-void ChildWidget::letterEditFinished() {
-  if (DMESS > 10) qDebug() << Q_FUNC_INFO;
-  bIsLineEditChanged = false;
+  TRACE_SPAN(tcModel);
+  beginRowEdit(selectionModel->currentIndex().row());
 }
 
 void ChildWidget::sbValueChanged(int sbdValue) {
-  if (DMESS > 10) qDebug() << Q_FUNC_INFO;
+  TRACE_SPAN(tcModel);
   QModelIndex index = selectionModel->currentIndex();
   int row = index.row();
 
@@ -2648,38 +2680,25 @@ void ChildWidget::sbValueChanged(int sbdValue) {
     break;
   }
 
-  if (!bIsSpinBoxChanged) {
-    // First event. Save undo
-    UndoItem ui;
-    ui.m_eop = euoChange;
-    ui.m_origrow = row;
-
-    for (int i = 0; i < model->columnCount(); i++)
-      ui.m_vdata[i] = model->index(ui.m_origrow, i).data();
-
-    m_undostack.push(ui);
-
-    bIsSpinBoxChanged = true;
-  }
+  // First event of edit saves original values for undo
+  beginRowEdit(row);
 
   modelItemBox(row)->setRect(QRectF(QPoint(left, top), QPointF(right, bottom)));
 
   imageView->ensureVisible(modelItemBox(row));
 }
 
-void ChildWidget::sbFinished() {
-  if (DMESS > 10) qDebug() << Q_FUNC_INFO;
-  bIsSpinBoxChanged = false;
-}
-
 void ChildWidget::boxDragChanged() {
-  if (DMESS > 10) qDebug() << Q_FUNC_INFO;
+  TRACE_SPAN(tcRender);
   QModelIndex index = selectionModel->currentIndex();
 
   if (!index.isValid())
     return;
 
   int row = index.row();
+  // whole drag is one undo command - it is recorded in boxDragFinished
+  beginRowEdit(row);
+  m_editByDrag = true;
   model->setData(model->index(row, 1, QModelIndex()), resizer->rect.left());
   model->setData(model->index(row, 2, QModelIndex()), resizer->rect.bottom());
   model->setData(model->index(row, 3, QModelIndex()), resizer->rect.right());
@@ -2687,8 +2706,14 @@ void ChildWidget::boxDragChanged() {
   modelItemBox()->setRect(resizer->rect);
 }
 
+void ChildWidget::boxDragFinished() {
+  TRACE_SPAN(tcRender);
+  m_editByDrag = false;
+  commitRowEdit();
+}
+
 void ChildWidget::findNext(const QString &symbol, Qt::CaseSensitivity mc) {
-  if (DMESS > 10) qDebug() << Q_FUNC_INFO;
+  TRACE_SPAN(tcModel);
   int row = table->currentIndex().row() + 1;
   while (row < model->rowCount()) {
     QString letter = model->index(row, 0).data().toString();
@@ -2706,7 +2731,7 @@ void ChildWidget::findNext(const QString &symbol, Qt::CaseSensitivity mc) {
 
 void ChildWidget::findPrev(const QString &symbol,
                            Qt::CaseSensitivity mc) {
-  if (DMESS > 10) qDebug() << Q_FUNC_INFO;
+  TRACE_SPAN(tcModel);
   int row = table->currentIndex().row() - 1;
   while (row >= 0) {
     QString letter = model->index(row, 0).data().toString();
@@ -2722,328 +2747,856 @@ void ChildWidget::findPrev(const QString &symbol,
   emit statusBarMessage(tr("End of found!"));
 }
 
-bool ChildWidget::isUndoAvailable() {
-  if (DMESS > 10) qDebug() << Q_FUNC_INFO;
-  return m_undostack.isEmpty() ? false : true;
-}
+/*
+ * Replace symbol in all matching boxes of current page (or all pages).
+ * All changes are stored as one undo command.
+ */
+void ChildWidget::replaceAll(const QString &symbol, const QString &replacement,
+                             Qt::CaseSensitivity mc, bool regExp,
+                             bool allPages, int styleFilter) {
+  TRACE_SPAN(tcModel);
+  QRegularExpression re;
+  if (regExp) {
+    re.setPattern(symbol);
+    if (mc == Qt::CaseInsensitive)
+      re.setPatternOptions(QRegularExpression::CaseInsensitiveOption);
+    if (!re.isValid()) {
+      emit blinkFindDialog();
+      emit statusBarMessage(tr("Invalid regular expression: %1")
+                            .arg(re.errorString()));
+      return;
+    }
+    re.optimize();
+  }
 
-bool ChildWidget::isRedoAvailable() {
-  if (DMESS > 10) qDebug() << Q_FUNC_INFO;
-  return m_redostack.isEmpty() ? false : true;
-}
+  QApplication::setOverrideCursor(Qt::WaitCursor);
+  commitRowEdit();
+  UndoCommand command;
+  command.m_text = tr("Replace all");
+  command.m_page = currPage;
 
-void ChildWidget::undo() {
-  if (DMESS > 10) qDebug() << Q_FUNC_INFO;
-  if (m_undostack.isEmpty()) {
-    emit boxChanged();  // update toolbar/menu to disable undo action
-    // TODO(all): it is not working perfectly (are there some "ghost" undo
-    // actions?). Maybe we need to implement UndoStackView similar to
-    // http://doc-snapshot.qt-project.org/4.8/demos-undo.html
+  // Current page: data are in model
+  for (int row = 0; row < model->rowCount(); ++row) {
+    if (!matchStyleFilter(styleFilter, model->index(row, 7).data().toBool(),
+                          model->index(row, 6).data().toBool(),
+                          model->index(row, 8).data().toBool()))
+      continue;
+    QString letter = model->index(row, 0).data().toString();
+    QString replaced = letter;
+    if (regExp)
+      replaced.replace(re, replacement);
+    else
+      replaced.replace(symbol, replacement, mc);
+    // empty symbol would break box file
+    if (replaced != letter && !replaced.isEmpty()) {
+      UndoStep step = {euoChange, row, 0, letter, replaced};
+      command.m_steps.append(step);
+    }
+  }
+
+  // Other pages: data are in pages
+  if (allPages) {
+    for (int pageNum = 0; pageNum < pages.size(); ++pageNum) {
+      if (pageNum == currPage)
+        continue;
+      const QVector<QStringList>& page = pages.at(pageNum);
+      for (int row = 0; row < page.size(); ++row) {
+        bool bold, italic, underline;
+        QString letter = BoxFile::stripStyleFlags(page.at(row).value(0), &bold,
+                                         &italic, &underline);
+        if (!matchStyleFilter(styleFilter, bold, italic, underline))
+          continue;
+        QString replaced = letter;
+        if (regExp)
+          replaced.replace(re, replacement);
+        else
+          replaced.replace(symbol, replacement, mc);
+        if (replaced != letter && !replaced.isEmpty()) {
+          UndoStep step = {euoStore, row, pageNum, letter, replaced};
+          command.m_steps.append(step);
+        }
+      }
+    }
+  }
+
+  if (command.m_steps.isEmpty()) {
+    QApplication::restoreOverrideCursor();
+    emit blinkFindDialog();
+    emit statusBarMessage(tr("Nothing to replace!"));
     return;
   }
 
-  UndoItem ui = m_undostack.pop();
+  applyUndoSteps(command.m_steps, false);
+  m_undostack.push(command);
+  QApplication::restoreOverrideCursor();
 
-  switch (ui.m_eop) {
-  case euoAdd:
-    // Item was added. Reverse is remove it.
-    undoDelete(ui);
-    break;
-  case euoDelete:
-    // Item was deleted. Reverse is put it back.
-    undoAdd(ui);
-    break;
-  case euoChange:
-    // Item was edited. Put back old values.
-    undoEdit(ui);
-    break;
-  case euoJoin:
-    // Two items joined. Split back.
-    undoSplit(ui);
-    break;
-  case euoSplit:
-    // Item split in two. Join back.
-    undoJoin(ui);
-    break;
-  case euoReplace:
-    // Two item changed places. Change places back.
-    undoMoveBack(ui);
-    break;
-  case euoMove:
-    // Two item changed places. Change places back.
-    undoMoveBack2(ui);
-    break;
-  default:
-    // Nothing to do for other cases. Report error.
+  updateSelectionRects();
+  documentWasModified();
+  emit boxChanged();
+  emit statusBarMessage(tr("%1 symbol(s) replaced")
+                        .arg(command.m_steps.size()));
+}
 
-    QMessageBox::warning(
-      this,
-      SETTING_APPLICATION,
-      "Invalid undo operation.");
-    break;
-  }
+/*
+ * Values of row (without hidden box item) as they are stored in undo step
+ */
+QVariantList ChildWidget::rowValues(int row) {
+  QVariantList values;
+  for (int col = 0; col < 9; ++col)
+    values.append(model->index(row, col).data());
+  return values;
+}
 
-  emit boxChanged();  // update toolbar/menu
+/*
+ * Change one cell of table and record it for undo
+ */
+void ChildWidget::setCell(int row, int col, const QVariant& value) {
+  QVariant before = model->index(row, col).data();
+  if (before == value)
+    return;
+  UndoStep step = {euoChange, row, col, before, value};
+  recordUndoStep(step);
+  model->setData(model->index(row, col), value);
+  if (col > 5)
+    updateLetterFont(row);
+  else if (col > 0 && col < 5)
+    updateModelItemBox(row);
 }
 
-// Delete item as undo operation of add
-void ChildWidget::undoDelete(UndoItem& ui, bool bIsRedo) {
-  if (DMESS > 10) qDebug() << Q_FUNC_INFO;
-  selectionModel->clearSelection();
-  deleteModelItemBox(ui.m_origrow);
-  model->removeRow(ui.m_origrow);
+void ChildWidget::insertBoxRow(int row, const QVariantList& values) {
+  UndoStep step = {euoAdd, row, 0, QVariant(), values};
+  recordUndoStep(step);
+  restoreBoxRow(row, values);
+}
 
-  int rows = model->rowCount();
+void ChildWidget::removeBoxRow(int row) {
+  UndoStep step = {euoDelete, row, 0, rowValues(row), QVariant()};
+  recordUndoStep(step);
+  deleteModelItemBox(row);
+  model->removeRow(row);
+}
 
-  int newfocusrow = ui.m_origrow;
+/*
+ * Insert row with values and create its box (used also by undo/redo)
+ */
+void ChildWidget::restoreBoxRow(int row, const QVariantList& values) {
+  model->insertRow(row);
+  for (int col = 0; col < values.size(); ++col)
+    model->setData(model->index(row, col), values.at(col));
+  updateLetterFont(row);
+  QGraphicsRectItem* rectItem = createModelItemBox(row);
+  if (boxesVisible)
+    rectItem->setVisible(true);
+}
 
-  if (newfocusrow > rows)
-    newfocusrow = rows;
+void ChildWidget::updateLetterFont(int row) {
+  QFont letterFont;
+  letterFont.setItalic(model->index(row, 6).data().toBool());
+  letterFont.setBold(model->index(row, 7).data().toBool());
+  letterFont.setUnderline(model->index(row, 8).data().toBool());
+  model->setData(model->index(row, 0), letterFont, Qt::FontRole);
+}
 
-  table->setCurrentIndex(model->index(newfocusrow, 0));
-  table->setFocus();
-  updateSelectionRects();
+void ChildWidget::recordUndoStep(const UndoStep& step) {
+  // pending edit of (other) row must be before this step
+  if (!m_undostack.isMacroOpen())
+    commitRowEdit();
+  m_undostack.record(step, currPage);
+}
 
-  if (bIsRedo)
-    m_undostack.push(ui, false);
-  else
-    m_redostack.push(ui);
+void ChildWidget::beginUndoMacro(const QString& text) {
+  commitRowEdit();
+  m_undostack.beginMacro(text, currPage);
 }
 
-// Add back item as undo operation of delete
-void ChildWidget::undoAdd(UndoItem& ui, bool bIsRedo) {
-  if (DMESS > 10) qDebug() << Q_FUNC_INFO;
-  model->insertRow(ui.m_origrow);
-  undoEdit(ui, bIsRedo);
+void ChildWidget::endUndoMacro() {
+  m_undostack.endMacro();
+  emit boxChanged();
 }
 
-// Put back edited values
-void ChildWidget::undoEdit(UndoItem& ui, bool bIsRedo) {
-  if (DMESS > 10) qDebug() << Q_FUNC_INFO;
-  if (ui.m_eop == euoChange) {
-    if (bIsRedo) {
-      for (int i = 0; i < model->columnCount() - 1; i++)
-        model->setData(model->index(ui.m_origrow, i), ui.m_vextradata[i]);
-    } else {
-      // Save for redo
-      for (int ii = 0; ii < model->columnCount() - 1; ii++)
-        ui.m_vextradata[ii] = model->index(ui.m_origrow, ii).data();
+/*
+ * Start of interactive edit of row (delegate or drag). Original values are
+ * stored and compared with result in commitRowEdit.
+ */
+void ChildWidget::beginRowEdit(int row) {
+  if (row < 0 || row == m_editRow)
+    return;
+  commitRowEdit();
+  m_editRow = row;
+  m_editValues = rowValues(row);
+}
 
-      for (int i = 0; i < model->columnCount() -1 ; i++)
-        model->setData(model->index(ui.m_origrow, i), ui.m_vdata[i]);
+void ChildWidget::modelItemChanged(QStandardItem* item) {
+  // drag changes 4 cells at once, it is committed on mouse release
+  if (item->row() == m_editRow && !m_editByDrag)
+    commitRowEdit();
+}
+
+void ChildWidget::commitRowEdit() {
+  if (m_editRow < 0)
+    return;
+  int row = m_editRow;
+  m_editRow = -1;
+  if (row >= model->rowCount())
+    return;
+
+  m_undostack.beginMacro(tr("Edit symbol"), currPage);
+  for (int col = 0; col < m_editValues.size(); ++col) {
+    QVariant value = model->index(row, col).data();
+    if (value != m_editValues.at(col)) {
+      UndoStep step = {euoChange, row, col, m_editValues.at(col), value};
+      m_undostack.record(step, currPage);
     }
-  } else {
-    for (int i = 0; i < model->columnCount() - 1; i++)
-      model->setData(model->index(ui.m_origrow, i), ui.m_vdata[i]);
   }
+  m_undostack.endMacro();
+  m_editValues.clear();
+  emit boxChanged();
+}
 
-  if (ui.m_eop == euoDelete || (bIsRedo && ui.m_eop == euoAdd))
-    createModelItemBox(ui.m_origrow);
-  else
-    updateModelItemBox(ui.m_origrow);
-
-  table->setCurrentIndex(model->index(ui.m_origrow, 0));
-  table->setFocus();
-  updateSelectionRects();
+void ChildWidget::emitRowsChanged(int firstRow, int lastRow) {
+  if (firstRow > lastRow)
+    return;
+  emit model->dataChanged(model->index(firstRow, 0),
+                          model->index(lastRow, 8));
+}
 
-  if (bIsRedo)
-    m_undostack.push(ui, false);
-  else
-    m_redostack.push(ui);
+/*
+ * Apply steps of command in reverse order (undo) or as recorded (redo).
+ * Cell changes are applied without itemChanged signals - one dataChanged
+ * is emitted for the whole block of changed rows.
+ */
+void ChildWidget::applyUndoSteps(const QVector<UndoStep>& steps, bool undo) {
+  TRACE_SPAN(tcUndo);
+  int firstRow = INT_MAX;
+  int lastRow = -1;
+  int count = steps.size();
+
+  for (int i = 0; i < count; ++i) {
+    const UndoStep& step = steps.at(undo ? count - 1 - i : i);
+    const QVariant& value = undo ? step.m_before : step.m_after;
+    switch (step.m_eop) {
+    case euoChange:
+      model->blockSignals(true);
+      model->setData(model->index(step.m_row, step.m_arg), value);
+      if (step.m_arg > 5)
+        updateLetterFont(step.m_row);
+      model->blockSignals(false);
+      if (step.m_arg > 0 && step.m_arg < 5)
+        updateModelItemBox(step.m_row);
+      firstRow = my_min(firstRow, step.m_row);
+      lastRow = my_max(lastRow, step.m_row);
+      break;
+    case euoAdd:
+    case euoDelete:
+      // row ids are changed - flush collected changes first
+      emitRowsChanged(firstRow, lastRow);
+      firstRow = INT_MAX;
+      lastRow = -1;
+      if ((step.m_eop == euoAdd) != undo) {
+        restoreBoxRow(step.m_row, value.toList());
+      } else {
+        deleteModelItemBox(step.m_row);
+        model->removeRow(step.m_row);
+      }
+      break;
+    case euoPermute:
+    case euoMove: {
+      emitRowsChanged(firstRow, lastRow);
+      firstRow = INT_MAX;
+      lastRow = -1;
+      QVariantList list = step.m_eop == euoPermute ? step.m_after.toList()
+                                                   : step.m_before.toList();
+      QVector<int> rows;
+      for (int r = 0; r < list.size(); ++r)
+        rows.append(list.at(r).toInt());
+      if (step.m_eop == euoMove)
+        moveRows(rows, step.m_arg, undo);
+      else
+        permuteRows(rows, undo);
+      break;
+    }
+    case euoStore: {
+      if (step.m_arg < 0 || step.m_arg >= pages.size() || step.m_row < 0 ||
+          step.m_row >= pages.at(step.m_arg).size() ||
+          pages.at(step.m_arg).at(step.m_row).isEmpty())
+        break;
+      QString& letter = pages[step.m_arg][step.m_row][0];
+      bool bold, italic, underline;
+      BoxFile::stripStyleFlags(letter, &bold, &italic, &underline);
+      letter = BoxFile::styleFlags(bold, italic, underline) + value.toString();
+      break;
+    }
+    default:
+      break;
+    }
+  }
+  emitRowsChanged(firstRow, lastRow);
 }
 
-// Re-join split rows
-void ChildWidget::undoJoin(UndoItem& ui, bool bIsRedo) {
-  if (DMESS > 10) qDebug() << Q_FUNC_INFO;
-  // Save data for redo
-  UndoItem rui;
-  rui.m_eop = euoJoin;
-  rui.m_origrow = ui.m_origrow;
-  rui.m_extrarow = ui.m_extrarow;
+/*
+ * Rows are reordered by one sort of model (one layoutChanged); row
+ * order[i] is moved to i, or back with inverse. Box items, fonts and
+ * selection move with rows.
+ */
+void ChildWidget::permuteRows(const QVector<int>& order, bool inverse) {
+  TRACE_SPAN(tcModel);
+  if (order.size() != model->rowCount())
+    return;
+  const int sortKeyRole = Qt::UserRole + 1;
+  model->blockSignals(true);
+  for (int i = 0; i < order.size(); ++i) {
+    int row = inverse ? i : order.at(i);
+    int target = inverse ? order.at(i) : i;
+    model->setData(model->index(row, 0), target, sortKeyRole);
+  }
+  model->blockSignals(false);
+  int sortRole = model->sortRole();
+  model->setSortRole(sortKeyRole);
+  model->sort(0);
+  model->setSortRole(sortRole);
+  model->blockSignals(true);
+  for (int row = 0; row < model->rowCount(); ++row)
+    model->setData(model->index(row, 0), QVariant(), sortKeyRole);
+  model->blockSignals(false);
+}
 
-  for (int i = 0; i < model->columnCount(); i++) {
-    rui.m_vdata[i] = model->index(rui.m_origrow, i).data();
-    rui.m_vextradata[i] = model->index(rui.m_extrarow, i).data();
+/*
+ * Sort boxes of page by lines, columns and direction of text (PageLayout).
+ * It is one undo step.
+ */
+void ChildWidget::sortByReadingOrder() {
+  TRACE_SPAN(tcModel);
+  commitRowEdit();
+  QVector<int> order = PageLayout(modelPage()).readingOrder();
+  QVariantList permutation;
+  bool sorted = true;
+  for (int i = 0; i < order.size(); ++i) {
+    permutation.append(order.at(i));
+    sorted = sorted && order.at(i) == i;
+  }
+  if (sorted) {
+    emit statusBarMessage(tr("Boxes are already in reading order."));
+    return;
   }
 
-  deleteModelItemBox(ui.m_extrarow);
-  model->removeRow(ui.m_extrarow);
+  QApplication::setOverrideCursor(Qt::WaitCursor);
+  UndoCommand command;
+  command.m_text = tr("Sort by reading order");
+  command.m_page = currPage;
+  UndoStep step = {euoPermute, 0, 0, QVariant(), permutation};
+  command.m_steps.append(step);
+  applyUndoSteps(command.m_steps, false);
+  m_undostack.push(command);
+  QApplication::restoreOverrideCursor();
+
+  updateSelectionRects();
+  documentWasModified();
+  emit boxChanged();
+}
+
+void ChildWidget::applyUndoCommand(const UndoCommand& command, bool undo) {
+  TRACE_SPAN(tcUndo);
+  // command has to be applied on page where it was recorded
+  if (command.m_page != currPage && pages.size() > 1)
+    currentPage->setValue(command.m_page + 1);
 
-  for (int i = 0; i < model->columnCount(); i++)
-    model->setData(model->index(ui.m_origrow, i), ui.m_vdata[i]);
-  updateModelItemBox(ui.m_origrow);
+  selectionModel->clearSelection();
+  applyUndoSteps(command.m_steps, undo);
 
-  table->setCurrentIndex(model->index(ui.m_origrow, 0));
+  // select first changed row of current page
+  int row = -1;
+  for (int i = 0; i < command.m_steps.size(); ++i) {
+    if (command.m_steps.at(i).m_eop != euoStore) {
+      row = command.m_steps.at(i).m_row;
+      break;
+    }
+  }
+  if (row >= model->rowCount())
+    row = model->rowCount() - 1;
+  if (row >= 0)
+    table->setCurrentIndex(model->index(row, 0));
   table->setFocus();
   updateSelectionRects();
-
-  if (bIsRedo)
-    m_undostack.push(rui, false);
-  else
-    m_redostack.push(rui);
+  documentWasModified();
+  emit statusBarMessage(undo ? tr("Undo: %1").arg(command.m_text)
+                             : tr("Redo: %1").arg(command.m_text));
 }
 
-// Split back joined lines
-void ChildWidget::undoSplit(UndoItem& ui, bool bIsRedo) {
-  if (DMESS > 10) qDebug() << Q_FUNC_INFO;
-  // Save data for redo
-  UndoItem rui;
-  rui.m_eop = euoSplit;
-  rui.m_origrow = ui.m_origrow;
-  rui.m_extrarow = ui.m_origrow + 1;
+void ChildWidget::recoverJournal() {
+  TRACE_SPAN(tcUndo);
+  QList<JournalRecord> records;
+  if (!EditJournal::readRecords(boxFile, &records)) {
+    m_journal.start(boxFile);
+    return;
+  }
 
-  for (int i = 0; i < model->columnCount(); i++) {
-    rui.m_vdata[i] = model->index(rui.m_origrow, i).data();
+  // journal can be damaged or written for other version of box file
+  QVector<int> rowCounts(qMax(pages.size(), currPage + 1), 0);
+  for (int page = 0; page < pages.size(); ++page)
+    rowCounts[page] = pages.at(page).size();
+  rowCounts[currPage] = model->rowCount();
+  for (int i = 0; i < records.size(); ++i) {
+    if (!isValidJournalRecord(records.at(i), &rowCounts)) {
+      QMessageBox::warning(this, tr("Recovery"),
+                           tr("Journal of '%1' does not match the box file "
+                              "(record %2 of %3). Unsaved changes were not "
+                              "recovered.")
+                           .arg(strippedName(boxFile)).arg(i + 1)
+                           .arg(records.size()));
+      m_journal.start(boxFile);
+      return;
+    }
   }
 
-  model->insertRow(ui.m_extrarow);
-  for (int i = 0; i < model->columnCount(); i++) {
-    model->setData(model->index(ui.m_extrarow, i), ui.m_vextradata[i]);
-    model->setData(model->index(ui.m_origrow, i), ui.m_vdata[i]);
+  QApplication::setOverrideCursor(Qt::WaitCursor);
+  // replayed commands are already in journal
+  m_undostack.setJournal(0);
+  for (int i = 0; i < records.size(); ++i) {
+    const JournalRecord& record = records.at(i);
+    // keep history of undo stack as it was in crashed session
+    switch (record.m_type) {
+    case ejrCommand:
+      m_undostack.push(record.m_command);
+      break;
+    case ejrUndo:
+      m_undostack.undo();
+      break;
+    case ejrRedo:
+      m_undostack.redo();
+      break;
+    }
+    applyUndoCommand(record.m_command, record.m_type == ejrUndo);
   }
-  updateModelItemBox(ui.m_origrow);
-  createModelItemBox(ui.m_extrarow);
+  m_undostack.setJournal(&m_journal);
+  m_journal.start(boxFile, true);
+  QApplication::restoreOverrideCursor();
 
-  table->setCurrentIndex(model->index(ui.m_origrow, 0));
-  table->setFocus();
-  updateSelectionRects();
+  modified = true;
+  emit modifiedChanged();
+  QMessageBox::information(this, tr("Recovery"),
+                           tr("Unsaved changes of '%1' (%2 edits) were "
+                              "recovered from journal.")
+                           .arg(strippedName(boxFile)).arg(records.size()));
+}
+
+bool ChildWidget::isValidJournalRecord(const JournalRecord& record,
+                                       QVector<int>* rowCounts) {
+  const UndoCommand& command = record.m_command;
+  bool undo = record.m_type == ejrUndo;
+  int page = pages.size() > 1 ? command.m_page : currPage;
+  if (page < 0 || page >= rowCounts->size())
+    return false;
+  int& rows = (*rowCounts)[page];
+  int count = command.m_steps.size();
+  for (int i = 0; i < count; ++i) {
+    const UndoStep& step = command.m_steps.at(undo ? count - 1 - i : i);
+    switch (step.m_eop) {
+    case euoChange:
+      if (step.m_row < 0 || step.m_row >= rows || step.m_arg < 0 ||
+          step.m_arg > 8)
+        return false;
+      break;
+    case euoAdd:
+    case euoDelete:
+      if ((step.m_eop == euoAdd) != undo) {
+        if (step.m_row < 0 || step.m_row > rows)
+          return false;
+        ++rows;
+      } else {
+        if (step.m_row < 0 || step.m_row >= rows)
+          return false;
+        --rows;
+      }
+      break;
+    case euoPermute: {
+      QVariantList order = step.m_after.toList();
+      if (order.size() != rows)
+        return false;
+      QVector<bool> used(rows, false);
+      for (int r = 0; r < order.size(); ++r) {
+        int row = order.at(r).toInt();
+        if (row < 0 || row >= rows || used.at(row))
+          return false;
+        used[row] = true;
+      }
+      break;
+    }
+    case euoMove: {
+      QVariantList moved = step.m_before.toList();
+      if (moved.isEmpty() || step.m_arg < 0 ||
+          step.m_arg + moved.size() > rows)
+        return false;
+      for (int r = 0; r < moved.size(); ++r) {
+        int row = moved.at(r).toInt();
+        if (row < 0 || row >= rows ||
+            (r > 0 && row <= moved.at(r - 1).toInt()))
+          return false;
+      }
+      break;
+    }
+    case euoStore:
+      if (step.m_arg < 0 || step.m_arg >= pages.size() || step.m_row < 0 ||
+          step.m_row >= rowCounts->at(step.m_arg))
+        return false;
+      break;
+    default:
+      return false;
+    }
+  }
+  return true;
+}
 
-  if (bIsRedo)
-    m_undostack.push(rui, false);
-  else
-    m_redostack.push(rui);
+/*
+ * Check boxes of all pages in background (see BoxValidator)
+ */
+void ChildWidget::checkBoxes() {
+  TRACE_SPAN(tcModel);
+  if (m_linter->isRunning()) {
+    emit statusBarMessage(tr("Check of boxes is already running."));
+    return;
+  }
+  commitRowEdit();
+  storePage();
+  QVector<QSize> pageSizes;
+  if (!BoxFile::readImageInfo(imageFile, &pageSizes))
+    pageSizes.clear();
+  emit statusBarMessage(tr("Checking boxes..."));
+  m_linter->start(pages, pageSizes);
+}
+
+void ChildWidget::boxesChecked(const QVector<BoxProblem>& problems) {
+  TRACE_SPAN(tcModel);
+  if (problems.isEmpty()) {
+    emit statusBarMessage(tr("No problems found."));
+    return;
+  }
+
+  // go to the first problem
+  const BoxProblem& first = problems.first();
+  if (first.m_page != currPage && pages.size() > 1)
+    currentPage->setValue(first.m_page + 1);
+  if (first.m_page == currPage && first.m_row < model->rowCount()) {
+    table->setCurrentIndex(model->index(first.m_row, 0));
+    table->setFocus();
+    updateSelectionRects();
+  }
+  emit statusBarMessage(tr("%1 problem(s) found. Row %2: %3")
+                        .arg(problems.size()).arg(first.m_row + 1)
+                        .arg(BoxValidator::description(first)));
+}
+
+void ChildWidget::scheduleCheck() {
+  if (m_backgroundCheck || isSymbolStatsShown() || isPageStripShown())
+    m_checkTimer->start();
 }
 
-// Put replaced rows back to original location
-void ChildWidget::undoMoveBack(UndoItem& ui, bool bIsRedo) {
-  if (DMESS > 10) qDebug() << Q_FUNC_INFO;
-  int firstrow = ui.m_origrow;
-  int secondrow = ui.m_extrarow;
+/*
+ * Only boxes near rows changed since the last check are compared again
+ * (BoxValidator::checkPage), so the check is cheap also for big pages.
+ * Snapshot of page is kept between checks and only rows changed in model
+ * (edits, undo steps) are read again; unchanged rows stay shared with the
+ * previous check, so BoxValidator compares them without string compare.
+ */
+void ChildWidget::startPageCheck() {
+  TRACE_SPAN(tcModel);
+  if (m_suspended || !imageItem)
+    return;
+  if (!m_snapshotValid || m_checkSnapshot.size() != model->rowCount()) {
+    m_checkSnapshot = modelPage();
+    m_snapshotValid = true;
+  } else {
+    for (int row = 0; row < m_checkSnapshot.size(); ++row)
+      if (m_checkSnapshot.at(row).isEmpty())
+        m_checkSnapshot[row] = modelBox(row);
+  }
+  BoxPage shown = m_checkSnapshot;
+  if (m_backgroundCheck)
+    m_linter->startPage(currPage, shown, QSize(imageWidth, imageHeight));
+  if (isSymbolStatsShown())
+    updateSymbolStats(shown);
+  if (isPageStripShown())
+    updatePageStrip(shown);
+}
+
+// Changed rows are marked empty in snapshot and read again by next check
+void ChildWidget::snapshotRowsChanged(const QModelIndex& topLeft,
+                                      const QModelIndex& bottomRight) {
+  if (!m_snapshotValid)
+    return;
+  int last = qMin(bottomRight.row(), m_checkSnapshot.size() - 1);
+  for (int row = qMax(topLeft.row(), 0); row <= last; ++row)
+    m_checkSnapshot[row].clear();
+}
 
-  if (bIsRedo) {
-    firstrow = ui.m_extrarow;
-    secondrow = ui.m_origrow;
+void ChildWidget::snapshotRowsInserted(const QModelIndex& parent, int first,
+                                       int last) {
+  Q_UNUSED(parent);
+  if (!m_snapshotValid)
+    return;
+  if (first > m_checkSnapshot.size()) {
+    invalidateSnapshot();
+    return;
   }
+  m_checkSnapshot.insert(first, last - first + 1, QStringList());
+}
 
-  for (int i = 0; i < model->columnCount() - 1; i++) {
-    model->setData(model->index(firstrow, i), ui.m_vdata[i]);
-    model->setData(model->index(secondrow, i), ui.m_vextradata[i]);
+void ChildWidget::snapshotRowsRemoved(const QModelIndex& parent, int first,
+                                      int last) {
+  Q_UNUSED(parent);
+  if (!m_snapshotValid)
+    return;
+  if (last >= m_checkSnapshot.size()) {
+    invalidateSnapshot();
+    return;
   }
-  updateModelItemBox(ui.m_origrow);
-  updateModelItemBox(ui.m_extrarow);
+  m_checkSnapshot.remove(first, last - first + 1);
+}
 
-  table->setCurrentIndex(model->index(firstrow, 0));
-  table->setFocus();
+void ChildWidget::invalidateSnapshot() {
+  m_checkSnapshot.clear();
+  m_snapshotValid = false;
+}
 
+void ChildWidget::pageChecked(int page, const QVector<BoxProblem>& problems) {
+  TRACE_SPAN(tcModel);
+  if (page != currPage || m_suspended)
+    return;
+  m_pageProblems = problems;
+  tintProblemBoxes();
+
+  m_problemList->clear();
+  for (int i = 0; i < problems.size(); ++i) {
+    const BoxProblem& problem = problems.at(i);
+    QListWidgetItem* item = new QListWidgetItem(
+      tr("Row %1: %2").arg(problem.m_row + 1)
+      .arg(BoxValidator::description(problem)), m_problemList);
+    item->setData(Qt::UserRole, problem.m_row);
+  }
+  m_problemList->setVisible(!problems.isEmpty());
+}
+
+void ChildWidget::problemClicked(QListWidgetItem* item) {
+  TRACE_SPAN(tcModel);
+  int row = item->data(Qt::UserRole).toInt();
+  if (row >= model->rowCount())
+    return;  // row was removed after the check
+  table->setCurrentIndex(model->index(row, 0));
   updateSelectionRects();
+}
 
-  if (bIsRedo)
-    m_undostack.push(ui, false);
-  else
-    m_redostack.push(ui);
+// Rows could be moved since the previous check, so all boxes are reset
+void ChildWidget::tintProblemBoxes() {
+  TRACE_SPAN(tcRender);
+  for (int row = 0; row < model->rowCount(); ++row) {
+    QGraphicsRectItem* rectItem =
+      model->index(row, 9).data().value<QGraphicsRectItem*>();
+    if (rectItem)
+      rectItem->setBrush(Qt::NoBrush);
+  }
+  for (int i = 0; i < m_pageProblems.size(); ++i) {
+    int row = m_pageProblems.at(i).m_row;
+    if (row >= model->rowCount())
+      continue;
+    QGraphicsRectItem* rectItem =
+      model->index(row, 9).data().value<QGraphicsRectItem*>();
+    if (rectItem)
+      rectItem->setBrush(m_problemColor);
+  }
+}
+
+bool ChildWidget::isSymbolStatsShown() const {
+  return m_statsDialog && m_statsDialog->isVisible();
 }
 
-// Put moved row back to original location
-void ChildWidget::undoMoveBack2(UndoItem& ui, bool bIsRedo) {
-  if (DMESS > 10) qDebug() << Q_FUNC_INFO;
-  int firstrow = ui.m_origrow;
-  int secondrow = ui.m_extrarow;
+BoxPages ChildWidget::currentPages(const BoxPage& shown) {
+  BoxPages result = pages;
+  if (currPage < result.size())
+    result[currPage] = shown;
+  return result;
+}
 
-  if (bIsRedo) {
-    firstrow = ui.m_extrarow;
-    secondrow = ui.m_origrow;
+/*
+ * Only pages changed since the previous update are accounted (see
+ * SymbolStats::update), so statistics stay live also for big documents.
+ */
+void ChildWidget::updateSymbolStats(const BoxPage& shown) {
+  TRACE_SPAN(tcModel);
+  m_symbolStats.update(currentPages(shown));
+  m_statsDialog->setStats(m_symbolStats);
+}
+
+void ChildWidget::showSymbolStats() {
+  TRACE_SPAN(tcModel);
+  commitRowEdit();
+  if (!m_statsDialog) {
+    m_statsDialog = new SymbolStatsDialog(this, userFriendlyCurrentFile());
+    connect(m_statsDialog, SIGNAL(symbolSelected(const QString &)), this,
+            SLOT(symbolStatsSelected(const QString &)));
+    connect(m_statsDialog, SIGNAL(boxActivated(int, int)), this,
+            SLOT(goToBox(int, int)));
   }
+  m_statsDialog->show();
+  m_statsDialog->raise();
+  m_statsDialog->activateWindow();
+  if (!m_suspended)
+    updateSymbolStats(modelPage());
+}
 
-  if (firstrow < secondrow)
-      secondrow++;
-  else
-      firstrow++;
+void ChildWidget::symbolStatsSelected(const QString& symbol) {
+  TRACE_SPAN(tcModel);
+  BoxPages all = m_suspended ? pages : currentPages(modelPage());
+  m_statsDialog->setOutliers(symbol, m_symbolStats.outliers(symbol, all));
+}
+
+/*
+ * Gallery is filled when it is shown or refreshed (not after every edit:
+ * reset of the model would lose scroll position).
+ */
+void ChildWidget::showGlyphGallery() {
+  TRACE_SPAN(tcRender);
+  if (!m_gallery) {
+    m_gallery = new GlyphGallery(this, userFriendlyCurrentFile());
+    connect(m_gallery, SIGNAL(boxActivated(int, int)), this,
+            SLOT(goToBox(int, int)));
+    connect(m_gallery, SIGNAL(refreshRequested()), this,
+            SLOT(refreshGlyphGallery()));
+  }
+  refreshGlyphGallery();
+  m_gallery->show();
+  m_gallery->raise();
+  m_gallery->activateWindow();
+}
 
-  model->insertRow(firstrow);
+void ChildWidget::refreshGlyphGallery() {
+  TRACE_SPAN(tcRender);
+  commitRowEdit();
+  m_gallery->setPages(imageFile,
+                      m_suspended ? pages : currentPages(modelPage()));
+}
 
-  for (int i = 0; i < model->columnCount() - 1; i++) {
-    model->setData(model->index(firstrow, i), ui.m_vdata[i]);
+/*
+ * Glyphs of all pages are compared (see GlyphClusters); similarity threshold
+ * is Clusters/Similarity (cosine, default 0.9).
+ */
+void ChildWidget::findSimilarGlyphs() {
+  TRACE_SPAN(tcModel);
+  commitRowEdit();
+  QSettings settings(QSettings::IniFormat, QSettings::UserScope,
+                     SETTING_ORGANIZATION, SETTING_APPLICATION);
+  double similarity = 0.9;
+  if (settings.contains("Clusters/Similarity"))
+    similarity = settings.value("Clusters/Similarity").toDouble();
+
+  if (m_clusterPool.activeThreadCount() > 0) {
+    emit statusBarMessage(tr("Glyphs are still being compared..."));
+    return;
+  }
+  emit statusBarMessage(tr("Comparing glyphs..."));
+  m_clusterPool.start(new GlyphClusterJob(this, imageFile,
+                                          currentPages(modelPage()),
+                                          similarity));
+}
+
+// Result of clustering started by findSimilarGlyphs()
+void ChildWidget::glyphsClustered(const QVector<GlyphCluster>& clusters) {
+  TRACE_SPAN(tcModel);
+  if (!m_clusterDialog) {
+    m_clusterDialog = new ClusterDialog(this, userFriendlyCurrentFile());
+    connect(m_clusterDialog, SIGNAL(boxActivated(int, int)), this,
+            SLOT(goToBox(int, int)));
+  }
+  m_clusterDialog->setClusters(clusters);
+  m_clusterDialog->show();
+  m_clusterDialog->raise();
+  m_clusterDialog->activateWindow();
+  emit statusBarMessage(tr("%1 clusters of similar glyphs have more than "
+                           "one label.").arg(clusters.size()));
+}
+
+void ChildWidget::goToBox(int page, int row) {
+  TRACE_SPAN(tcModel);
+  if (page != currPage && page < pages.size())
+    currentPage->setValue(page + 1);
+  if (page == currPage && row < model->rowCount()) {
+    table->setCurrentIndex(model->index(row, 0));
+    table->setFocus();
+    updateSelectionRects();
   }
-  createModelItemBox(firstrow);
+}
 
-  model->removeRow(secondrow);
+bool ChildWidget::isPageStripShown() const {
+  return !m_pageStrip->isHidden();
+}
 
-  if (firstrow > secondrow) firstrow--;
-  table->setCurrentIndex(model->index(firstrow, 0));
-  table->setFocus();
+void ChildWidget::pageStripActivated(int page) {
+  TRACE_SPAN(tcModel);
+  if (page != currPage)
+    currentPage->setValue(page + 1);
+}
 
-  updateSelectionRects();
+/*
+ * Pages not edited since load/save share data with m_savedPages, so their
+ * comparison is cheap.
+ */
+void ChildWidget::updatePageStrip(const BoxPage& shown) {
+  TRACE_SPAN(tcModel);
+  int pageCount = m_pageStrip->stripModel()->rowCount();
+  QVector<int> boxCounts(pageCount, -1);
+  QVector<bool> pageModified(pageCount, false);
+  for (int page = 0; page < pageCount && page < pages.size(); ++page) {
+    const BoxPage& boxes = page == currPage ? shown : pages.at(page);
+    boxCounts[page] = boxes.size();
+    pageModified[page] = boxes != m_savedPages.value(page);
+  }
+  m_pageStrip->stripModel()->setPageInfo(boxCounts, pageModified);
+}
 
-  if (bIsRedo)
-    m_undostack.push(ui, false);
-  else
-    m_redostack.push(ui);
+void ChildWidget::clearPageProblems() {
+  m_pageProblems.clear();
+  m_problemList->clear();
+  m_problemList->hide();
 }
 
-void ChildWidget::redo() {
-  if (DMESS > 10) qDebug() << Q_FUNC_INFO;
-  if (m_redostack.isEmpty()) {
+bool ChildWidget::isUndoAvailable() {
+  return m_undostack.canUndo() || m_editRow >= 0;
+}
+
+bool ChildWidget::isRedoAvailable() {
+  return m_undostack.canRedo();
+}
+
+void ChildWidget::undo() {
+  TRACE_SPAN(tcUndo);
+  commitRowEdit();
+  if (!m_undostack.canUndo()) {
     emit boxChanged();  // update toolbar/menu to disable undo action
-    // TODO(all): it is not working perfectly (are there some "ghost" undo
-    // actions?). Maybe we need to implement UndoStackView similar to
-    // http://doc-snapshot.qt-project.org/4.8/demos-undo.html
     return;
   }
 
-  UndoItem ui = m_redostack.pop();
-
-  switch (ui.m_eop) {
-  case euoAdd:
-    // Item was added. Reverse is remove it. Redo: Add it again, with values
-    undoAdd(ui, true);
-    break;
-  case euoDelete:
-    // Item was deleted. Reverse is put it back. Redo: delete it again
-    undoDelete(ui, true);
-    break;
-  case euoChange:
-    // Item was edited. Put back old values.
-    undoEdit(ui, true);
-    break;
-  case euoJoin:
-    // Two items joined. Split back.
-    undoSplit(ui, true);
-    break;
-  case euoSplit:
-    // Item split in two. Join back.
-    undoJoin(ui, true);
-    break;
-  case euoReplace:
-    // Two item changed places. Change places back.
-    undoMoveBack(ui, true);
-    break;
-  case euoMove:
-    // Two item changed places. Change places back.
-    undoMoveBack2(ui, true);
-    break;
-  default:
-    // Nothing to do for other cases. Report error.
+  applyUndoCommand(m_undostack.undo(), true);
+  emit boxChanged();  // update toolbar/menu
+}
 
-    QMessageBox::warning(
-      this,
-      SETTING_APPLICATION,
-      "Invalid redo operation.");
-    break;
+void ChildWidget::redo() {
+  TRACE_SPAN(tcUndo);
+  commitRowEdit();
+  if (!m_undostack.canRedo()) {
+    emit boxChanged();  // update toolbar/menu to disable redo action
+    return;
   }
 
-  emit boxChanged();
+  applyUndoCommand(m_undostack.redo(), false);
+  emit boxChanged();  // update toolbar/menu
 }
 
 bool ChildWidget::slotChangePage(int sbdPage) {
-  if (DMESS > 10) qDebug() << Q_FUNC_INFO;
-  PIX * pix;
-  QImage image;
+  TRACE_SPAN(tcModel);
+  PerfTimer perfTimer(pcPageTime);
+  commitRowEdit();
   storePage();
   currPage = sbdPage - 1;
 
-  pix = pixReadTiff(imageFile.toLocal8Bit().data(), currPage);
-  image = TessTools::PIX2qImage(pix);
-  pixDestroy(&pix);
+  QImage image = ImageCache::image(imageFile, currPage);
   if (image.isNull()) {
     QMessageBox::information(this, tr("Problem"),
                              tr("Cannot load page %1 from file %1.")
@@ -3052,8 +3605,13 @@ bool ChildWidget::slotChangePage(int sbdPage) {
   }
   imageHeight = image.height();
   imageWidth = image.width();
-  imageScene->removeItem(imageItem);
-  imageItem = imageScene->addPixmap(QPixmap::fromImage(image));
+  {
+    TRACE_SCOPE("show page image", tcRender);
+    imageScene->removeItem(imageItem);
+    delete imageItem;
+    m_pageImage = image;
+    imageItem = imageScene->addPixmap(QPixmap::fromImage(image));
+  }
 
   bool showFontColumns = isFontColumnsShown();
   cleanTable();
@@ -3065,6 +3623,7 @@ bool ChildWidget::slotChangePage(int sbdPage) {
   } else {
     return false;
   }
+  m_pageStrip->setCurrentPage(currPage);
   return true;
 }
 
@@ -3073,36 +3632,50 @@ bool ChildWidget::slotChangePage(int sbdPage) {
  *
  */
 void ChildWidget::storePage() {
+  TRACE_SPAN(tcModel);
+  if (m_suspended)  // pages are up to date, model is empty
+    return;
   QModelIndex index = selectionModel->currentIndex();
   if (!index.isValid())
     return;
 
-  QVector<QStringList> page;
-  for (int row = 0; row < model->rowCount(); ++row) {
-    QString letter = model->index(row, 0).data().toString();
-    QString left = model->index(row, 1).data().toString();
-    int bottom = model->index(row, 2).data().toInt();
-    QString right = model->index(row, 3).data().toString();
-    int top = model->index(row, 4).data().toInt();
-    QString pageNum = model->index(row, 5).data().toString();
-    bool italic = model->index(row, 6).data().toBool();
-    bool bold = model->index(row, 7).data().toBool();
-    bool underline = model->index(row, 8).data().toBool();
-    if (underline)
-      letter.prepend("\'");
-    if (italic)
-      letter.prepend("$");
-    if (bold)
-      letter.prepend("@");
-    QStringList box;
-    box << letter << left << QString::number(imageHeight - bottom)
-        << right  << QString::number(imageHeight - top) << pageNum;
-    page.append(box);
-  }
-  pages[currPage] = page;
+  pages[currPage] = modelPage();
+}
+
+// Boxes of current page in box file form
+BoxPage ChildWidget::modelPage() {
+  BoxPage page;
+  page.reserve(model->rowCount());
+  for (int row = 0; row < model->rowCount(); ++row)
+    page.append(modelBox(row));
+  return page;
+}
+
+// Box of one row in box file form
+QStringList ChildWidget::modelBox(int row) {
+  QString letter = model->index(row, 0).data().toString();
+  QString left = model->index(row, 1).data().toString();
+  int bottom = model->index(row, 2).data().toInt();
+  QString right = model->index(row, 3).data().toString();
+  int top = model->index(row, 4).data().toInt();
+  QString pageNum = model->index(row, 5).data().toString();
+  bool italic = model->index(row, 6).data().toBool();
+  bool bold = model->index(row, 7).data().toBool();
+  bool underline = model->index(row, 8).data().toBool();
+  if (underline)
+    letter.prepend("\'");
+  if (italic)
+    letter.prepend("$");
+  if (bold)
+    letter.prepend("@");
+  QStringList box;
+  box << letter << left << QString::number(imageHeight - bottom)
+      << right  << QString::number(imageHeight - top) << pageNum;
+  return box;
 }
 
 void ChildWidget::cleanTable() {
+  TRACE_SPAN(tcModel);
   // Hide current selection - it is not valid on other page
   QModelIndexList indexes = table->selectionModel()->selectedRows();
   if (!indexes.empty()) {
@@ -3115,6 +3688,11 @@ void ChildWidget::cleanTable() {
     }
   }
 
+  // Boxes of page are not needed anymore
+  for (int row = 0; row < model->rowCount(); ++row)
+    deleteModelItemBox(row);
+  clearPageProblems();
+
   selectionModel->clearSelection();
   model->clear();
   delete selectionModel;
@@ -45,21 +45,33 @@
 #include <QGraphicsView>
 #include <QHeaderView>
 #include <QHBoxLayout>
+#include <QListWidget>
 #include <QMessageBox>
 #include <QMouseEvent>
 #include <QPixmap>
+#include <QProgressBar>
 #include <QRubberBand>
 #include <QSpinBox>
 #include <QSplitter>
 #include <QStandardItemModel>
 #include <QTableView>
 #include <QTableWidgetItem>
+#include <QThreadPool>
+#include <QTimer>
 #include <QTransform>
 
 #if QT_VERSION >= QT_VERSION_CHECK(5, 0, 0)
 #include <QGuiApplication>
 #endif
 
+#include "BoxLinter.h"
+#include "EditJournal.h"
+#include "GlyphClusters.h"
+#include "ImageView.h"
+#include "InkMap.h"
+#include "SymbolStats.h"
+#include "UndoStack.h"
+
 class QGraphicsScene;
 class QGraphicsView;
 class QAbstractItemModel;
@@ -68,26 +80,13 @@ class QTableView;
 class QGraphicsItem;
 class QGraphicsRectItem;
 class FindDialog;
+class SymbolStatsDialog;
+class GlyphGallery;
+class ClusterDialog;
+struct LoadedDocument;
+class PageStrip;
 class DrawRectangle;
 
-enum undoOperation {
-    euoAdd = 1,
-    euoDelete = 2,
-    euoChange = 4,
-    euoJoin = 8,
-    euoSplit = 16,
-    euoReplace = 32,
-    euoMove = 64
-};
-
-struct UndoItem {
-    undoOperation m_eop;
-    int m_origrow;
-    int m_extrarow;
-    QVariant m_vdata[9];
-    QVariant m_vextradata[9];
-};
-
 // Overhead symbol displayed in Show symbol mode
 struct BalloonSymbol {
     // Symbol itself
@@ -138,13 +137,17 @@ class DragResizer : public QObject, QGraphicsItemGroup {
 
   signals:
     void changed();
+    void finished();
 };
 
 class ChildWidget : public QSplitter {
     Q_OBJECT
+    // benchmarks/BoxBenchmark.cpp measures private load/render paths
+    friend class ChildWidgetBenchmark;
 
   public:
     explicit ChildWidget(QWidget* parent = 0);
+    ~ChildWidget();
 
     bool isModified() {
         return modified;
@@ -160,6 +163,10 @@ class ChildWidget : public QSplitter {
     bool isFontColumnsShown();
     bool isDrawBoxes();
     bool isDrawRect();
+    bool isPerfHudVisible();
+    bool isSuspended() {
+        return m_suspended;
+    }
 
     QString userFriendlyCurrentFile();
     QString getSymbolHexCode();
@@ -173,12 +180,21 @@ class ChildWidget : public QSplitter {
     bool reloadImg();
     bool save(const QString& fileName);
     bool splitToFeatureBF(const QString& fileName);
-    bool saveString(const QString& fileName, const QString& qData);
-    bool createStringImage(const QString& fileName, const QString& qData);
     bool importSPLToChild(const QString& fileName);
     bool importTextToChild(const QString& fileName);
     bool exportTxt(const int& eType, const QString& fileName);
+    // Read and show document in GUI thread
     bool loadImage(const QString& fileName);
+    // Show placeholder until document of request loadId is attached
+    void startLoading(const QString& fileName, int loadId);
+    void setLoadProgress(int step);
+    bool attachDocument(const LoadedDocument& document);
+    bool isLoading() const {
+        return m_loadId != 0;
+    }
+    int loadId() const {
+        return m_loadId;
+    }
     bool loadBoxes(const QString& fileName);
     bool qCreateBoxes(const QString &boxFileName);
     bool makeBoxPage();
@@ -203,15 +219,31 @@ class ChildWidget : public QSplitter {
     void copyFromCell();
     void pasteToCell();
     void drawRectangle(bool checked);
+    void setPerfHudVisible(bool v);
+    /** Release page image, scene boxes and table model of inactive tab.
+     *  Only boxes in 'pages' and view state are kept; resume() restores rest.
+     */
+    void suspend();
+    void resume();
+    // Estimated memory that can be released by suspend()
+    qint64 residentBytes();
+    // Document state for session (image, page, selection, zoom, scroll)
+    QVariantMap sessionState();
+    /** Remember session state of document, it is loaded in background and
+     *  attached by loadPending() when tab is shown for the first time.
+     */
+    void setPendingState(const QVariantMap& state);
+    bool isPending() {
+        return !m_pendingState.isEmpty();
+    }
+    bool loadPending(const LoadedDocument& document);
     void readSettings();
 
   public slots:
     void updateColWidthsOnSplitter(int pos, int index);
 
     void letterStartEdit();
-    void letterEditFinished();
     void sbValueChanged(int sbdValue);
-    void sbFinished();
     void insertSymbol();
     void splitSymbol();
     void joinSymbol();
@@ -223,23 +255,52 @@ class ChildWidget : public QSplitter {
     void moveUp();
     void moveDown();
     void moveTo();
+    void sortByReadingOrder();
+    void fitToInk();
     void goToRow();
     void find();
+    void checkBoxes();
+    void showSymbolStats();
+    void showGlyphGallery();
+    void findSimilarGlyphs();
     void findNext(const QString &symbol, Qt::CaseSensitivity mc);
     void findPrev(const QString &symbol, Qt::CaseSensitivity mc);
+    void replaceAll(const QString &symbol, const QString &replacement,
+                    Qt::CaseSensitivity mc, bool regExp, bool allPages,
+                    int styleFilter);
 
     void boxDragChanged();
+    void boxDragFinished();
 
   private:
     void initTable();
-    void deleteSymbolByRow(int row);
-    void undoDelete(UndoItem& ui, bool bIsRedo = false);
-    void undoAdd(UndoItem& ui, bool bIsRedo = false);
-    void undoEdit(UndoItem& ui, bool bIsRedo = false);
-    void undoJoin(UndoItem& ui, bool bIsRedo = false);
-    void undoSplit(UndoItem& ui, bool bIsRedo = false);
-    void undoMoveBack(UndoItem& ui, bool bIsRedo = false);
-    void undoMoveBack2(UndoItem& ui, bool bIsRedo = false);
+
+    // All undoable changes of model go through these functions
+    QVariantList rowValues(int row);
+    void setCell(int row, int column, const QVariant& value);
+    void insertBoxRow(int row, const QVariantList& values);
+    void removeBoxRow(int row);
+    void recordUndoStep(const UndoStep& step);
+    void setSymbols(const QStringList& symbols, const QString& text);
+    void permuteRows(const QVector<int>& order, bool inverse);
+    void beginUndoMacro(const QString& text);
+    void endUndoMacro();
+    /** Remember row values before editing in table/by dragging.
+     *  Changed cells are recorded by commitRowEdit() as one undo command.
+     */
+    void beginRowEdit(int row);
+    void restoreBoxRow(int row, const QVariantList& values);
+    void updateLetterFont(int row);
+    void emitRowsChanged(int firstRow, int lastRow);
+    void applyUndoSteps(const QVector<UndoStep>& steps, bool undo);
+    void applyUndoCommand(const UndoCommand& command, bool undo);
+    // Replay journal of crashed session and start new journal
+    void recoverJournal();
+    /** Check that steps of journal record fit to rows of pages; row counts
+     *  of pages are updated as if record was applied.
+     */
+    bool isValidJournalRecord(const JournalRecord& record,
+                              QVector<int>* rowCounts);
     bool symbolShown;
     bool boxesVisible;
     bool drawnRectangle;
@@ -261,6 +322,9 @@ class ChildWidget : public QSplitter {
     void setFileWatcher(const QString & fileName);
 
     void moveSymbolRow(int direction);
+    QVector<int> selectedRowNumbers();
+    void moveRows(const QVector<int>& rows, int destination, bool inverse);
+    void moveRowBlock(const QVector<int>& rows, int destination);
     QList<QTableWidgetItem*> takeRow(int row);
     void calculateTableWidth();
 
@@ -280,6 +344,8 @@ class ChildWidget : public QSplitter {
      *  of all pages.
      */
     void storePage();
+    BoxPage modelPage();
+    QStringList modelBox(int row);
     /**
      * Cleans all data in table view
      */
@@ -294,6 +360,24 @@ class ChildWidget : public QSplitter {
                           const QItemSelection& deselected);
     void updateSelectionRects();
     void slotfileChanged(const QString& fileName);
+    void modelItemChanged(QStandardItem* item);
+    void commitRowEdit();
+    void boxesChecked(const QVector<BoxProblem>& problems);
+    void startPageCheck();
+    void pageChecked(int page, const QVector<BoxProblem>& problems);
+    void snapshotRowsChanged(const QModelIndex& topLeft,
+                             const QModelIndex& bottomRight);
+    void snapshotRowsInserted(const QModelIndex& parent, int first, int last);
+    void snapshotRowsRemoved(const QModelIndex& parent, int first, int last);
+    void invalidateSnapshot();
+    void problemClicked(QListWidgetItem* item);
+    void symbolStatsSelected(const QString& symbol);
+    void goToBox(int page, int row);
+    void refreshGlyphGallery();
+    void glyphsClustered(const QVector<GlyphCluster>& clusters);
+    void pageStripActivated(int page);
+    void updatePerfHud();
+    void applyViewScroll();
 
   signals:
     void boxChanged();
@@ -315,10 +399,9 @@ class ChildWidget : public QSplitter {
     void setCurrentBoxFile(const QString& fileName);
 
     QString strippedName(const QString& fullFileName);
-    QImage gItem2qImage();
 
     QGraphicsScene* imageScene;
-    QGraphicsView* imageView;
+    ImageView* imageView;
     QWidget* pageWidget;
     QGraphicsItem* imageItem;
     QGraphicsRectItem* rectangle;
@@ -361,32 +444,70 @@ class ChildWidget : public QSplitter {
 
     DragResizer* resizer;
 
-    template<class T>
-    class UndoStack : public QStack<T> {
-      public:
-        void SetRedoStack(QStack<T>* pRedoStack) {
-            m_pRedoStack = pRedoStack;
-        }
-
-        // Overide
-        void push(const T &t, bool bClearRedo = true) {
-            // When a new undo item is push we need
-            // To clear the redo stack.
-            if (m_pRedoStack && bClearRedo) {
-                m_pRedoStack->clear();
-            }
-            // Now call base class implementation
-            QStack<T>::push(t);
-        }
-
-      private:
-        QStack<T>*  m_pRedoStack;
-    };
-
-    UndoStack<UndoItem> m_undostack;
-    QStack<UndoItem> m_redostack;
-    bool bIsSpinBoxChanged;
-    bool bIsLineEditChanged;
+    UndoStack m_undostack;
+    int m_editRow;
+    QVariantList m_editValues;
+    bool m_editByDrag;
+    EditJournal m_journal;
+
+    BoxLinter* m_linter;
+
+    // Background check of shown page (GUI/BackgroundCheck)
+    bool m_backgroundCheck;
+    QColor m_problemColor;
+    QTimer* m_checkTimer;  // check starts when editing pauses
+    QVector<BoxProblem> m_pageProblems;
+    // shown page for checks; changed rows are empty until next check
+    BoxPage m_checkSnapshot;
+    bool m_snapshotValid;
+    QListWidget* m_problemList;
+    void scheduleCheck();
+    void tintProblemBoxes();
+    void clearPageProblems();
+
+    // Statistics of all pages, updated with checks of page
+    SymbolStats m_symbolStats;
+    SymbolStatsDialog* m_statsDialog;
+    bool isSymbolStatsShown() const;
+    // pages with current page from table
+    BoxPages currentPages(const BoxPage& shown);
+    void updateSymbolStats(const BoxPage& shown);
+
+    GlyphGallery* m_gallery;
+
+    int m_loadId;  // request of DocumentLoader until document is attached
+    QProgressBar* m_loadProgress;
+
+    // Thumbnails of pages of multi-page image (GUI/PageStrip)
+    PageStrip* m_pageStrip;
+    BoxPages m_savedPages;  // pages as they are in box file
+    bool isPageStripShown() const;
+    void updatePageStrip(const BoxPage& shown);
+    ClusterDialog* m_clusterDialog;
+    QThreadPool m_clusterPool;  // one clustering at a time
+
+    // Shown page (shared with ImageCache unless it was binarized)
+    QImage m_pageImage;
+
+    QTimer* m_perfHudTimer;  // refresh of performance overlay
+    qint64 imageBytes();
+
+    // View state of suspended tab
+    bool m_suspended;
+    int m_suspendedRow;
+    QVariantList m_suspendedSelection;
+    QTransform m_suspendedTransform;
+    QPoint m_suspendedScroll;
+    QVariantMap m_pendingState;
+    QPoint m_restoreScroll;
+    // Binarized page for fitToInk, key of page image it was made from
+    const InkMap& inkMap();
+    InkMap m_inkMap;
+    qint64 m_inkMapKey;
+    // Selected rows as ranges: first, last, first, last...
+    QVariantList selectionRanges();
+    void restoreViewState(int row, const QVariantList& selection,
+                          const QTransform& transform, const QPoint& scroll);
 };
 
 #endif  // SRC_CHILDWIDGET_H_
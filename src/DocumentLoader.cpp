@@ -0,0 +1,127 @@
+/**********************************************************************
+* File:        DocumentLoader.cpp
+* Description: Decoding and parsing of opened documents in worker threads
+* Author:      Zdenko Podobny
+* Created:     2026-10-19
+*
+* (C) Copyright 2026, Zdenko Podobny
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**    http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*
+**********************************************************************/
+
+
+#include <QFile>
+#include <QRunnable>
+#include <QTextStream>
+
+#include "DocumentLoader.h"
+#include "ImageCache.h"
+#include "TiffIndex.h"
+#include "Trace.h"
+
+class DocumentLoadJob : public QRunnable {
+  public:
+    DocumentLoadJob(DocumentLoader* loader, int id, const QString& imageFile)
+        : m_loader(loader), m_id(id), m_imageFile(imageFile) {
+    }
+
+    void run() {
+        LoadedDocument document = DocumentLoader::read(m_imageFile, m_id,
+                                                       m_loader);
+        QMetaObject::invokeMethod(m_loader, "jobFinished",
+                                  Qt::QueuedConnection,
+                                  Q_ARG(LoadedDocument, document));
+    }
+
+  private:
+    DocumentLoader* m_loader;
+    int m_id;
+    QString m_imageFile;
+};
+
+static void reportStep(DocumentLoader* loader, int id, int step) {
+  if (loader)
+    QMetaObject::invokeMethod(loader, "jobProgress", Qt::QueuedConnection,
+                              Q_ARG(int, id), Q_ARG(int, step));
+}
+
+DocumentLoader::DocumentLoader(QObject* parent)
+  : QObject(parent) {
+  qRegisterMetaType<LoadedDocument>();
+  m_lastId = 0;
+}
+
+/*
+ * Job posts result to loader, so it must not outlive it
+ */
+DocumentLoader::~DocumentLoader() {
+  m_pool.clear();
+  m_pool.waitForDone();
+}
+
+int DocumentLoader::start(const QString& imageFile) {
+  m_pool.start(new DocumentLoadJob(this, ++m_lastId, imageFile));
+  return m_lastId;
+}
+
+/*
+ * Decoded page is stored in ImageCache, so it is shared with OCR, exports
+ * and other tabs of the same image.
+ */
+LoadedDocument DocumentLoader::read(const QString& imageFile, int id,
+                                    DocumentLoader* loader) {
+  TRACE_SPAN(tcIO);
+  LoadedDocument document;
+  document.m_id = id;
+  document.m_imageFile = imageFile;
+  document.m_pageCount = 0;
+  document.m_hasBoxes = false;
+
+  // index is kept open for decoding of pages
+  QSharedPointer<const TiffIndex> tiff = TiffIndex::open(imageFile);
+  if (tiff)
+    document.m_pageCount = tiff->pageCount();
+  reportStep(loader, id, 1);
+
+  document.m_image = ImageCache::image(imageFile, 0);
+  if (document.m_image.isNull()) {
+    document.m_error = tr("Cannot load %1.").arg(imageFile);
+    return document;
+  }
+  reportStep(loader, id, 2);
+
+  document.m_boxFile = BoxFile::boxFileName(imageFile);
+  QFile file(document.m_boxFile);
+  if (file.exists()) {
+    if (!file.open(QFile::ReadOnly | QFile::Text)) {
+      document.m_error = tr("Cannot read file %1:\n%2.")
+                         .arg(document.m_boxFile).arg(file.errorString());
+      return document;
+    }
+    QTextStream boxdata(&file);
+    if (!BoxFile::read(boxdata, &document.m_pages, &document.m_error))
+      return document;
+    document.m_hasBoxes = true;
+  }
+  reportStep(loader, id, kLoadSteps);
+  return document;
+}
+
+void DocumentLoader::jobProgress(int id, int step) {
+  emit progress(id, step);
+}
+
+void DocumentLoader::jobFinished(const LoadedDocument& document) {
+  emit loaded(document);
+}
@@ -0,0 +1,82 @@
+/**********************************************************************
+* File:        DocumentLoader.h
+* Description: Decoding and parsing of opened documents in worker threads
+* Author:      Zdenko Podobny
+* Created:     2026-10-19
+*
+* (C) Copyright 2026, Zdenko Podobny
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**    http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*
+**********************************************************************/
+
+
+#ifndef SRC_DOCUMENTLOADER_H_
+#define SRC_DOCUMENTLOADER_H_
+
+#include <QImage>
+#include <QMetaType>
+#include <QObject>
+#include <QString>
+#include <QThreadPool>
+
+#include "BoxFile.h"
+
+// Everything ChildWidget needs from disk to show document
+struct LoadedDocument {
+    int m_id;              // request id from DocumentLoader::start()
+    QString m_imageFile;
+    QString m_boxFile;
+    int m_pageCount;       // 0 unless image is TIFF
+    QImage m_image;        // the first page
+    bool m_hasBoxes;       // box file exists and it was read to m_pages
+    BoxPages m_pages;
+    QString m_error;
+};
+Q_DECLARE_METATYPE(LoadedDocument)
+
+/*
+ * Documents are decoded and parsed in parallel by worker threads (one job
+ * per document); results are delivered by signal loaded() in GUI thread,
+ * where they are attached to table model and scene (ChildWidget).
+ */
+class DocumentLoader : public QObject {
+    Q_OBJECT
+
+  public:
+    // Steps reported by progress(): page count, image, box file
+    static const int kLoadSteps = 3;
+
+    explicit DocumentLoader(QObject* parent = 0);
+    ~DocumentLoader();
+
+    // Returns id of request, it is passed with signals
+    int start(const QString& imageFile);
+    // Load document in calling thread
+    static LoadedDocument read(const QString& imageFile, int id = 0,
+                               DocumentLoader* loader = 0);
+
+  signals:
+    void progress(int id, int step);
+    void loaded(const LoadedDocument& document);
+
+  private slots:
+    void jobProgress(int id, int step);
+    void jobFinished(const LoadedDocument& document);
+
+  private:
+    QThreadPool m_pool;
+    int m_lastId;
+};
+
+#endif  // SRC_DOCUMENTLOADER_H_
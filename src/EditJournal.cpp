@@ -0,0 +1,201 @@
+/**********************************************************************
+* File:        EditJournal.cpp
+* Description: Write-ahead journal of edits for crash recovery
+* Author:      Zdenko Podobny
+* Created:     2026-10-19
+*
+* (C) Copyright 2026, Zdenko Podobny
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**    http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*
+**********************************************************************/
+
+#include <QDataStream>
+#include <QDateTime>
+#include <QDebug>
+#include <QFileInfo>
+
+#ifdef Q_OS_WIN
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+#include "EditJournal.h"
+#include "Trace.h"
+
+static const quint32 kJournalMagic = 0x51424A4C;  // "QBJL"
+static const quint32 kJournalVersion = 1;
+// Records are written immediately, but synced to disk at most once per
+// interval, so editing is not slowed down by disk
+static const int kSyncInterval = 1000;  // ms
+
+static void boxFileStamp(const QString& boxFileName, qint64* size,
+                         qint64* time) {
+  QFileInfo fi(boxFileName);
+  if (fi.exists()) {
+    *size = fi.size();
+    *time = fi.lastModified().toMSecsSinceEpoch();
+  } else {
+    *size = -1;
+    *time = -1;
+  }
+}
+
+EditJournal::EditJournal(QObject* parent)
+  : QObject(parent) {
+  m_boxSize = -1;
+  m_boxTime = -1;
+  m_dirty = false;
+  m_syncTimer.setSingleShot(true);
+  m_syncTimer.setInterval(kSyncInterval);
+  connect(&m_syncTimer, SIGNAL(timeout()), this, SLOT(sync()));
+}
+
+EditJournal::~EditJournal() {
+  close(false);
+}
+
+QString EditJournal::journalFileName(const QString& boxFileName) {
+  return boxFileName + ".journal";
+}
+
+bool EditJournal::readRecords(const QString& boxFileName,
+                              QList<JournalRecord>* records) {
+  QFile file(journalFileName(boxFileName));
+  if (!file.exists() || !file.open(QIODevice::ReadOnly))
+    return false;
+
+  QDataStream in(&file);
+  in.setVersion(QDataStream::Qt_5_0);
+  quint32 magic, version;
+  qint64 boxSize, boxTime;
+  in >> magic >> version >> boxSize >> boxTime;
+  if (in.status() != QDataStream::Ok || magic != kJournalMagic ||
+      version != kJournalVersion)
+    return false;
+
+  // Journal is valid only for box file it was started with
+  qint64 size, time;
+  boxFileStamp(boxFileName, &size, &time);
+  if (size != boxSize || time != boxTime ||
+      QFileInfo(file).lastModified().toMSecsSinceEpoch() < time)
+    return false;
+
+  while (!in.atEnd()) {
+    QByteArray data;
+    in >> data;
+    if (in.status() != QDataStream::Ok)
+      break;  // last record was not written completely
+
+    QDataStream record(data);
+    record.setVersion(QDataStream::Qt_5_0);
+    quint8 type;
+    qint32 page, count;
+    JournalRecord rec;
+    record >> type >> page >> rec.m_command.m_text >> count;
+    rec.m_type = static_cast<journalRecordType>(type);
+    rec.m_command.m_page = page;
+    rec.m_command.m_bytes = 0;
+    for (int i = 0; i < count && record.status() == QDataStream::Ok; ++i) {
+      quint8 eop;
+      qint32 row, arg;
+      UndoStep step;
+      record >> eop >> row >> arg >> step.m_before >> step.m_after;
+      step.m_eop = static_cast<undoOperation>(eop);
+      step.m_row = row;
+      step.m_arg = arg;
+      rec.m_command.m_steps.append(step);
+    }
+    if (record.status() != QDataStream::Ok || type < ejrCommand ||
+        type > ejrRedo) {
+      qWarning() << "Invalid record in journal" << file.fileName();
+      break;
+    }
+    records->append(rec);
+  }
+  return !records->isEmpty();
+}
+
+void EditJournal::start(const QString& boxFileName, bool keepRecords) {
+  QString fileName = journalFileName(boxFileName);
+  close(!keepRecords || fileName != m_fileName);
+  if (!keepRecords)
+    QFile::remove(fileName);
+  m_fileName = fileName;
+  boxFileStamp(boxFileName, &m_boxSize, &m_boxTime);
+}
+
+void EditJournal::close(bool remove) {
+  m_syncTimer.stop();
+  if (m_file.isOpen()) {
+    if (!remove)
+      sync();
+    m_file.close();
+  }
+  if (remove && !m_fileName.isEmpty())
+    QFile::remove(m_fileName);
+  m_fileName.clear();
+  m_dirty = false;
+}
+
+void EditJournal::append(journalRecordType type, const UndoCommand& command) {
+  QByteArray data;
+  QDataStream record(&data, QIODevice::WriteOnly);
+  record.setVersion(QDataStream::Qt_5_0);
+  record << quint8(type) << qint32(command.m_page) << command.m_text
+         << qint32(command.m_steps.size());
+  for (int i = 0; i < command.m_steps.size(); ++i) {
+    const UndoStep& step = command.m_steps.at(i);
+    record << quint8(step.m_eop) << qint32(step.m_row) << qint32(step.m_arg)
+           << step.m_before << step.m_after;
+  }
+  writeRecord(data);
+}
+
+void EditJournal::writeRecord(const QByteArray& record) {
+  if (m_fileName.isEmpty())
+    return;
+
+  QDataStream out(&m_file);
+  out.setVersion(QDataStream::Qt_5_0);
+  if (!m_file.isOpen()) {
+    // journal file is created with first record
+    m_file.setFileName(m_fileName);
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Append)) {
+      qWarning() << "Cannot write journal" << m_fileName
+                 << m_file.errorString();
+      m_fileName.clear();
+      return;
+    }
+    if (m_file.size() == 0)
+      out << kJournalMagic << kJournalVersion << m_boxSize << m_boxTime;
+  }
+  out << record;
+  m_dirty = true;
+  if (!m_syncTimer.isActive())
+    m_syncTimer.start();
+}
+
+void EditJournal::sync() {
+  if (!m_dirty || !m_file.isOpen())
+    return;
+  TRACE_SPAN(tcIO);
+  m_file.flush();
+#ifdef Q_OS_WIN
+  _commit(m_file.handle());
+#else
+  fsync(m_file.handle());
+#endif
+  m_dirty = false;
+}
@@ -0,0 +1,92 @@
+/**********************************************************************
+* File:        EditJournal.h
+* Description: Write-ahead journal of edits for crash recovery
+* Author:      Zdenko Podobny
+* Created:     2026-10-19
+*
+* (C) Copyright 2026, Zdenko Podobny
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**    http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*
+**********************************************************************/
+
+#ifndef SRC_EDITJOURNAL_H_
+#define SRC_EDITJOURNAL_H_
+
+#include <QFile>
+#include <QList>
+#include <QObject>
+#include <QString>
+#include <QTimer>
+
+#include "UndoStack.h"
+
+enum journalRecordType {
+    ejrCommand = 1,   // new undo command (m_command)
+    ejrUndo = 2,      // command m_command was undone
+    ejrRedo = 3       // command m_command was redone
+};
+
+struct JournalRecord {
+    journalRecordType m_type;
+    UndoCommand m_command;
+};
+
+/*
+ * Append-only journal of undo commands stored next to box file
+ * (<box file>.journal). It is removed after successful save, so existing
+ * journal means unsaved edits of crashed session. Journal is valid only
+ * for box file with the same size and modification time as it had when
+ * journal was started.
+ */
+class EditJournal : public QObject {
+    Q_OBJECT
+
+  public:
+    explicit EditJournal(QObject* parent = 0);
+    ~EditJournal();
+
+    static QString journalFileName(const QString& boxFileName);
+    // Read records of journal left by crashed session of boxFileName
+    static bool readRecords(const QString& boxFileName,
+                            QList<JournalRecord>* records);
+
+    /** Start journal for box file. File is created with first record;
+     *  existing records are kept only if keepRecords is true (recovery).
+     */
+    void start(const QString& boxFileName, bool keepRecords = false);
+    // Stop journaling; journal file is deleted if remove is true
+    void close(bool remove);
+    bool isActive() const {
+        return !m_fileName.isEmpty();
+    }
+
+    // Undo/redo records keep the command too - history before last save
+    // is not in journal
+    void append(journalRecordType type, const UndoCommand& command);
+
+  public slots:
+    void sync();
+
+  private:
+    void writeRecord(const QByteArray& record);
+
+    QString m_fileName;
+    QFile m_file;
+    QTimer m_syncTimer;
+    qint64 m_boxSize;
+    qint64 m_boxTime;
+    bool m_dirty;
+};
+
+#endif  // SRC_EDITJOURNAL_H_
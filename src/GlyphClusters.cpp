@@ -0,0 +1,325 @@
+/**********************************************************************
+* File:        GlyphClusters.cpp
+* Description: Clusters of visually similar glyphs with different labels
+* Author:      Zdenko Podobny
+* Created:     2026-10-19
+*
+* (C) Copyright 2026, Zdenko Podobny
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**    http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*
+**********************************************************************/
+
+
+#include <algorithm>
+
+#include <QHash>
+#include <QRunnable>
+#include <QThreadPool>
+#include <qmath.h>
+
+#include "GlyphClusters.h"
+#include "Trace.h"
+
+// Glyphs with height ratio (relative to median of page) bigger than this
+// are not similar even if their shapes are (e.g. 'o' and 'O')
+static const float kMaxHeightRatio = 1.3f;
+
+namespace {
+
+struct GlyphData {
+    QString m_label;
+    BoxRef m_ref;
+    float m_height;      // relative to median height of page
+    bool m_valid;        // not blank
+};
+
+bool similarHeight(float a, float b) {
+  return a <= b * kMaxHeightRatio && b <= a * kMaxHeightRatio;
+}
+
+class FeatureJob : public QRunnable {
+  public:
+    FeatureJob(const PageImageSource& pageImage, const BoxPage& boxes,
+               int page, GlyphData* glyphs, float* features)
+        : m_pageImage(pageImage), m_boxes(boxes), m_page(page),
+          m_glyphs(glyphs), m_features(features) {
+    }
+
+    void run() {
+        TRACE_SCOPE("FeatureJob", tcOCR);
+        QImage image = m_pageImage(m_page);
+        if (image.format() != QImage::Format_Grayscale8)
+          image = image.convertToFormat(QImage::Format_Grayscale8);
+        QVector<int> heights;
+        for (int row = 0; row < m_boxes.size(); ++row)
+          heights.append(m_boxes.at(row).value(4).toInt() -
+                         m_boxes.at(row).value(2).toInt());
+        float median = 1;
+        if (!heights.isEmpty()) {
+          std::nth_element(heights.begin(), heights.begin() +
+                           heights.size() / 2, heights.end());
+          median = qMax(1, heights.at(heights.size() / 2));
+        }
+
+        for (int row = 0; row < m_boxes.size(); ++row) {
+          const QStringList& box = m_boxes.at(row);
+          bool bold, italic, underline;
+          GlyphData& glyph = m_glyphs[row];
+          glyph.m_label = BoxFile::stripStyleFlags(box.value(0), &bold,
+                                                   &italic, &underline);
+          glyph.m_ref.m_page = m_page;
+          glyph.m_ref.m_row = row;
+          int left = box.value(1).toInt();
+          int bottom = box.value(2).toInt();
+          int right = box.value(3).toInt();
+          int top = box.value(4).toInt();
+          glyph.m_height = (top - bottom) / median;
+          QRect crop(QPoint(left, image.height() - top),
+                     QPoint(right - 1, image.height() - bottom - 1));
+          glyph.m_valid = !image.isNull() &&
+            GlyphClusters::feature(image, crop,
+                                   m_features +
+                                   row * GlyphClusters::kDimension);
+        }
+    }
+
+  private:
+    PageImageSource m_pageImage;
+    BoxPage m_boxes;
+    int m_page;
+    GlyphData* m_glyphs;
+    float* m_features;
+};
+
+/*
+ * Leader clustering: item joins the most similar leader or becomes a new
+ * one. Leaders are indexes to features.
+ */
+void leaderClusters(const QVector<int>& items, const float* features,
+                    const QVector<float>& heights, float threshold,
+                    QVector<int>* leaders, QVector<int>* leaderOfItem) {
+  leaders->clear();
+  leaderOfItem->resize(items.size());
+  for (int i = 0; i < items.size(); ++i) {
+    const float* f = features + items.at(i) * GlyphClusters::kDimension;
+    int best = -1;
+    float bestSimilarity = threshold;
+    for (int k = 0; k < leaders->size(); ++k) {
+      int leader = leaders->at(k);
+      if (!similarHeight(heights.at(items.at(i)), heights.at(leader)))
+        continue;
+      float s = GlyphClusters::similarity(
+        f, features + leader * GlyphClusters::kDimension);
+      if (s >= bestSimilarity) {
+        bestSimilarity = s;
+        best = k;
+      }
+    }
+    if (best < 0) {
+      best = leaders->size();
+      leaders->append(items.at(i));
+    }
+    (*leaderOfItem)[i] = best;
+  }
+}
+
+class LabelClusterJob : public QRunnable {
+  public:
+    LabelClusterJob(const QVector<int>& items, const float* features,
+                    const QVector<float>& heights, float threshold,
+                    QVector<int>* leaders, QVector<int>* leaderOfItem)
+        : m_items(items), m_features(features), m_heights(heights),
+          m_threshold(threshold), m_leaders(leaders),
+          m_leaderOfItem(leaderOfItem) {
+    }
+
+    void run() {
+        TRACE_SCOPE("LabelClusterJob", tcOCR);
+        leaderClusters(m_items, m_features, m_heights, m_threshold,
+                       m_leaders, m_leaderOfItem);
+    }
+
+  private:
+    QVector<int> m_items;
+    const float* m_features;
+    const QVector<float>& m_heights;
+    float m_threshold;
+    QVector<int>* m_leaders;
+    QVector<int>* m_leaderOfItem;
+};
+
+}  // namespace
+
+/*
+ * Darkness is summed to cells of square around crop (glyph is centered),
+ * then vector is normalized.
+ */
+bool GlyphClusters::feature(const QImage& gray, const QRect& crop,
+                            float* out) {
+  std::fill(out, out + kDimension, 0.0f);
+  QRect r = crop & gray.rect();
+  if (r.isEmpty())
+    return false;
+  int side = qMax(crop.width(), crop.height());
+  int offsetX = crop.left() - (side - crop.width()) / 2;
+  int offsetY = crop.top() - (side - crop.height()) / 2;
+  for (int y = r.top(); y <= r.bottom(); ++y) {
+    const uchar* line = gray.constScanLine(y);
+    float* cells = out + ((y - offsetY) * kSide / side) * kSide;
+    for (int x = r.left(); x <= r.right(); ++x)
+      cells[(x - offsetX) * kSide / side] += 255 - line[x];
+  }
+
+  float mean = 0;
+  for (int i = 0; i < kDimension; ++i)
+    mean += out[i];
+  mean /= kDimension;
+  float norm = 0;
+  for (int i = 0; i < kDimension; ++i) {
+    out[i] -= mean;
+    norm += out[i] * out[i];
+  }
+  if (norm <= 0)
+    return false;
+  float scale = 1 / qSqrt(norm);
+  for (int i = 0; i < kDimension; ++i)
+    out[i] *= scale;
+  return true;
+}
+
+float GlyphClusters::similarity(const float* a, const float* b) {
+  float sum = 0;
+  for (int i = 0; i < kDimension; ++i)
+    sum += a[i] * b[i];
+  return sum;
+}
+
+QVector<GlyphCluster> GlyphClusters::mixedClusters(
+  const PageImageSource& pageImage, const BoxPages& pages,
+  double similarity) {
+  TRACE_SPAN(tcOCR);
+  int count = 0;
+  QVector<int> firstOfPage;
+  for (int page = 0; page < pages.size(); ++page) {
+    firstOfPage.append(count);
+    count += pages.at(page).size();
+  }
+  QVector<GlyphData> glyphs(count);
+  QVector<float> features(count * kDimension);
+
+  // features of pages in parallel
+  QThreadPool pool;
+  for (int page = 0; page < pages.size(); ++page) {
+    pool.start(new FeatureJob(pageImage, pages.at(page), page,
+                              glyphs.data() + firstOfPage.at(page),
+                              features.data() +
+                              firstOfPage.at(page) * kDimension));
+  }
+  pool.waitForDone();
+
+  QVector<float> heights(count);
+  QHash<QString, QVector<int> > itemsOfLabel;
+  for (int i = 0; i < count; ++i) {
+    heights[i] = glyphs.at(i).m_height;
+    if (glyphs.at(i).m_valid)
+      itemsOfLabel[glyphs.at(i).m_label].append(i);
+  }
+
+  // clusters of every label in parallel
+  QStringList labels = itemsOfLabel.keys();
+  QVector<QVector<int> > leaders(labels.size());
+  QVector<QVector<int> > leaderOfItem(labels.size());
+  for (int l = 0; l < labels.size(); ++l) {
+    pool.start(new LabelClusterJob(itemsOfLabel.value(labels.at(l)),
+                                   features.constData(), heights,
+                                   similarity, &leaders[l],
+                                   &leaderOfItem[l]));
+  }
+  pool.waitForDone();
+
+  // leaders of all labels; bigger clusters lead
+  QVector<int> allLeaders;
+  QVector<int> labelOfLeader;
+  QVector<int> sizeOfLeader;
+  QVector<int> firstLeader;
+  for (int l = 0; l < labels.size(); ++l) {
+    firstLeader.append(allLeaders.size());
+    QVector<int> sizes(leaders.at(l).size(), 0);
+    for (int i = 0; i < leaderOfItem.at(l).size(); ++i)
+      ++sizes[leaderOfItem.at(l).at(i)];
+    allLeaders += leaders.at(l);
+    sizeOfLeader += sizes;
+    labelOfLeader += QVector<int>(leaders.at(l).size(), l);
+  }
+  QVector<int> order(allLeaders.size());
+  for (int i = 0; i < order.size(); ++i)
+    order[i] = i;
+  std::stable_sort(order.begin(), order.end(), [&](int a, int b) {
+    return sizeOfLeader.at(a) > sizeOfLeader.at(b);
+  });
+  QVector<int> orderedLeaders;
+  for (int i = 0; i < order.size(); ++i)
+    orderedLeaders.append(allLeaders.at(order.at(i)));
+  QVector<int> superLeaders;
+  QVector<int> superOfOrdered;
+  leaderClusters(orderedLeaders, features.constData(), heights, similarity,
+                 &superLeaders, &superOfOrdered);
+  QVector<int> superOfLeader(allLeaders.size());
+  for (int i = 0; i < order.size(); ++i)
+    superOfLeader[order.at(i)] = superOfOrdered.at(i);
+
+  // boxes of every super cluster per label
+  QVector<QHash<int, QVector<BoxRef> > > members(superLeaders.size());
+  for (int l = 0; l < labels.size(); ++l) {
+    const QVector<int>& items = itemsOfLabel[labels.at(l)];
+    for (int i = 0; i < items.size(); ++i) {
+      int super = superOfLeader.at(firstLeader.at(l) +
+                                   leaderOfItem.at(l).at(i));
+      members[super][l].append(glyphs.at(items.at(i)).m_ref);
+    }
+  }
+
+  QVector<GlyphCluster> result;
+  QVector<double> minorityShare;
+  for (int s = 0; s < members.size(); ++s) {
+    if (members.at(s).size() < 2)
+      continue;
+    QList<int> labelIds = members.at(s).keys();
+    std::sort(labelIds.begin(), labelIds.end(), [&](int a, int b) {
+      return members.at(s).value(a).size() > members.at(s).value(b).size();
+    });
+    GlyphCluster cluster;
+    int total = 0;
+    for (int i = 0; i < labelIds.size(); ++i) {
+      cluster.m_labels.append(labels.at(labelIds.at(i)));
+      cluster.m_boxes.append(members.at(s).value(labelIds.at(i)));
+      total += cluster.m_boxes.last().size();
+    }
+    result.append(cluster);
+    minorityShare.append(1.0 - double(cluster.m_boxes.first().size()) /
+                         total);
+  }
+
+  QVector<int> resultOrder(result.size());
+  for (int i = 0; i < resultOrder.size(); ++i)
+    resultOrder[i] = i;
+  std::stable_sort(resultOrder.begin(), resultOrder.end(),
+                   [&](int a, int b) {
+                     return minorityShare.at(a) < minorityShare.at(b);
+                   });
+  QVector<GlyphCluster> sorted;
+  for (int i = 0; i < resultOrder.size(); ++i)
+    sorted.append(result.at(resultOrder.at(i)));
+  return sorted;
+}
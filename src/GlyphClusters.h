@@ -0,0 +1,73 @@
+/**********************************************************************
+* File:        GlyphClusters.h
+* Description: Clusters of visually similar glyphs with different labels
+* Author:      Zdenko Podobny
+* Created:     2026-10-19
+*
+* (C) Copyright 2026, Zdenko Podobny
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**    http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*
+**********************************************************************/
+
+
+#ifndef SRC_GLYPHCLUSTERS_H_
+#define SRC_GLYPHCLUSTERS_H_
+
+#include <functional>
+
+#include <QImage>
+#include <QMetaType>
+#include <QRect>
+#include <QStringList>
+#include <QVector>
+
+#include "BoxFile.h"
+#include "SymbolStats.h"
+
+// Similar glyphs with more than one label
+struct GlyphCluster {
+    QStringList m_labels;               // the most frequent first
+    QVector<QVector<BoxRef> > m_boxes;  // boxes of every label
+};
+Q_DECLARE_METATYPE(QVector<GlyphCluster>)
+
+// Decoded page of document; it is called by several threads at once
+typedef std::function<QImage(int page)> PageImageSource;
+
+/*
+ * Every glyph is scaled (aspect is kept) to kSide x kSide darkness bitmap
+ * which is normalized to zero mean and unit length, so similarity of glyphs
+ * is dot product of contiguous float vectors (vectorized by compiler).
+ * Glyphs of every label are clustered in parallel by leader clustering,
+ * then leaders of all labels are clustered the same way. Clusters with
+ * several labels are candidates for labelling errors.
+ */
+class GlyphClusters {
+  public:
+    static const int kSide = 16;
+    static const int kDimension = kSide * kSide;
+
+    // Clusters sorted by share of minority labels (the most suspicious first)
+    static QVector<GlyphCluster> mixedClusters(
+      const PageImageSource& pageImage, const BoxPages& pages,
+      double similarity);
+
+    /** Feature of crop (top-down coordinates) of Format_Grayscale8 page.
+     *  Returns false for blank crop.
+     */
+    static bool feature(const QImage& gray, const QRect& crop, float* out);
+    static float similarity(const float* a, const float* b);
+};
+
+#endif  // SRC_GLYPHCLUSTERS_H_
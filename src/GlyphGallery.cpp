@@ -0,0 +1,262 @@
+/**********************************************************************
+* File:        GlyphGallery.cpp
+* Description: Gallery of box crops grouped by symbol
+* Author:      Zdenko Podobny
+* Created:     2026-10-19
+*
+* (C) Copyright 2026, Zdenko Podobny
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**    http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*
+**********************************************************************/
+
+
+#include <algorithm>
+
+#include <QCloseEvent>
+#include <QDialogButtonBox>
+#include <QPushButton>
+#include <QRunnable>
+#include <QScrollBar>
+#include <QSettings>
+#include <QVBoxLayout>
+
+#include "GlyphGallery.h"
+#include "ImageCache.h"
+#include "Settings.h"
+#include "Trace.h"
+
+// Default memory limit of thumbnail cache (can be changed in settings)
+static const int kDefaultThumbnailCacheMB = 32;
+
+class ThumbnailJob : public QRunnable {
+  public:
+    ThumbnailJob(GlyphGalleryModel* model, const QString& imageFile,
+                 const GlyphKey& key)
+        : m_model(model), m_imageFile(imageFile), m_key(key) {
+    }
+
+    void run() {
+        TRACE_SCOPE("ThumbnailJob", tcRender);
+        QImage page = ImageCache::image(m_imageFile, m_key.m_page);
+        // box coordinates have origin at the bottom
+        QRect crop(QPoint(m_key.m_box.left(),
+                          page.height() - m_key.m_box.bottom() - 1),
+                   QPoint(m_key.m_box.right(),
+                          page.height() - m_key.m_box.top() - 1));
+        crop &= page.rect();
+        QImage thumbnail;
+        if (!crop.isEmpty()) {
+          int size = GlyphGalleryModel::kThumbnailSize;
+          thumbnail = page.copy(crop);
+          if (thumbnail.width() > size || thumbnail.height() > size)
+            thumbnail = thumbnail.scaled(size, size, Qt::KeepAspectRatio,
+                                         Qt::SmoothTransformation);
+        }
+        QMetaObject::invokeMethod(m_model, "thumbnailReady",
+                                  Qt::QueuedConnection,
+                                  Q_ARG(int, m_key.m_page),
+                                  Q_ARG(QRect, m_key.m_box),
+                                  Q_ARG(QImage, thumbnail));
+    }
+
+  private:
+    GlyphGalleryModel* m_model;
+    QString m_imageFile;
+    GlyphKey m_key;
+};
+
+GlyphGalleryModel::GlyphGalleryModel(QObject* parent)
+  : QAbstractListModel(parent) {
+  QSettings settings(QSettings::IniFormat, QSettings::UserScope,
+                     SETTING_ORGANIZATION, SETTING_APPLICATION);
+  int cacheMB = kDefaultThumbnailCacheMB;
+  if (settings.contains("GUI/ThumbnailCacheSize"))
+    cacheMB = settings.value("GUI/ThumbnailCacheSize").toInt();
+  m_thumbnails.setMaxCost(qMax(1, cacheMB) * 1024);  // cost is in KB
+
+  m_placeholder = QImage(kThumbnailSize, kThumbnailSize,
+                         QImage::Format_ARGB32);
+  m_placeholder.fill(Qt::transparent);
+}
+
+/*
+ * Job posts result to model, so it must not outlive it
+ */
+GlyphGalleryModel::~GlyphGalleryModel() {
+  m_pool.clear();
+  m_pool.waitForDone();
+}
+
+void GlyphGalleryModel::setPages(const QString& imageFile,
+                                 const BoxPages& pages) {
+  TRACE_SPAN(tcModel);
+  beginResetModel();
+  if (imageFile != m_imageFile) {
+    cancelPending();
+    m_thumbnails.clear();
+    m_imageFile = imageFile;
+  }
+  m_glyphs.clear();
+  for (int page = 0; page < pages.size(); ++page) {
+    for (int row = 0; row < pages.at(page).size(); ++row) {
+      const QStringList& box = pages.at(page).at(row);
+      bool bold, italic, underline;
+      Glyph glyph;
+      glyph.m_symbol = BoxFile::stripStyleFlags(box.value(0), &bold,
+                                                &italic, &underline);
+      glyph.m_page = page;
+      glyph.m_row = row;
+      glyph.m_box = QRect(QPoint(box.value(1).toInt(), box.value(2).toInt()),
+                          QPoint(box.value(3).toInt() - 1,
+                                 box.value(4).toInt() - 1));
+      m_glyphs.append(glyph);
+    }
+  }
+  // boxes of the same symbol are next to each other (in document order)
+  std::stable_sort(m_glyphs.begin(), m_glyphs.end(),
+                   [](const Glyph& a, const Glyph& b) {
+                     return a.m_symbol < b.m_symbol;
+                   });
+  m_rowsOfKey.clear();
+  endResetModel();
+}
+
+void GlyphGalleryModel::cancelPending() {
+  m_pool.clear();
+  m_pending.clear();
+}
+
+int GlyphGalleryModel::rowCount(const QModelIndex& parent) const {
+  return parent.isValid() ? 0 : m_glyphs.size();
+}
+
+QVariant GlyphGalleryModel::data(const QModelIndex& index, int role) const {
+  if (!index.isValid() || index.row() >= m_glyphs.size())
+    return QVariant();
+  const Glyph& glyph = m_glyphs.at(index.row());
+  switch (role) {
+  case Qt::DisplayRole:
+    return glyph.m_symbol;
+  case Qt::ToolTipRole:
+    return tr("'%1' page %2, row %3").arg(glyph.m_symbol)
+           .arg(glyph.m_page + 1).arg(glyph.m_row + 1);
+  case Qt::DecorationRole: {
+    GlyphKey key = {glyph.m_page, glyph.m_box};
+    QImage* thumbnail = m_thumbnails.object(key);
+    if (thumbnail)
+      return *thumbnail;
+    request(key);
+    QVector<int>& rows =
+      const_cast<GlyphGalleryModel*>(this)->m_rowsOfKey[key];
+    if (!rows.contains(index.row()))
+      rows.append(index.row());
+    return m_placeholder;
+  }
+  case PageRole:
+    return glyph.m_page;
+  case RowRole:
+    return glyph.m_row;
+  default:
+    return QVariant();
+  }
+}
+
+void GlyphGalleryModel::request(const GlyphKey& key) const {
+  if (m_pending.contains(key) || m_imageFile.isEmpty())
+    return;
+  m_pending.insert(key);
+  m_pool.start(new ThumbnailJob(const_cast<GlyphGalleryModel*>(this),
+                                m_imageFile, key));
+}
+
+void GlyphGalleryModel::thumbnailReady(int page, const QRect& box,
+                                       const QImage& thumbnail) {
+  GlyphKey key = {page, box};
+  m_pending.remove(key);
+  int cost = static_cast<int>(thumbnail.sizeInBytes() / 1024);  // KB
+  m_thumbnails.insert(key, new QImage(thumbnail), qMax(1, cost));
+  QVector<int> rows = m_rowsOfKey.take(key);
+  for (int i = 0; i < rows.size(); ++i) {
+    if (rows.at(i) < m_glyphs.size()) {
+      QModelIndex cell = index(rows.at(i));
+      emit dataChanged(cell, cell);
+    }
+  }
+}
+
+GlyphGallery::GlyphGallery(QWidget* parent, QString title)
+  : QDialog(parent) {
+  setWindowTitle(title.isEmpty() ? tr("Glyph gallery")
+                 : tr("Glyph gallery of %1").arg(title));
+  m_model = new GlyphGalleryModel(this);
+  m_view = new QListView(this);
+  m_view->setViewMode(QListView::IconMode);
+  m_view->setResizeMode(QListView::Adjust);
+  m_view->setMovement(QListView::Static);
+  // the same size of all cells: view lays out only visible part
+  m_view->setUniformItemSizes(true);
+  m_view->setLayoutMode(QListView::Batched);
+  m_view->setIconSize(QSize(GlyphGalleryModel::kThumbnailSize,
+                            GlyphGalleryModel::kThumbnailSize));
+  m_view->setGridSize(QSize(GlyphGalleryModel::kThumbnailSize + 16,
+                            GlyphGalleryModel::kThumbnailSize + 24));
+  m_view->setModel(m_model);
+  connect(m_view, SIGNAL(clicked(QModelIndex)), this,
+          SLOT(glyphClicked(QModelIndex)));
+  connect(m_view->verticalScrollBar(), SIGNAL(valueChanged(int)), this,
+          SLOT(scrolled()));
+
+  QDialogButtonBox* buttonBox = new QDialogButtonBox(QDialogButtonBox::Close,
+                                                     Qt::Horizontal, this);
+  QPushButton* refreshButton = buttonBox->addButton(
+    tr("&Refresh"), QDialogButtonBox::ActionRole);
+  connect(refreshButton, SIGNAL(clicked()), this, SIGNAL(refreshRequested()));
+  connect(buttonBox, SIGNAL(rejected()), this, SLOT(close()));
+
+  QVBoxLayout* layout = new QVBoxLayout(this);
+  layout->addWidget(m_view);
+  layout->addWidget(buttonBox);
+
+  QSettings settings(QSettings::IniFormat, QSettings::UserScope,
+                     SETTING_ORGANIZATION, SETTING_APPLICATION);
+  resize(settings.value("Gallery/Size", QSize(640, 480)).toSize());
+  move(settings.value("Gallery/Pos", QPoint(200, 200)).toPoint());
+}
+
+void GlyphGallery::setPages(const QString& imageFile,
+                            const BoxPages& pages) {
+  m_model->setPages(imageFile, pages);
+}
+
+void GlyphGallery::glyphClicked(const QModelIndex& index) {
+  emit boxActivated(index.data(GlyphGalleryModel::PageRole).toInt(),
+                    index.data(GlyphGalleryModel::RowRole).toInt());
+}
+
+/*
+ * Cells scrolled away do not need their thumbnails; visible cells request
+ * them again when they are painted.
+ */
+void GlyphGallery::scrolled() {
+  m_model->cancelPending();
+}
+
+void GlyphGallery::closeEvent(QCloseEvent* event) {
+  m_model->cancelPending();
+  QSettings settings(QSettings::IniFormat, QSettings::UserScope,
+                     SETTING_ORGANIZATION, SETTING_APPLICATION);
+  settings.setValue("Gallery/Pos", pos());
+  settings.setValue("Gallery/Size", size());
+  event->accept();
+}
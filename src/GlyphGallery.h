@@ -0,0 +1,122 @@
+/**********************************************************************
+* File:        GlyphGallery.h
+* Description: Gallery of box crops grouped by symbol
+* Author:      Zdenko Podobny
+* Created:     2026-10-19
+*
+* (C) Copyright 2026, Zdenko Podobny
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**    http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*
+**********************************************************************/
+
+
+#ifndef SRC_GLYPHGALLERY_H_
+#define SRC_GLYPHGALLERY_H_
+
+#include <QAbstractListModel>
+#include <QCache>
+#include <QDialog>
+#include <QImage>
+#include <QListView>
+#include <QRect>
+#include <QSet>
+#include <QThreadPool>
+
+#include "BoxFile.h"
+
+// Crop of page (box coordinates)
+struct GlyphKey {
+    int m_page;
+    QRect m_box;
+};
+inline bool operator==(const GlyphKey& a, const GlyphKey& b) {
+    return a.m_page == b.m_page && a.m_box == b.m_box;
+}
+inline uint qHash(const GlyphKey& key) {
+    return qHash(key.m_page) ^ qHash(key.m_box.left() << 16 ^
+                                     key.m_box.top()) ^
+           qHash(key.m_box.right() << 16 ^ key.m_box.bottom());
+}
+
+/*
+ * Boxes of all pages sorted by symbol. Thumbnail is requested only when view
+ * asks for decoration of cell (visible cells), it is cut from page in
+ * ImageCache by worker and kept in LRU cache (GUI/ThumbnailCacheSize in MB).
+ */
+class GlyphGalleryModel : public QAbstractListModel {
+    Q_OBJECT
+
+  public:
+    enum galleryRole {
+        PageRole = Qt::UserRole,
+        RowRole
+    };
+    static const int kThumbnailSize = 48;
+
+    explicit GlyphGalleryModel(QObject* parent = 0);
+    ~GlyphGalleryModel();
+
+    void setPages(const QString& imageFile, const BoxPages& pages);
+    // Forget requests which were not started (cells are not visible)
+    void cancelPending();
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const;
+    QVariant data(const QModelIndex& index, int role) const;
+
+  private slots:
+    void thumbnailReady(int page, const QRect& box, const QImage& thumbnail);
+
+  private:
+    struct Glyph {
+        QString m_symbol;
+        int m_page;
+        int m_row;
+        QRect m_box;
+    };
+    void request(const GlyphKey& key) const;
+
+    QString m_imageFile;
+    QVector<Glyph> m_glyphs;
+    QHash<GlyphKey, QVector<int> > m_rowsOfKey;  // cells waiting for crop
+    mutable QCache<GlyphKey, QImage> m_thumbnails;
+    mutable QSet<GlyphKey> m_pending;
+    mutable QThreadPool m_pool;
+    QImage m_placeholder;
+};
+
+class GlyphGallery : public QDialog {
+    Q_OBJECT
+
+  public:
+    explicit GlyphGallery(QWidget* parent = 0, QString title = "");
+
+    void setPages(const QString& imageFile, const BoxPages& pages);
+
+  signals:
+    void boxActivated(int page, int row);
+    void refreshRequested();
+
+  protected:
+    void closeEvent(QCloseEvent* event);
+
+  private slots:
+    void glyphClicked(const QModelIndex& index);
+    void scrolled();
+
+  private:
+    QListView* m_view;
+    GlyphGalleryModel* m_model;
+};
+
+#endif  // SRC_GLYPHGALLERY_H_
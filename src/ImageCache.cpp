@@ -0,0 +1,203 @@
+/**********************************************************************
+* File:        ImageCache.cpp
+* Description: Process-wide cache of decoded page images
+* Author:      Zdenko Podobny
+* Created:     2026-10-19
+*
+* (C) Copyright 2026, Zdenko Podobny
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**    http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*
+**********************************************************************/
+
+
+#include <leptonica/allheaders.h>
+
+#include <QDateTime>
+#include <QFileInfo>
+#include <QList>
+#include <QMutex>
+#include <QMutexLocker>
+
+#include "ImageCache.h"
+#include "PerfCounters.h"
+#include "TessTools.h"
+#include "TiffIndex.h"
+#include "Trace.h"
+
+// Default limit (can be changed in settings)
+static const qint64 kDefaultCacheLimit = 256 * 1024 * 1024;
+
+struct ImageCacheEntry {
+    QString path;
+    int page;
+    qint64 mtime;
+    QImage image;
+    qint64 bytes;
+};
+
+static QMutex s_mutex;
+static QList<ImageCacheEntry> s_entries;  // the most recently used first
+static qint64 s_bytes = 0;
+static qint64 s_limit = kDefaultCacheLimit;
+
+static QImage decodeImage(const QString& fileName, int page) {
+  TRACE_SPAN(tcIO);
+  QImage image;
+  QSharedPointer<const TiffIndex> tiff = TiffIndex::open(fileName);
+  if (tiff) {
+    PIX* pix = tiff->readPage(page);
+    if (pix) {
+      image = TessTools::PIX2qImage(pix);
+      pixDestroy(&pix);
+    }
+  } else if (page == 0) {
+    //  pixReadStream/PIX2qImage was not able to display png image
+    //  So lets use QImage for other format than tiff...
+    image.load(fileName);
+  }
+  return image;
+}
+
+static QImage decodeThumbnail(const QString& fileName, int page, int size) {
+  TRACE_SPAN(tcIO);
+  QImage image;
+  QSharedPointer<const TiffIndex> tiff = TiffIndex::open(fileName);
+  if (!tiff) {
+    if (page == 0 && image.load(fileName))
+      image = image.scaled(size, size, Qt::KeepAspectRatio,
+                           Qt::SmoothTransformation);
+    return image;
+  }
+  PIX* pix = tiff->readPage(page);
+  if (!pix)
+    return image;
+  l_float32 factor = static_cast<l_float32>(size) /
+                     qMax(pixGetWidth(pix), pixGetHeight(pix));
+  PIX* reduced = 0;
+  if (factor < 1) {
+    // binary page is reduced to gray, so thin strokes do not disappear
+    reduced = pixGetDepth(pix) == 1 ? pixScaleToGray(pix, factor)
+                                    : pixScale(pix, factor, factor);
+  }
+  image = TessTools::PIX2qImage(reduced ? reduced : pix);
+  pixDestroy(&pix);
+  if (reduced)
+    pixDestroy(&reduced);
+  return image;
+}
+
+// Must be called with locked mutex
+static void trimCache() {
+  for (int i = s_entries.size() - 1; i >= 0 && s_bytes > s_limit; --i) {
+    // image used by somebody else would stay in memory anyway
+    if (!s_entries.at(i).image.isDetached())
+      continue;
+    s_bytes -= s_entries.at(i).bytes;
+    s_entries.removeAt(i);
+  }
+}
+
+// Must be called with locked mutex
+static int findEntry(const QString& path, int page) {
+  for (int i = 0; i < s_entries.size(); ++i) {
+    if (s_entries.at(i).path == path && s_entries.at(i).page == page)
+      return i;
+  }
+  return -1;
+}
+
+QImage ImageCache::image(const QString& fileName, int page) {
+  QFileInfo info(fileName);
+  QString path = info.canonicalFilePath();
+  if (path.isEmpty())
+    return QImage();
+  qint64 mtime = info.lastModified().toMSecsSinceEpoch();
+
+  {
+    QMutexLocker locker(&s_mutex);
+    int i = findEntry(path, page);
+    if (i >= 0 && s_entries.at(i).mtime == mtime) {
+      PerfCounters::add(pcCacheHits, 1);
+      s_entries.move(i, 0);
+      return s_entries.first().image;
+    }
+    if (i >= 0) {  // file was changed
+      s_bytes -= s_entries.at(i).bytes;
+      s_entries.removeAt(i);
+    }
+  }
+
+  // decode without lock, other pages can be used meanwhile
+  PerfCounters::add(pcCacheMisses, 1);
+  QImage image = decodeImage(fileName, page);
+  if (image.isNull())
+    return image;
+
+  QMutexLocker locker(&s_mutex);
+  int i = findEntry(path, page);
+  if (i >= 0 && s_entries.at(i).mtime == mtime)  // decoded by other thread
+    return s_entries.at(i).image;
+  ImageCacheEntry entry;
+  entry.path = path;
+  entry.page = page;
+  entry.mtime = mtime;
+  entry.image = image;
+  entry.bytes = qint64(image.bytesPerLine()) * image.height();
+  s_entries.prepend(entry);
+  s_bytes += entry.bytes;
+  trimCache();
+  return image;
+}
+
+QImage ImageCache::thumbnail(const QString& fileName, int page, int size) {
+  QFileInfo info(fileName);
+  QString path = info.canonicalFilePath();
+  if (path.isEmpty())
+    return QImage();
+  qint64 mtime = info.lastModified().toMSecsSinceEpoch();
+
+  QImage image;
+  {
+    QMutexLocker locker(&s_mutex);
+    int i = findEntry(path, page);
+    if (i >= 0 && s_entries.at(i).mtime == mtime)
+      image = s_entries.at(i).image;
+  }
+  if (image.isNull())
+    return decodeThumbnail(fileName, page, size);
+  return image.scaled(size, size, Qt::KeepAspectRatio,
+                      Qt::SmoothTransformation);
+}
+
+void ImageCache::setLimit(qint64 bytes) {
+  QMutexLocker locker(&s_mutex);
+  s_limit = bytes;
+  trimCache();
+}
+
+qint64 ImageCache::limit() {
+  QMutexLocker locker(&s_mutex);
+  return s_limit;
+}
+
+qint64 ImageCache::size() {
+  QMutexLocker locker(&s_mutex);
+  return s_bytes;
+}
+
+void ImageCache::clear() {
+  QMutexLocker locker(&s_mutex);
+  s_entries.clear();
+  s_bytes = 0;
+}
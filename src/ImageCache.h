@@ -0,0 +1,53 @@
+/**********************************************************************
+* File:        ImageCache.h
+* Description: Process-wide cache of decoded page images
+* Author:      Zdenko Podobny
+* Created:     2026-10-19
+*
+* (C) Copyright 2026, Zdenko Podobny
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**    http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*
+**********************************************************************/
+
+
+#ifndef SRC_IMAGECACHE_H_
+#define SRC_IMAGECACHE_H_
+
+#include <QImage>
+#include <QString>
+
+/*
+ * Decoded pages of image files shared by all tabs, OCR, thresholding and
+ * exports, so every page is decoded only once. Pages are identified by
+ * canonical path, page number and modification time (changed file is decoded
+ * again). QImage is implicitly shared: the least recently used pages are
+ * dropped over limit, but only when nobody else holds them.
+ */
+class ImageCache {
+  public:
+    // Empty image is returned if file can not be decoded
+    static QImage image(const QString& fileName, int page = 0);
+    /** Page reduced to fit size x size. Cached page is scaled, otherwise
+     *  page is decoded and reduced by leptonica and it is not cached.
+     */
+    static QImage thumbnail(const QString& fileName, int page, int size);
+
+    static void setLimit(qint64 bytes);
+    static qint64 limit();
+    // Memory used by cached images
+    static qint64 size();
+    static void clear();
+};
+
+#endif  // SRC_IMAGECACHE_H_
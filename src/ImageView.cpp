@@ -0,0 +1,100 @@
+/**********************************************************************
+* File:        ImageView.cpp
+* Description: Graphics view of page image with performance overlay
+* Author:      Zdenko Podobny
+* Created:     2026-10-19
+*
+* (C) Copyright 2026, Zdenko Podobny
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**    http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*
+**********************************************************************/
+
+
+#include <QElapsedTimer>
+#include <QGraphicsRectItem>
+#include <QPainter>
+
+#include "ImageView.h"
+
+ImageView::ImageView(QGraphicsScene* scene, QWidget* parent)
+  : QGraphicsView(scene, parent) {
+  m_hudVisible = false;
+  m_frameTime = 0;
+  m_updateMode = viewportUpdateMode();
+}
+
+/*
+ * Overlay is painted in viewport coordinates, so scrolled viewport content
+ * can not be reused while it is shown.
+ */
+void ImageView::setHudVisible(bool visible) {
+  if (visible == m_hudVisible)
+    return;
+  m_hudVisible = visible;
+  if (visible) {
+    m_updateMode = viewportUpdateMode();
+    setViewportUpdateMode(QGraphicsView::FullViewportUpdate);
+  } else {
+    setViewportUpdateMode(m_updateMode);
+    m_hudLines.clear();
+  }
+  viewport()->update();
+}
+
+void ImageView::setHudText(const QStringList& lines) {
+  m_hudLines = lines;
+  if (m_hudVisible)
+    viewport()->update();
+}
+
+int ImageView::visibleBoxes() const {
+  QList<QGraphicsItem*> visibleItems = items(viewport()->rect());
+  int boxes = 0;
+  for (int i = 0; i < visibleItems.size(); ++i) {
+    if (visibleItems.at(i)->type() == QGraphicsRectItem::Type &&
+        visibleItems.at(i)->isVisible())
+      boxes++;
+  }
+  return boxes;
+}
+
+void ImageView::paintEvent(QPaintEvent* event) {
+  if (!m_hudVisible) {
+    QGraphicsView::paintEvent(event);
+    return;
+  }
+  QElapsedTimer timer;
+  timer.start();
+  QGraphicsView::paintEvent(event);
+  m_frameTime = timer.nsecsElapsed();
+}
+
+void ImageView::drawForeground(QPainter* painter, const QRectF& rect) {
+  QGraphicsView::drawForeground(painter, rect);
+  if (!m_hudVisible || m_hudLines.isEmpty())
+    return;
+
+  painter->save();
+  painter->resetTransform();
+  QFont font("Monospace");
+  font.setStyleHint(QFont::TypeWriter);
+  painter->setFont(font);
+  QString text = m_hudLines.join("\n");
+  QRect textRect = painter->boundingRect(QRect(10, 10, 0, 0),
+                                         Qt::AlignLeft | Qt::AlignTop, text);
+  painter->fillRect(textRect.adjusted(-5, -5, 5, 5), QColor(0, 0, 0, 160));
+  painter->setPen(Qt::white);
+  painter->drawText(textRect, Qt::AlignLeft | Qt::AlignTop, text);
+  painter->restore();
+}
@@ -0,0 +1,63 @@
+/**********************************************************************
+* File:        ImageView.h
+* Description: Graphics view of page image with performance overlay
+* Author:      Zdenko Podobny
+* Created:     2026-10-19
+*
+* (C) Copyright 2026, Zdenko Podobny
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**    http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*
+**********************************************************************/
+
+
+#ifndef SRC_IMAGEVIEW_H_
+#define SRC_IMAGEVIEW_H_
+
+#include <QGraphicsView>
+#include <QStringList>
+
+/*
+ * View of page image. It can show overlay (HUD) with performance data in
+ * top left corner. Paint time is measured only when overlay is visible.
+ */
+class ImageView : public QGraphicsView {
+    Q_OBJECT
+
+  public:
+    explicit ImageView(QGraphicsScene* scene, QWidget* parent = 0);
+
+    bool isHudVisible() const {
+        return m_hudVisible;
+    }
+    void setHudVisible(bool visible);
+    void setHudText(const QStringList& lines);
+    // Duration of last paint of viewport (ns)
+    qint64 frameTime() const {
+        return m_frameTime;
+    }
+    // Number of shown rectangles in visible part of scene
+    int visibleBoxes() const;
+
+  protected:
+    void paintEvent(QPaintEvent* event);
+    void drawForeground(QPainter* painter, const QRectF& rect);
+
+  private:
+    bool m_hudVisible;
+    QStringList m_hudLines;
+    qint64 m_frameTime;
+    ViewportUpdateMode m_updateMode;
+};
+
+#endif  // SRC_IMAGEVIEW_H_
@@ -0,0 +1,132 @@
+/**********************************************************************
+* File:        InkMap.cpp
+* Description: Binarized page for fitting boxes to ink
+* Author:      Zdenko Podobny
+* Created:     2026-10-19
+*
+* (C) Copyright 2026, Zdenko Podobny
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**    http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*
+**********************************************************************/
+
+
+#include <string.h>
+
+#include "InkMap.h"
+#include "Trace.h"
+
+InkMap::InkMap() {
+  m_width = 0;
+  m_height = 0;
+}
+
+InkMap::InkMap(const QImage& image) {
+  TRACE_SPAN(tcRender);
+  m_width = image.width();
+  m_height = image.height();
+  if (image.isNull())
+    return;
+
+  QImage gray = image.convertToFormat(QImage::Format_Grayscale8);
+  int threshold = otsuThreshold(gray);
+  m_ink.resize(m_width * m_height);
+  uchar* ink = reinterpret_cast<uchar*>(m_ink.data());
+  for (int y = 0; y < m_height; ++y) {
+    const uchar* line = gray.constScanLine(y);
+    uchar* inkLine = ink + y * m_width;
+    for (int x = 0; x < m_width; ++x)
+      inkLine[x] = line[x] <= threshold;
+  }
+}
+
+int InkMap::otsuThreshold(const QImage& gray) {
+  qint64 histogram[256];
+  memset(histogram, 0, sizeof(histogram));
+  for (int y = 0; y < gray.height(); ++y) {
+    const uchar* line = gray.constScanLine(y);
+    for (int x = 0; x < gray.width(); ++x)
+      ++histogram[line[x]];
+  }
+
+  qint64 total = qint64(gray.width()) * gray.height();
+  double sum = 0;
+  for (int i = 0; i < 256; ++i)
+    sum += double(i) * histogram[i];
+
+  double sumDark = 0;
+  qint64 weightDark = 0;
+  double bestVariance = -1;
+  int threshold = 127;
+  for (int i = 0; i < 256; ++i) {
+    weightDark += histogram[i];
+    if (weightDark == 0)
+      continue;
+    qint64 weightLight = total - weightDark;
+    if (weightLight == 0)
+      break;
+    sumDark += double(i) * histogram[i];
+    double meanDark = sumDark / weightDark;
+    double meanLight = (sum - sumDark) / weightLight;
+    double diff = meanDark - meanLight;
+    double variance = double(weightDark) * weightLight * diff * diff;
+    if (variance > bestVariance) {
+      bestVariance = variance;
+      threshold = i;
+    }
+  }
+  return threshold;
+}
+
+/*
+ * Rows are checked from top and bottom, columns only inside found rows and
+ * only out of already found ink, so cost is at most area of rectangle.
+ * Found rows contain ink, so edge column is the result if nothing is found
+ * before it.
+ */
+QRect InkMap::inkBounds(const QRect& area) const {
+  QRect searched = area & QRect(0, 0, m_width, m_height);
+  if (searched.isEmpty() || isNull())
+    return QRect();
+
+  const int left = searched.left();
+  const int width = searched.width();
+  int top = searched.top();
+  while (top <= searched.bottom() &&
+         !memchr(scanLine(top) + left, 1, width))
+    ++top;
+  if (top > searched.bottom())
+    return QRect();
+  int bottom = searched.bottom();
+  while (!memchr(scanLine(bottom) + left, 1, width))
+    --bottom;
+
+  int inkLeft = searched.right();
+  int inkRight = left;
+  for (int y = top; y <= bottom; ++y) {
+    const uchar* line = scanLine(y);
+    for (int x = left; x < inkLeft; ++x) {
+      if (line[x]) {
+        inkLeft = x;
+        break;
+      }
+    }
+    for (int x = searched.right(); x > inkRight; --x) {
+      if (line[x]) {
+        inkRight = x;
+        break;
+      }
+    }
+  }
+  return QRect(QPoint(inkLeft, top), QPoint(inkRight, bottom));
+}
@@ -0,0 +1,69 @@
+/**********************************************************************
+* File:        InkMap.h
+* Description: Binarized page for fitting boxes to ink
+* Author:      Zdenko Podobny
+* Created:     2026-10-19
+*
+* (C) Copyright 2026, Zdenko Podobny
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**    http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*
+**********************************************************************/
+
+
+#ifndef SRC_INKMAP_H_
+#define SRC_INKMAP_H_
+
+#include <QByteArray>
+#include <QImage>
+#include <QRect>
+
+/*
+ * Page binarized by global (Otsu) threshold, one byte per pixel (1 = ink).
+ * It is built once per page image and then only read, so it can be used by
+ * several threads.
+ */
+class InkMap {
+  public:
+    InkMap();
+    explicit InkMap(const QImage& image);
+
+    bool isNull() const {
+        return m_ink.isEmpty();
+    }
+    int width() const {
+        return m_width;
+    }
+    int height() const {
+        return m_height;
+    }
+    const uchar* scanLine(int y) const {
+        return reinterpret_cast<const uchar*>(m_ink.constData()) +
+               y * m_width;
+    }
+    bool isInk(int x, int y) const {
+        return scanLine(y)[x] != 0;
+    }
+    // Tight bounding box of ink in area (null rectangle if there is none)
+    QRect inkBounds(const QRect& area) const;
+
+    // Threshold of gray levels; darker pixels are ink
+    static int otsuThreshold(const QImage& gray);
+
+  private:
+    int m_width;
+    int m_height;
+    QByteArray m_ink;
+};
+
+#endif  // SRC_INKMAP_H_
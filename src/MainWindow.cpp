@@ -22,7 +22,12 @@
 *
 **********************************************************************/
 
+#include <algorithm>
+
 #include "MainWindow.h"
+#include "DocumentLoader.h"
+#include "ImageCache.h"
+#include "Trace.h"
 #include "dialogs/ShortCutsDialog.h"
 #include <tesseract/baseapi.h>
 
@@ -36,6 +41,9 @@ MainWindow::MainWindow() {
 
   connect(tabWidget, SIGNAL(tabCloseRequested(int)), this,
           SLOT(handleClose(int)));
+  // must be the first: other slots need resumed tab
+  connect(tabWidget, SIGNAL(currentChanged(int)), this,
+          SLOT(tabActivated(int)));
   connect(tabWidget, SIGNAL(currentChanged(int)), this,
           SLOT(updateMenus()));
   connect(tabWidget, SIGNAL(currentChanged(int)), this,
@@ -50,6 +58,15 @@ MainWindow::MainWindow() {
           SLOT(setCurrentIndex(int)));
 
   shortCutsDialog = 0;
+  m_memoryBudget = 1024 * 1024 * 1024;
+  m_activationCounter = 0;
+  m_restoringSession = false;
+  m_closingTabs = false;
+  m_loader = new DocumentLoader(this);
+  connect(m_loader, SIGNAL(progress(int, int)), this,
+          SLOT(documentProgress(int, int)));
+  connect(m_loader, SIGNAL(loaded(LoadedDocument)), this,
+          SLOT(documentLoaded(LoadedDocument)));
   setAcceptDrops(true);
   tabWidget->setAcceptDrops(true);
   createActions();
@@ -66,6 +83,7 @@ MainWindow::MainWindow() {
 }
 
 void MainWindow::closeEvent(QCloseEvent* event) {
+  writeSession();
   if (closeAllTabs()) {
     writeSettings();
     event->accept();
@@ -74,9 +92,13 @@ void MainWindow::closeEvent(QCloseEvent* event) {
   }
 }
 
+// Tab which is still loading is not active for commands
 ChildWidget* MainWindow::activeChild() {
-  if (QWidget* currentWidget = tabWidget->currentWidget())
-    return qobject_cast<ChildWidget*> (currentWidget);
+  if (QWidget* currentWidget = tabWidget->currentWidget()) {
+    ChildWidget* child = qobject_cast<ChildWidget*> (currentWidget);
+    if (child && !child->isLoading())
+      return child;
+  }
   return 0;
 }
 
@@ -109,43 +131,153 @@ void MainWindow::addChild(const QString& imageFileName) {
       }
     }
 
+    // document is read by worker, tab shows progress until it is attached
     ChildWidget* child = new ChildWidget(this);
-    if (child->loadImage(imageFileName)) {
-      statusBar()->showMessage(tr("File loaded"), 2000);
-      tabWidget->setCurrentIndex(tabWidget->addTab(child,
-                                 child->userFriendlyCurrentFile()));
-      tabWidget->setTabToolTip(tabWidget->currentIndex(), imageFileName);
-      connect(child, SIGNAL(boxChanged()), this, SLOT(updateCommandActions()));
-      connect(child, SIGNAL(modifiedChanged()), this, SLOT(updateTabTitle()));
-      connect(child, SIGNAL(modifiedChanged()), this, SLOT(updateSaveAction()));
-      connect(child, SIGNAL(zoomRatioChanged(qreal)), this,
-              SLOT(zoomRatioChanged(qreal)));
-      connect(child, SIGNAL(statusBarMessage(QString)), this,
-              SLOT(statusBarMessage(QString)));
-      connect(child, SIGNAL(drawRectangleChoosen()), this, SLOT(updateCommandActions()));
-      child->setZoomStatus();
-      // save path of open image file
-      QSettings settings(QSettings::IniFormat, QSettings::UserScope,
-                         SETTING_ORGANIZATION, SETTING_APPLICATION);
-      QString filePath = QFileInfo(imageFileName).absolutePath();
-      settings.setValue("last_path", filePath);
-
-      QStringList files = settings.value("recentFileList").toStringList();
-      files.removeAll(imageFileName);
-      files.prepend(imageFileName);
-      while (files.size() > MaxRecentFiles)
-        files.removeLast();
-
-      settings.setValue("recentFileList", files);
-
-      foreach(QWidget * widget, QApplication::topLevelWidgets()) {
-        MainWindow* mainWin = qobject_cast<MainWindow*>(widget);
-        if (mainWin)
-          mainWin->updateRecentFileActions();
-      }
-    } else {
-      child->close();
+    child->startLoading(imageFileName, m_loader->start(imageFileName));
+    int index = tabWidget->addTab(child, child->userFriendlyCurrentFile());
+    tabWidget->setTabToolTip(index, imageFileName);
+    connectChild(child);
+    tabWidget->setCurrentIndex(index);
+  }
+}
+
+void MainWindow::documentProgress(int id, int step) {
+  int index = loadingTab(id);
+  if (index >= 0)
+    qobject_cast<ChildWidget*> (tabWidget->widget(index))
+      ->setLoadProgress(step);
+}
+
+void MainWindow::documentLoaded(const LoadedDocument& document) {
+  int index = loadingTab(document.m_id);
+  if (index < 0)
+    return;  // tab was closed while loading
+  ChildWidget* child = qobject_cast<ChildWidget*> (tabWidget->widget(index));
+  bool pending = child->isPending();
+  bool loaded = pending ? child->loadPending(document)
+                        : child->attachDocument(document);
+  if (!loaded) {
+    tabWidget->removeTab(index);
+    child->deleteLater();
+    updateMenus();
+    return;
+  }
+  child->setZoomStatus();
+  if (!pending) {
+    statusBar()->showMessage(tr("File loaded"), 2000);
+    addRecentFile(document.m_imageFile);
+  }
+  if (child == tabWidget->currentWidget()) {
+    updateMenus();
+    updateCommandActions();
+    updateSaveAction();
+  }
+  applyMemoryBudget();
+}
+
+int MainWindow::loadingTab(int id) {
+  for (int i = 0; i < tabWidget->count(); ++i) {
+    ChildWidget* child = qobject_cast<ChildWidget*> (tabWidget->widget(i));
+    if (child->isLoading() && child->loadId() == id)
+      return i;
+  }
+  return -1;
+}
+
+void MainWindow::addRecentFile(const QString& imageFileName) {
+  // save path of open image file
+  QSettings settings(QSettings::IniFormat, QSettings::UserScope,
+                     SETTING_ORGANIZATION, SETTING_APPLICATION);
+  QString filePath = QFileInfo(imageFileName).absolutePath();
+  settings.setValue("last_path", filePath);
+
+  QStringList files = settings.value("recentFileList").toStringList();
+  files.removeAll(imageFileName);
+  files.prepend(imageFileName);
+  while (files.size() > MaxRecentFiles)
+    files.removeLast();
+
+  settings.setValue("recentFileList", files);
+
+  foreach(QWidget * widget, QApplication::topLevelWidgets()) {
+    MainWindow* mainWin = qobject_cast<MainWindow*>(widget);
+    if (mainWin)
+      mainWin->updateRecentFileActions();
+  }
+}
+
+void MainWindow::connectChild(ChildWidget* child) {
+  connect(child, SIGNAL(boxChanged()), this, SLOT(updateCommandActions()));
+  connect(child, SIGNAL(modifiedChanged()), this, SLOT(updateTabTitle()));
+  connect(child, SIGNAL(modifiedChanged()), this, SLOT(updateSaveAction()));
+  connect(child, SIGNAL(zoomRatioChanged(qreal)), this,
+          SLOT(zoomRatioChanged(qreal)));
+  connect(child, SIGNAL(statusBarMessage(QString)), this,
+          SLOT(statusBarMessage(QString)));
+  connect(child, SIGNAL(drawRectangleChoosen()), this, SLOT(updateCommandActions()));
+}
+
+/*
+ * Session file keeps open documents with their page, current symbol and view.
+ * It is separate from settings, so it can be deleted without loosing them.
+ */
+void MainWindow::writeSession() {
+  QSettings session(QSettings::IniFormat, QSettings::UserScope,
+                    SETTING_ORGANIZATION, "session");
+  session.clear();
+  session.beginWriteArray("documents");
+  for (int i = 0; i < tabWidget->count(); ++i) {
+    ChildWidget* child = qobject_cast<ChildWidget*> (tabWidget->widget(i));
+    QVariantMap state = child->sessionState();
+    session.setArrayIndex(i);
+    for (QVariantMap::const_iterator it = state.constBegin();
+         it != state.constEnd(); ++it)
+      session.setValue(it.key(), it.value());
+  }
+  session.endArray();
+  session.setValue("current", tabWidget->currentIndex());
+}
+
+void MainWindow::restoreSession() {
+  QSettings settings(QSettings::IniFormat, QSettings::UserScope,
+                     SETTING_ORGANIZATION, SETTING_APPLICATION);
+  if (settings.contains("GUI/RestoreSession") &&
+      !settings.value("GUI/RestoreSession").toBool())
+    return;
+
+  QSettings session(QSettings::IniFormat, QSettings::UserScope,
+                    SETTING_ORGANIZATION, "session");
+  int current = session.value("current").toInt();
+  m_restoringSession = true;
+  int size = session.beginReadArray("documents");
+  for (int i = 0; i < size; ++i) {
+    session.setArrayIndex(i);
+    QString imageFileName = session.value("image").toString();
+    if (!QFile::exists(imageFileName)) {
+      if (i < current)
+        --current;
+      continue;
     }
+    QVariantMap state;
+    QStringList keys = session.childKeys();
+    for (int k = 0; k < keys.size(); ++k)
+      state.insert(keys.at(k), session.value(keys.at(k)));
+
+    ChildWidget* child = new ChildWidget(this);
+    child->setPendingState(state);
+    int index = tabWidget->addTab(child, child->userFriendlyCurrentFile());
+    tabWidget->setTabToolTip(index, imageFileName);
+    connectChild(child);
+  }
+  session.endArray();
+  m_restoringSession = false;
+
+  if (tabWidget->count() > 0) {
+    current = qBound(0, current, tabWidget->count() - 1);
+    if (tabWidget->currentIndex() != current)
+      tabWidget->setCurrentIndex(current);
+    else
+      tabActivated(current);
   }
 }
 
@@ -318,10 +450,16 @@ bool MainWindow::closeActiveTab() {
 }
 
 bool MainWindow::closeAllTabs() {
+  // do not load restored or resume suspended tabs just to close them
+  m_closingTabs = true;
   while (tabWidget->currentWidget()) {
-    if (!closeActiveTab())
+    if (!closeActiveTab()) {
+      m_closingTabs = false;
+      tabActivated(tabWidget->currentIndex());  // tab stays open
       return false;
+    }
   }
+  m_closingTabs = false;
   return true;
 }
 
@@ -429,6 +567,12 @@ void MainWindow::drawBoxes() {
   }
 }
 
+void MainWindow::perfHud(bool checked) {
+  if (activeChild()) {
+    activeChild()->setPerfHudVisible(checked);
+  }
+}
+
 void MainWindow::insertSymbol() {
   if (activeChild()) {
     activeChild()->insertSymbol();
@@ -471,6 +615,18 @@ void MainWindow::moveTo() {
   }
 }
 
+void MainWindow::sortByReadingOrder() {
+  if (activeChild()) {
+    activeChild()->sortByReadingOrder();
+  }
+}
+
+void MainWindow::fitToInk() {
+  if (activeChild()) {
+    activeChild()->fitToInk();
+  }
+}
+
 void MainWindow::goToRow() {
   if (activeChild()) {
     activeChild()->goToRow();
@@ -483,6 +639,30 @@ void MainWindow::find() {
   }
 }
 
+void MainWindow::showSymbolStats() {
+  if (activeChild()) {
+    activeChild()->showSymbolStats();
+  }
+}
+
+void MainWindow::showGlyphGallery() {
+  if (activeChild()) {
+    activeChild()->showGlyphGallery();
+  }
+}
+
+void MainWindow::findSimilarGlyphs() {
+  if (activeChild()) {
+    activeChild()->findSimilarGlyphs();
+  }
+}
+
+void MainWindow::checkBoxes() {
+  if (activeChild()) {
+    activeChild()->checkBoxes();
+  }
+}
+
 void MainWindow::drawRect(bool checked) {
   if (activeChild()) {
     activeChild()->drawRectangle(checked);
@@ -607,6 +787,31 @@ void MainWindow::shortCutList() {
   shortCutsDialog -> show();
 }
 
+void MainWindow::recordTrace(bool checked) {
+  if (checked)
+    Trace::clear();
+  Trace::setEnabled(checked);
+  statusBar()->showMessage(checked ? tr("Recording of trace started")
+                                   : tr("Recording of trace stopped"), 2000);
+}
+
+void MainWindow::saveTrace() {
+  QString fileName = QFileDialog::getSaveFileName(this,
+                     tr("Save performance trace..."),
+                     "qt-box-editor-trace.json",
+                     tr("Chrome trace files (*.json);;All files (*)"));
+  if (fileName.isEmpty())
+    return;
+
+  QString error;
+  if (!Trace::exportChromeTrace(fileName, &error)) {
+    QMessageBox::warning(this, SETTING_APPLICATION, error);
+    return;
+  }
+  statusBar()->showMessage(tr("Trace with %1 spans saved")
+                           .arg(Trace::count()), 2000);
+}
+
 void MainWindow::about() {
   QString abouttext =
     tr("<h1>%1 %3</h1>").arg(SETTING_APPLICATION).arg(APP_VERSION);
@@ -642,6 +847,54 @@ void MainWindow::handleClose(int i) {
   updateMenus();
 }
 
+/*
+ * Suspended tab is restored when it is shown. The active tab is never
+ * suspended. Tab from previous session is loaded when it is shown for
+ * the first time.
+ */
+void MainWindow::tabActivated(int index) {
+  ChildWidget* child = qobject_cast<ChildWidget*> (tabWidget->widget(index));
+  if (!child || m_restoringSession)
+    return;
+  if (m_closingTabs && (child->isPending() || child->isSuspended()))
+    return;
+  if (child->isPending()) {
+    if (child->isLoading())
+      return;
+    child->startLoading(child->canonicalImageFileName(),
+                        m_loader->start(child->canonicalImageFileName()));
+  } else if (child->isSuspended()) {
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+    child->resume();
+    QApplication::restoreOverrideCursor();
+  }
+  m_tabActivation.insert(child, ++m_activationCounter);
+  if (!m_closingTabs)
+    applyMemoryBudget();
+}
+
+// Suspend the least recently used inactive tabs until budget is met
+void MainWindow::applyMemoryBudget() {
+  QList<QPair<quint64, ChildWidget*> > inactive;
+  QHash<ChildWidget*, quint64> activation;
+  qint64 total = 0;
+  for (int i = 0; i < tabWidget->count(); ++i) {
+    ChildWidget* child = qobject_cast<ChildWidget*> (tabWidget->widget(i));
+    total += child->residentBytes();
+    activation.insert(child, m_tabActivation.value(child));
+    if (child != activeChild() && !child->isSuspended() &&
+        !child->isPending())
+      inactive.append(qMakePair(m_tabActivation.value(child), child));
+  }
+  m_tabActivation = activation;  // forget closed tabs
+
+  std::sort(inactive.begin(), inactive.end());
+  for (int i = 0; i < inactive.size() && total > m_memoryBudget; ++i) {
+    total -= inactive.at(i).second->residentBytes();
+    inactive.at(i).second->suspend();
+  }
+}
+
 void MainWindow::updateMenus() {
   saveAsAct->setEnabled((activeChild()) != 0);
   reLoadAct->setEnabled((activeChild()) != 0);
@@ -654,8 +907,8 @@ void MainWindow::updateMenus() {
   symbolPerLineAct->setEnabled((activeChild()) != 0);
   rowPerLineAct->setEnabled((activeChild()) != 0);
   paragraphPerLineAct->setEnabled((activeChild()) != 0);
-  closeAct->setEnabled(activeChild() != 0);
-  closeAllAct->setEnabled(activeChild() != 0);
+  closeAct->setEnabled(tabWidget->currentWidget() != 0);
+  closeAllAct->setEnabled(tabWidget->currentWidget() != 0);
   nextAct->setEnabled(tabWidget->count() > 1);
   previousAct->setEnabled(tabWidget->count() > 1);
   separatorAct->setVisible(activeChild() != 0);
@@ -669,10 +922,17 @@ void MainWindow::updateMenus() {
   showSymbolAct->setEnabled(activeChild() != 0);
   goToRowAct->setEnabled(activeChild() != 0);
   findAct->setEnabled(activeChild() != 0);
+  checkBoxesAct->setEnabled(activeChild() != 0);
+  symbolStatsAct->setEnabled(activeChild() != 0);
+  galleryAct->setEnabled(activeChild() != 0);
+  similarGlyphsAct->setEnabled(activeChild() != 0);
+  sortAct->setEnabled(activeChild() != 0);
+  fitToInkAct->setEnabled(activeChild() != 0);
   undoAct->setEnabled(activeChild() != 0);
   redoAct->setEnabled(activeChild() != 0);
   drawRectAct->setEnabled(activeChild() != 0);
   drawBoxesAct->setEnabled(activeChild() != 0);
+  perfHudAct->setEnabled(activeChild() != 0);
   DirectTypingAct->setEnabled(activeChild() != 0);
   showFontColumnsAct->setEnabled(activeChild() != 0);
 }
@@ -695,6 +955,8 @@ void MainWindow::updateCommandActions() {
                             ? activeChild()->isShowSymbol() : false);
   drawBoxesAct->setChecked((activeChild())
                            ? activeChild()->isDrawBoxes() : false);
+  perfHudAct->setChecked((activeChild())
+                         ? activeChild()->isPerfHudVisible() : false);
   drawRectAct->setChecked((activeChild())
                           ? activeChild()->isDrawRect() : false);
   DirectTypingAct->setChecked((activeChild())
@@ -765,6 +1027,10 @@ void MainWindow::updateViewMenu() {
   viewMenu->addAction(showSymbolAct);
   viewMenu->addAction(showFontColumnsAct);
   viewMenu->addAction(drawBoxesAct);
+  viewMenu->addSeparator();
+  viewMenu->addAction(symbolStatsAct);
+  viewMenu->addAction(galleryAct);
+  viewMenu->addAction(perfHudAct);
 }
 
 void MainWindow::createActions() {
@@ -963,6 +1229,12 @@ void MainWindow::createActions() {
   drawBoxesAct->setStatusTip(tr("Show/hide rectangles for all boxes"));
   connect(drawBoxesAct, SIGNAL(triggered()), this, SLOT(drawBoxes()));
 
+  perfHudAct = new QAction(tr("&Performance overlay"), this);
+  perfHudAct->setCheckable(true);
+  perfHudAct->setStatusTip(tr("Show frame time, memory and durations of " \
+                              "load/save in image view"));
+  connect(perfHudAct, SIGNAL(triggered(bool)), this, SLOT(perfHud(bool)));
+
   nextAct = new QAction(QIcon::fromTheme("next"), tr("Ne&xt"), this);
   nextAct->setShortcuts(QKeySequence::NextChild);
   nextAct->setToolTip(tr("Move the focus to the next window"));
@@ -1011,6 +1283,17 @@ void MainWindow::createActions() {
   moveToAct->setShortcut(Qt::CTRL | Qt::Key_M);
   connect(moveToAct, SIGNAL(triggered()), this, SLOT(moveTo()));
 
+  sortAct = new QAction(tr("&Sort by reading order"), this);
+  sortAct->setStatusTip(tr("Sort boxes of page by lines and columns " \
+                           "(right-to-left text is supported)."));
+  connect(sortAct, SIGNAL(triggered()), this, SLOT(sortByReadingOrder()));
+
+  fitToInkAct = new QAction(tr("&Fit boxes to ink"), this);
+  fitToInkAct->setShortcut(tr("Ctrl+Alt+F"));
+  fitToInkAct->setStatusTip(tr("Shrink selected boxes to the ink inside " \
+                               "them."));
+  connect(fitToInkAct, SIGNAL(triggered()), this, SLOT(fitToInk()));
+
   goToRowAct = new QAction(QIcon::fromTheme("jump"),
                            tr("&Go to row…"), this);
   goToRowAct->setShortcut(tr("Ctrl+G"));
@@ -1021,6 +1304,28 @@ void MainWindow::createActions() {
   findAct->setShortcut(tr("Ctrl+F"));
   connect(findAct, SIGNAL(triggered()), this, SLOT(find()));
 
+  checkBoxesAct = new QAction(tr("&Check boxes"), this);
+  checkBoxesAct->setShortcut(tr("Ctrl+Alt+C"));
+  checkBoxesAct->setStatusTip(tr("Find boxes outside of image, inverted " \
+                                 "coordinates and duplicate boxes."));
+  connect(checkBoxesAct, SIGNAL(triggered()), this, SLOT(checkBoxes()));
+
+  symbolStatsAct = new QAction(tr("Symbol &statistics…"), this);
+  symbolStatsAct->setStatusTip(tr("Count, sizes and styles of symbols of " \
+                                  "all pages; boxes with unusual size."));
+  connect(symbolStatsAct, SIGNAL(triggered()), this, SLOT(showSymbolStats()));
+
+  galleryAct = new QAction(tr("Glyph &gallery…"), this);
+  galleryAct->setStatusTip(tr("Crops of all boxes grouped by symbol."));
+  connect(galleryAct, SIGNAL(triggered()), this, SLOT(showGlyphGallery()));
+
+  similarGlyphsAct = new QAction(tr("Find similar glyphs with different " \
+                                    "&labels…"), this);
+  similarGlyphsAct->setStatusTip(tr("Cluster glyphs of all pages by shape " \
+                                    "and list clusters with more labels."));
+  connect(similarGlyphsAct, SIGNAL(triggered()), this,
+          SLOT(findSimilarGlyphs()));
+
   drawRectAct = new QAction(QIcon::fromTheme("rectangle"),
                             tr("Draw/Hide &Rectangle…"), this);
   drawRectAct->setCheckable(true);
@@ -1074,6 +1379,19 @@ void MainWindow::createActions() {
   shortCutListAct = new QAction(tr("&Shortcut List"), this);
   shortCutListAct -> setShortcut(tr("F1"));
   connect(shortCutListAct, SIGNAL(triggered()), this, SLOT(shortCutList()));
+
+  recordTraceAct = new QAction(tr("&Record performance trace"), this);
+  recordTraceAct->setCheckable(true);
+  recordTraceAct->setChecked(Trace::isEnabled());
+  recordTraceAct->setStatusTip(tr("Record duration of loading, rendering, " \
+                                  "editing and OCR"));
+  connect(recordTraceAct, SIGNAL(toggled(bool)), this,
+          SLOT(recordTrace(bool)));
+
+  saveTraceAct = new QAction(tr("Save performance &trace..."), this);
+  saveTraceAct->setStatusTip(tr("Save recorded trace for chrome://tracing " \
+                                "or Perfetto"));
+  connect(saveTraceAct, SIGNAL(triggered()), this, SLOT(saveTrace()));
 }
 
 void MainWindow::createMenus() {
@@ -1125,8 +1443,12 @@ void MainWindow::createMenus() {
   editMenu->addAction(moveUpAct);
   editMenu->addAction(moveDownAct);
   editMenu->addAction(moveToAct);
+  editMenu->addAction(sortAct);
+  editMenu->addAction(fitToInkAct);
   editMenu->addAction(goToRowAct);
   editMenu->addAction(findAct);
+  editMenu->addAction(checkBoxesAct);
+  editMenu->addAction(similarGlyphsAct);
   editMenu->addSeparator();
   editMenu->addAction(DirectTypingAct);
   editMenu->addAction(drawRectAct);
@@ -1147,6 +1469,8 @@ void MainWindow::createMenus() {
   helpMenu->addAction(checkForUpdateAct);
   helpMenu->addSeparator();
   helpMenu->addAction(shortCutListAct);
+  helpMenu->addAction(recordTraceAct);
+  helpMenu->addAction(saveTraceAct);
   helpMenu->addAction(aboutAct);
   helpMenu->addAction(aboutQtAct);
 }
@@ -1226,6 +1550,17 @@ void MainWindow::readSettings(bool init) {
   }
   if (settings.contains("Text/OpenDialog"))
     openSettings = settings.value("Text/OpenDialog").toBool();
+  // Memory budget for all tabs in MB
+  if (settings.contains("GUI/MemoryBudget")) {
+    m_memoryBudget =
+      settings.value("GUI/MemoryBudget").toLongLong() * 1024 * 1024;
+    applyMemoryBudget();
+  }
+  // Cache of decoded images in MB
+  if (settings.contains("GUI/ImageCacheSize")) {
+    ImageCache::setLimit(
+      settings.value("GUI/ImageCacheSize").toLongLong() * 1024 * 1024);
+  }
 }
 
 void MainWindow::writeSettings() {
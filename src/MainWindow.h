@@ -27,6 +27,7 @@
 
 #include <QEventLoop>
 #include <QDragEnterEvent>
+#include <QHash>
 #include <QList>
 #include <QSettings>
 #include <QSignalMapper>
@@ -54,6 +55,8 @@
 #include "SettingsDialog.h"
 
 class ChildWidget;
+class DocumentLoader;
+struct LoadedDocument;
 class QAction;
 class QMenu;
 class QTabWidget;
@@ -68,6 +71,8 @@ class MainWindow : public QMainWindow {
     MainWindow();
 
     void addChild(const QString& imageFileName);
+    // Reopen documents of previous session; tabs are loaded when shown
+    void restoreSession();
     SettingsDialog* runSettingsDialog;
 
   public slots:
@@ -81,6 +86,8 @@ class MainWindow : public QMainWindow {
 
   private slots:
     void open();
+    void documentProgress(int id, int step);
+    void documentLoaded(const LoadedDocument& document);
     void openRecentFile();
     void save();
     void splitToFeatureBF();
@@ -110,6 +117,7 @@ class MainWindow : public QMainWindow {
     void zoomOut();
     void showSymbol();
     void drawBoxes();
+    void perfHud(bool checked);
     void insertSymbol();
     void splitSymbol();
     void joinSymbol();
@@ -117,8 +125,14 @@ class MainWindow : public QMainWindow {
     void moveUp();
     void moveDown();
     void moveTo();
+    void sortByReadingOrder();
+    void fitToInk();
     void goToRow();
     void find();
+    void showSymbolStats();
+    void showGlyphGallery();
+    void findSimilarGlyphs();
+    void checkBoxes();
     void drawRect(bool checked);
     void undo();
     void redo();
@@ -126,9 +140,12 @@ class MainWindow : public QMainWindow {
     void slotSettings();
     void slotSettings(int tab);
     void shortCutList();
+    void recordTrace(bool checked);
+    void saveTrace();
     void about();
     void aboutQt();
     void handleClose(int i);
+    void tabActivated(int index);
     void updateMenus();
     void updateViewMenu();
     void updateCommandActions();
@@ -200,6 +217,7 @@ class MainWindow : public QMainWindow {
     QAction* zoomOutAct;
     QAction* showSymbolAct;
     QAction* drawBoxesAct;
+    QAction* perfHudAct;
     QAction* DirectTypingAct;
     QAction* showFontColumnsAct;
     QAction* nextAct;
@@ -212,9 +230,15 @@ class MainWindow : public QMainWindow {
     QAction* deleteAct;
     QAction* moveUpAct;
     QAction* moveToAct;
+    QAction* sortAct;
+    QAction* fitToInkAct;
     QAction* moveDownAct;
     QAction* goToRowAct;
     QAction* findAct;
+    QAction* checkBoxesAct;
+    QAction* symbolStatsAct;
+    QAction* galleryAct;
+    QAction* similarGlyphsAct;
     QAction* drawRectAct;
     QAction* undoAct;
     QAction* redoAct;
@@ -222,6 +246,8 @@ class MainWindow : public QMainWindow {
     QAction* getBinAct;
     QAction* checkForUpdateAct;
     QAction* shortCutListAct;
+    QAction* recordTraceAct;
+    QAction* saveTraceAct;
     QAction* aboutAct;
     QAction* aboutQtAct;
     QLabel* _utfCodeLabel;
@@ -229,6 +255,22 @@ class MainWindow : public QMainWindow {
     QLabel* _zoom;
 
     bool openSettings;
+
+    void connectChild(ChildWidget* child);
+    void addRecentFile(const QString& imageFileName);
+
+    // Opened documents are read in parallel by workers
+    DocumentLoader* m_loader;
+    int loadingTab(int id);
+    void writeSession();
+    bool m_restoringSession;
+    bool m_closingTabs;
+
+    // Memory of all tabs; inactive tabs are suspended when it is exceeded
+    void applyMemoryBudget();
+    qint64 m_memoryBudget;
+    quint64 m_activationCounter;
+    QHash<ChildWidget*, quint64> m_tabActivation;
 };
 
 #endif  // SRC_INCLUDE_MAINWINDOW_H_
@@ -0,0 +1,321 @@
+/**********************************************************************
+* File:        PageLayout.cpp
+* Description: Lines, blocks and reading order of boxes on page
+* Author:      Zdenko Podobny
+* Created:     2026-10-19
+*
+* (C) Copyright 2026, Zdenko Podobny
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**    http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*
+**********************************************************************/
+
+
+#include <climits>
+
+#include <algorithm>
+
+#include "BoxGrid.h"
+#include "PageLayout.h"
+#include "Trace.h"
+
+namespace {
+
+int findRoot(QVector<int>* parent, int i) {
+  while ((*parent)[i] != i) {
+    (*parent)[i] = (*parent)[(*parent)[i]];
+    i = (*parent)[i];
+  }
+  return i;
+}
+
+int verticalOverlap(const QRect& a, const QRect& b) {
+  return qMin(a.bottom(), b.bottom()) - qMax(a.top(), b.top()) + 1;
+}
+
+int horizontalOverlap(const QRect& a, const QRect& b) {
+  return qMin(a.right(), b.right()) - qMax(a.left(), b.left()) + 1;
+}
+
+QRect mirrored(const QRect& r) {
+  return QRect(QPoint(-r.right(), r.top()), QPoint(-r.left(), r.bottom()));
+}
+
+}  // namespace
+
+PageLayout::PageLayout(const BoxPage& page) {
+  TRACE_SPAN(tcModel);
+  m_lineHeight = 1;
+  m_rightToLeft = false;
+  m_rects.reserve(page.size());
+  QVector<int> heights;
+  for (int row = 0; row < page.size(); ++row) {
+    const QStringList& box = page.at(row);
+    bool bold, italic, underline;
+    m_symbols.append(BoxFile::stripStyleFlags(box.at(0), &bold, &italic,
+                                              &underline));
+    // box file y axis goes up
+    int left = box.at(1).toInt();
+    int bottom = box.at(2).toInt();
+    int right = box.at(3).toInt();
+    int top = box.at(4).toInt();
+    QRect rect = QRect(QPoint(left, -top), QPoint(right, -bottom)).normalized();
+    m_rects.append(rect);
+    heights.append(rect.height());
+  }
+  if (!heights.isEmpty()) {
+    std::nth_element(heights.begin(), heights.begin() + heights.size() / 2,
+                     heights.end());
+    m_lineHeight = qMax(1, heights.at(heights.size() / 2));
+  }
+  QVector<int> all(m_rects.size());
+  for (int i = 0; i < all.size(); ++i)
+    all[i] = i;
+  m_rightToLeft = direction(all) > 0;
+  findLines();
+}
+
+int PageLayout::direction(const QVector<int>& boxes) const {
+  int result = 0;
+  for (int i = 0; i < boxes.size(); ++i) {
+    QVector<uint> chars = m_symbols.at(boxes.at(i)).toUcs4();
+    for (int c = 0; c < chars.size(); ++c) {
+      switch (QChar::direction(chars.at(c))) {
+      case QChar::DirR:
+      case QChar::DirAL:
+        ++result;
+        break;
+      case QChar::DirL:
+        --result;
+        break;
+      default:
+        break;
+      }
+    }
+  }
+  return result;
+}
+
+/*
+ * Box is joined with boxes right of it that overlap at least half of the
+ * lower box vertically and are not farther than 1.5 line height (column
+ * gap is usually wider).
+ */
+void PageLayout::findLines() {
+  BoxGrid grid(m_rects, 2 * m_lineHeight);
+  QVector<int> parent(m_rects.size());
+  for (int i = 0; i < parent.size(); ++i)
+    parent[i] = i;
+
+  int maxGap = m_lineHeight * 3 / 2;
+  QVector<int> found;
+  for (int i = 0; i < m_rects.size(); ++i) {
+    const QRect& r = m_rects.at(i);
+    found.clear();
+    grid.query(QRect(r.left(), r.top(), r.width() + maxGap, r.height()),
+               &found);
+    for (int k = 0; k < found.size(); ++k) {
+      int j = found.at(k);
+      const QRect& other = m_rects.at(j);
+      if (j == i || other.left() < r.left())
+        continue;
+      if (2 * verticalOverlap(r, other) < qMin(r.height(), other.height()))
+        continue;
+      int a = findRoot(&parent, i);
+      int b = findRoot(&parent, j);
+      if (a != b)
+        parent[qMax(a, b)] = qMin(a, b);
+    }
+  }
+
+  QVector<int> lineOfRoot(m_rects.size(), -1);
+  QVector<LayoutLine> lines;
+  for (int i = 0; i < m_rects.size(); ++i) {
+    int root = findRoot(&parent, i);
+    if (lineOfRoot.at(root) < 0) {
+      lineOfRoot[root] = lines.size();
+      lines.append(LayoutLine());
+    }
+    LayoutLine& line = lines[lineOfRoot.at(root)];
+    line.m_boxes.append(i);
+    line.m_rect |= m_rects.at(i);
+  }
+  for (int l = 0; l < lines.size(); ++l) {
+    LayoutLine& line = lines[l];
+    int lineDirection = direction(line.m_boxes);
+    line.m_rightToLeft = lineDirection > 0 ||
+                         (lineDirection == 0 && m_rightToLeft);
+    if (line.m_rightToLeft) {
+      std::stable_sort(line.m_boxes.begin(), line.m_boxes.end(),
+                       [this](int a, int b) {
+        return m_rects.at(a).right() > m_rects.at(b).right();
+      });
+    } else {
+      std::stable_sort(line.m_boxes.begin(), line.m_boxes.end(),
+                       [this](int a, int b) {
+        return m_rects.at(a).left() < m_rects.at(b).left();
+      });
+    }
+  }
+  findBlocks(lines);
+}
+
+/*
+ * Line continues block when it overlaps horizontally the last line of block
+ * and gap between them is at most one line.
+ */
+void PageLayout::findBlocks(const QVector<LayoutLine>& lines) {
+  QVector<int> byTop(lines.size());
+  for (int i = 0; i < lines.size(); ++i)
+    byTop[i] = i;
+  std::stable_sort(byTop.begin(), byTop.end(), [&lines](int a, int b) {
+    return lines.at(a).m_rect.top() < lines.at(b).m_rect.top();
+  });
+
+  QVector<LayoutBlock> blocks;
+  QVector<int> open;  // blocks which can continue
+  for (int i = 0; i < byTop.size(); ++i) {
+    const LayoutLine& line = lines.at(byTop.at(i));
+    int target = -1;
+    for (int k = open.size() - 1; k >= 0; --k) {
+      const LayoutBlock& block = blocks.at(open.at(k));
+      const QRect& last = block.m_lines.last().m_rect;
+      if (line.m_rect.top() - last.bottom() > last.height()) {
+        open.remove(k);  // next lines are even lower
+        continue;
+      }
+      if (target < 0 && horizontalOverlap(last, line.m_rect) > 0)
+        target = open.at(k);
+    }
+    if (target < 0) {
+      target = blocks.size();
+      blocks.append(LayoutBlock());
+      open.append(target);
+    }
+    blocks[target].m_lines.append(line);
+    blocks[target].m_rect |= line.m_rect;
+  }
+
+  QVector<QRect> rects(blocks.size());
+  QVector<int> all(blocks.size());
+  for (int i = 0; i < blocks.size(); ++i) {
+    // columns of right-to-left page are read from right
+    rects[i] = m_rightToLeft ? mirrored(blocks.at(i).m_rect)
+                             : blocks.at(i).m_rect;
+    all[i] = i;
+  }
+  QVector<int> order;
+  orderBlocks(rects, all, &order);
+  m_blocks.clear();
+  for (int i = 0; i < order.size(); ++i)
+    m_blocks.append(blocks.at(order.at(i)));
+}
+
+/*
+ * Recursive X-Y cut: blocks are split by vertical gap (columns) first, then
+ * by horizontal gap. Blocks which cannot be split are ordered from top.
+ */
+void PageLayout::orderBlocks(const QVector<QRect>& rects, QVector<int> blocks,
+                             QVector<int>* order) {
+  if (blocks.size() < 2) {
+    *order += blocks;
+    return;
+  }
+  for (int direction = 0; direction < 2; ++direction) {
+    bool vertical = direction == 0;
+    std::stable_sort(blocks.begin(), blocks.end(), [&](int a, int b) {
+      const QRect& ra = rects.at(a);
+      const QRect& rb = rects.at(b);
+      return vertical ? ra.left() < rb.left() : ra.top() < rb.top();
+    });
+    QVector<int> part;
+    int end = INT_MIN;
+    QVector<QVector<int> > parts;
+    for (int i = 0; i < blocks.size(); ++i) {
+      const QRect& r = rects.at(blocks.at(i));
+      int start = vertical ? r.left() : r.top();
+      if (!part.isEmpty() && start > end) {
+        parts.append(part);
+        part.clear();
+      }
+      part.append(blocks.at(i));
+      end = qMax(end, vertical ? r.right() : r.bottom());
+    }
+    parts.append(part);
+    if (parts.size() > 1) {
+      for (int i = 0; i < parts.size(); ++i)
+        orderBlocks(rects, parts.at(i), order);
+      return;
+    }
+  }
+  // blocks are sorted from top by the last pass
+  *order += blocks;
+}
+
+QVector<int> PageLayout::readingOrder() const {
+  QVector<int> order;
+  order.reserve(m_rects.size());
+  for (int b = 0; b < m_blocks.size(); ++b) {
+    const LayoutBlock& block = m_blocks.at(b);
+    for (int l = 0; l < block.m_lines.size(); ++l)
+      order += block.m_lines.at(l).m_boxes;
+  }
+  return order;
+}
+
+/*
+ * Words are separated by gap of at least wordSpace. New paragraph starts
+ * with block, with line indented by paraIndent, after empty line or after
+ * line that ends paraIndent before right edge of block.
+ */
+QString PageLayout::text(int eType, int wordSpace, int paraIndent) const {
+  QString text;
+  text.reserve(m_symbols.size() * 2);
+  for (int b = 0; b < m_blocks.size(); ++b) {
+    const LayoutBlock& block = m_blocks.at(b);
+    for (int l = 0; l < block.m_lines.size(); ++l) {
+      const LayoutLine& line = block.m_lines.at(l);
+      if (eType == BoxFile::etParagraphPerLine && l > 0) {
+        const QRect& previous = block.m_lines.at(l - 1).m_rect;
+        bool newParagraph =
+          line.m_rect.top() - previous.bottom() > previous.height() ||
+          (line.m_rightToLeft
+           ? block.m_rect.right() - line.m_rect.right() >= paraIndent ||
+             previous.left() - block.m_rect.left() >= paraIndent
+           : line.m_rect.left() - block.m_rect.left() >= paraIndent ||
+             block.m_rect.right() - previous.right() >= paraIndent);
+        text += newParagraph ? QLatin1Char('\n') : QLatin1Char(' ');
+      } else if (!text.isEmpty()) {
+        text += QLatin1Char('\n');
+      }
+
+      for (int i = 0; i < line.m_boxes.size(); ++i) {
+        int box = line.m_boxes.at(i);
+        if (eType == BoxFile::etSymbolPerLine) {
+          if (i > 0)
+            text += QLatin1Char('\n');
+        } else if (i > 0) {
+          const QRect& r = m_rects.at(box);
+          const QRect& previous = m_rects.at(line.m_boxes.at(i - 1));
+          int gap = line.m_rightToLeft ? previous.left() - r.right()
+                                       : r.left() - previous.right();
+          if (gap >= wordSpace)
+            text += QLatin1Char(' ');
+        }
+        text += m_symbols.at(box);
+      }
+    }
+  }
+  text += QLatin1Char('\n');
+  return text;
+}
@@ -0,0 +1,92 @@
+/**********************************************************************
+* File:        PageLayout.h
+* Description: Lines, blocks and reading order of boxes on page
+* Author:      Zdenko Podobny
+* Created:     2026-10-19
+*
+* (C) Copyright 2026, Zdenko Podobny
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**    http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*
+**********************************************************************/
+
+
+#ifndef SRC_PAGELAYOUT_H_
+#define SRC_PAGELAYOUT_H_
+
+#include <QRect>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+#include "BoxFile.h"
+
+// Boxes (indexes to page) of one text line in reading order
+struct LayoutLine {
+    QVector<int> m_boxes;
+    QRect m_rect;
+    bool m_rightToLeft;
+};
+
+// Lines of column or paragraph block from top
+struct LayoutBlock {
+    QVector<LayoutLine> m_lines;
+    QRect m_rect;
+};
+
+/*
+ * Geometric layout of page. Boxes with vertical overlap and small gap form
+ * lines, lines below each other form blocks (columns) and blocks are put to
+ * reading order by recursive X-Y cut. Rectangles use top-down coordinates.
+ * Direction of line (and order of columns on page) is given by majority of
+ * strong characters (right-to-left for Hebrew, Arabic...).
+ */
+class PageLayout {
+  public:
+    explicit PageLayout(const BoxPage& page);
+
+    const QVector<LayoutBlock>& blocks() const {
+        return m_blocks;
+    }
+    // Symbol (without font flags) of box
+    const QString& symbol(int box) const {
+        return m_symbols.at(box);
+    }
+    const QRect& rect(int box) const {
+        return m_rects.at(box);
+    }
+
+    bool isRightToLeft() const {
+        return m_rightToLeft;
+    }
+    // Boxes (indexes to page) in reading order
+    QVector<int> readingOrder() const;
+    // Text of page in format of BoxFile::exportType
+    QString text(int eType, int wordSpace, int paraIndent) const;
+
+  private:
+    // Strong right-to-left characters minus left-to-right ones
+    int direction(const QVector<int>& boxes) const;
+    void findLines();
+    void findBlocks(const QVector<LayoutLine>& lines);
+    static void orderBlocks(const QVector<QRect>& rects, QVector<int> blocks,
+                            QVector<int>* order);
+
+    QStringList m_symbols;
+    QVector<QRect> m_rects;
+    int m_lineHeight;  // median box height
+    bool m_rightToLeft;
+    QVector<LayoutBlock> m_blocks;
+};
+
+#endif  // SRC_PAGELAYOUT_H_
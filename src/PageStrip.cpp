@@ -0,0 +1,224 @@
+/**********************************************************************
+* File:        PageStrip.cpp
+* Description: Thumbnails of pages of multi-page image
+* Author:      Zdenko Podobny
+* Created:     2026-10-19
+*
+* (C) Copyright 2026, Zdenko Podobny
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**    http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*
+**********************************************************************/
+
+
+#include <QRunnable>
+#include <QScrollBar>
+#include <QThread>
+#include <QTimer>
+
+#include "ImageCache.h"
+#include "PageStrip.h"
+#include "Trace.h"
+
+// Thumbnails kept in memory (about 30 KB each)
+static const int kCachedThumbnails = 256;
+// Pages next to visible part generated in advance
+static const int kPrefetchPages = 3;
+
+class PageThumbnailJob : public QRunnable {
+  public:
+    PageThumbnailJob(PageStripModel* model, const QString& imageFile,
+                     int page)
+        : m_model(model), m_imageFile(imageFile), m_page(page) {
+    }
+
+    void run() {
+        TRACE_SCOPE("PageThumbnailJob", tcIO);
+        QImage thumbnail = ImageCache::thumbnail(
+          m_imageFile, m_page, PageStripModel::kThumbnailSize);
+        QMetaObject::invokeMethod(m_model, "thumbnailReady",
+                                  Qt::QueuedConnection,
+                                  Q_ARG(int, m_page),
+                                  Q_ARG(QImage, thumbnail));
+    }
+
+  private:
+    PageStripModel* m_model;
+    QString m_imageFile;
+    int m_page;
+};
+
+PageStripModel::PageStripModel(QObject* parent)
+  : QAbstractListModel(parent) {
+  m_pageCount = 0;
+  m_thumbnails.setMaxCost(kCachedThumbnails);
+  // pages are decoded by leptonica; a few decoders are enough
+  m_pool.setMaxThreadCount(qMax(1, QThread::idealThreadCount() / 2));
+  m_placeholder = QImage(kThumbnailSize * 3 / 4, kThumbnailSize,
+                         QImage::Format_RGB32);
+  m_placeholder.fill(Qt::white);
+}
+
+/*
+ * Job posts result to model, so it must not outlive it
+ */
+PageStripModel::~PageStripModel() {
+  m_pool.clear();
+  m_pool.waitForDone();
+}
+
+void PageStripModel::setImage(const QString& imageFile, int pageCount) {
+  beginResetModel();
+  cancelPending();
+  m_thumbnails.clear();
+  m_imageFile = imageFile;
+  m_pageCount = pageCount;
+  m_boxCounts.clear();
+  m_modified.clear();
+  endResetModel();
+}
+
+void PageStripModel::setPageInfo(const QVector<int>& boxCounts,
+                                 const QVector<bool>& modified) {
+  for (int page = 0; page < m_pageCount; ++page) {
+    if (boxCounts.value(page, -1) != m_boxCounts.value(page, -1) ||
+        modified.value(page) != m_modified.value(page)) {
+      QModelIndex cell = index(page);
+      m_boxCounts = boxCounts;
+      m_modified = modified;
+      emit dataChanged(cell, cell);
+    }
+  }
+  m_boxCounts = boxCounts;
+  m_modified = modified;
+}
+
+void PageStripModel::request(int page) const {
+  if (page < 0 || page >= m_pageCount || m_pending.contains(page) ||
+      m_thumbnails.contains(page))
+    return;
+  m_pending.insert(page);
+  m_pool.start(new PageThumbnailJob(const_cast<PageStripModel*>(this),
+                                    m_imageFile, page));
+}
+
+void PageStripModel::cancelPending() {
+  m_pool.clear();
+  m_pending.clear();
+}
+
+int PageStripModel::rowCount(const QModelIndex& parent) const {
+  return parent.isValid() ? 0 : m_pageCount;
+}
+
+QVariant PageStripModel::data(const QModelIndex& index, int role) const {
+  if (!index.isValid() || index.row() >= m_pageCount)
+    return QVariant();
+  int page = index.row();
+  switch (role) {
+  case Qt::DisplayRole: {
+    QString text = QString::number(page + 1);
+    if (m_boxCounts.value(page, -1) >= 0)
+      text += QString(" (%1)").arg(m_boxCounts.at(page));
+    if (m_modified.value(page))
+      text += "*";
+    return text;
+  }
+  case Qt::ToolTipRole:
+    return tr("Page %1: %2 boxes%3").arg(page + 1)
+           .arg(qMax(0, m_boxCounts.value(page)))
+           .arg(m_modified.value(page) ? tr(", modified") : QString());
+  case Qt::DecorationRole: {
+    QImage* thumbnail = m_thumbnails.object(page);
+    if (thumbnail)
+      return *thumbnail;
+    request(page);
+    return m_placeholder;
+  }
+  default:
+    return QVariant();
+  }
+}
+
+void PageStripModel::thumbnailReady(int page, const QImage& thumbnail) {
+  m_pending.remove(page);
+  if (page >= m_pageCount)
+    return;
+  m_thumbnails.insert(page, new QImage(thumbnail));
+  QModelIndex cell = index(page);
+  emit dataChanged(cell, cell);
+}
+
+PageStrip::PageStrip(QWidget* parent)
+  : QListView(parent) {
+  m_model = new PageStripModel(this);
+  setViewMode(QListView::IconMode);
+  setFlow(QListView::LeftToRight);
+  setWrapping(false);
+  setMovement(QListView::Static);
+  setUniformItemSizes(true);
+  setHorizontalScrollBarPolicy(Qt::ScrollBarAsNeeded);
+  setVerticalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
+  setIconSize(QSize(PageStripModel::kThumbnailSize,
+                    PageStripModel::kThumbnailSize));
+  setGridSize(QSize(PageStripModel::kThumbnailSize + 12,
+                    PageStripModel::kThumbnailSize + 24));
+  setFixedHeight(PageStripModel::kThumbnailSize + 24 + 2 * frameWidth() +
+                 horizontalScrollBar()->sizeHint().height());
+  setModel(m_model);
+  connect(this, SIGNAL(clicked(QModelIndex)), this,
+          SLOT(pageClicked(QModelIndex)));
+  connect(horizontalScrollBar(), SIGNAL(valueChanged(int)), this,
+          SLOT(scrolled()));
+}
+
+void PageStrip::setCurrentPage(int page) {
+  QModelIndex cell = m_model->index(page);
+  if (!cell.isValid())
+    return;
+  setCurrentIndex(cell);
+  scrollTo(cell);
+}
+
+void PageStrip::pageClicked(const QModelIndex& index) {
+  emit pageActivated(index.row());
+}
+
+/*
+ * Pages scrolled away are not generated; visible ones are requested again
+ * when painted and their neighbours by prefetch.
+ */
+void PageStrip::scrolled() {
+  m_model->cancelPending();
+  QTimer::singleShot(0, this, SLOT(prefetch()));
+}
+
+void PageStrip::resizeEvent(QResizeEvent* event) {
+  QListView::resizeEvent(event);
+  QTimer::singleShot(0, this, SLOT(prefetch()));
+}
+
+void PageStrip::prefetch() {
+  QModelIndex first = indexAt(QPoint(gridSize().width() / 2,
+                                     gridSize().height() / 2));
+  QModelIndex last = indexAt(QPoint(viewport()->width() -
+                                    gridSize().width() / 2,
+                                    gridSize().height() / 2));
+  if (!first.isValid())
+    return;
+  int lastRow = last.isValid() ? last.row() : m_model->rowCount() - 1;
+  for (int page = 1; page <= kPrefetchPages; ++page) {
+    m_model->request(lastRow + page);
+    m_model->request(first.row() - page);
+  }
+}
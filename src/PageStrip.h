@@ -0,0 +1,99 @@
+/**********************************************************************
+* File:        PageStrip.h
+* Description: Thumbnails of pages of multi-page image
+* Author:      Zdenko Podobny
+* Created:     2026-10-19
+*
+* (C) Copyright 2026, Zdenko Podobny
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**    http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*
+**********************************************************************/
+
+
+#ifndef SRC_PAGESTRIP_H_
+#define SRC_PAGESTRIP_H_
+
+#include <QAbstractListModel>
+#include <QCache>
+#include <QImage>
+#include <QListView>
+#include <QSet>
+#include <QThreadPool>
+
+/*
+ * Page numbers with box count and modification marker. Thumbnail is
+ * generated (ImageCache::thumbnail) by worker only when view asks for it or
+ * when page is near visible part of strip (prefetch).
+ */
+class PageStripModel : public QAbstractListModel {
+    Q_OBJECT
+
+  public:
+    static const int kThumbnailSize = 96;
+
+    explicit PageStripModel(QObject* parent = 0);
+    ~PageStripModel();
+
+    void setImage(const QString& imageFile, int pageCount);
+    // Only pages with changed values are updated in view
+    void setPageInfo(const QVector<int>& boxCounts,
+                     const QVector<bool>& modified);
+    void request(int page) const;
+    // Forget requests which were not started
+    void cancelPending();
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const;
+    QVariant data(const QModelIndex& index, int role) const;
+
+  private slots:
+    void thumbnailReady(int page, const QImage& thumbnail);
+
+  private:
+    QString m_imageFile;
+    int m_pageCount;
+    QVector<int> m_boxCounts;
+    QVector<bool> m_modified;
+    mutable QCache<int, QImage> m_thumbnails;
+    mutable QSet<int> m_pending;
+    mutable QThreadPool m_pool;
+    QImage m_placeholder;
+};
+
+class PageStrip : public QListView {
+    Q_OBJECT
+
+  public:
+    explicit PageStrip(QWidget* parent = 0);
+
+    PageStripModel* stripModel() const {
+        return m_model;
+    }
+    void setCurrentPage(int page);
+
+  signals:
+    void pageActivated(int page);
+
+  protected:
+    void resizeEvent(QResizeEvent* event);
+
+  private slots:
+    void pageClicked(const QModelIndex& index);
+    void scrolled();
+    void prefetch();
+
+  private:
+    PageStripModel* m_model;
+};
+
+#endif  // SRC_PAGESTRIP_H_
@@ -0,0 +1,40 @@
+/**********************************************************************
+* File:        PerfCounters.cpp
+* Description: Counters published by subsystems for performance overlay
+* Author:      Zdenko Podobny
+* Created:     2026-10-19
+*
+* (C) Copyright 2026, Zdenko Podobny
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**    http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*
+**********************************************************************/
+
+
+#include <QAtomicInteger>
+
+#include "PerfCounters.h"
+
+static QAtomicInteger<qint64> s_counters[pcCounterCount];
+
+void PerfCounters::set(perfCounter counter, qint64 value) {
+  s_counters[counter].storeRelease(value);
+}
+
+void PerfCounters::add(perfCounter counter, qint64 value) {
+  s_counters[counter].fetchAndAddRelaxed(value);
+}
+
+qint64 PerfCounters::value(perfCounter counter) {
+  return s_counters[counter].loadAcquire();
+}
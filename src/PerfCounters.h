@@ -0,0 +1,66 @@
+/**********************************************************************
+* File:        PerfCounters.h
+* Description: Counters published by subsystems for performance overlay
+* Author:      Zdenko Podobny
+* Created:     2026-10-19
+*
+* (C) Copyright 2026, Zdenko Podobny
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**    http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*
+**********************************************************************/
+
+
+#ifndef SRC_PERFCOUNTERS_H_
+#define SRC_PERFCOUNTERS_H_
+
+#include <QElapsedTimer>
+#include <QtGlobal>
+
+enum perfCounter {
+    pcLoadTime = 0,     // duration of last document load (ns)
+    pcSaveTime,         // duration of last save (ns)
+    pcPageTime,         // duration of last page change (ns)
+    pcCacheHits,        // decoded image cache
+    pcCacheMisses,
+    pcCounterCount
+};
+
+/*
+ * Global counters (atomic, so they can be published from worker threads).
+ * They are only read by performance overlay, so publishing is one store.
+ */
+class PerfCounters {
+  public:
+    static void set(perfCounter counter, qint64 value);
+    static void add(perfCounter counter, qint64 value);
+    static qint64 value(perfCounter counter);
+};
+
+// Stores duration of scope to counter
+class PerfTimer {
+  public:
+    explicit PerfTimer(perfCounter counter) : m_counter(counter) {
+        m_timer.start();
+    }
+    ~PerfTimer() {
+        PerfCounters::set(m_counter, m_timer.nsecsElapsed());
+    }
+
+  private:
+    Q_DISABLE_COPY(PerfTimer)
+    perfCounter m_counter;
+    QElapsedTimer m_timer;
+};
+
+#endif  // SRC_PERFCOUNTERS_H_
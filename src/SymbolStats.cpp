@@ -0,0 +1,278 @@
+/**********************************************************************
+* File:        SymbolStats.cpp
+* Description: Incremental statistics of box sizes per symbol
+* Author:      Zdenko Podobny
+* Created:     2026-10-19
+*
+* (C) Copyright 2026, Zdenko Podobny
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**    http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*
+**********************************************************************/
+
+
+#include <climits>
+
+#include <algorithm>
+
+#include <QPair>
+#include <qmath.h>
+
+#include "SymbolStats.h"
+#include "Trace.h"
+
+// Distribution of fewer boxes does not define outliers
+static const int kMinSamples = 5;
+// Allowed deviation: 3 sigma estimated by MAD, but at least 25 % of median
+static const double kMadScale = 3 * 1.4826;
+static const double kMinDeviation = 0.25;
+
+namespace {
+
+void addCount(QMap<int, int>* histogram, int value, int delta) {
+  QMap<int, int>::iterator it = histogram->find(value);
+  if (it == histogram->end()) {
+    if (delta > 0)
+      histogram->insert(value, delta);
+    return;
+  }
+  it.value() += delta;
+  if (it.value() <= 0)
+    histogram->erase(it);
+}
+
+// Value at position index of sorted values
+int valueAt(const QMap<int, int>& histogram, int index) {
+  int seen = 0;
+  QMap<int, int>::const_iterator it;
+  for (it = histogram.constBegin(); it != histogram.constEnd(); ++it) {
+    seen += it.value();
+    if (seen > index)
+      return it.key();
+  }
+  return histogram.isEmpty() ? 0 : histogram.lastKey();
+}
+
+// Median absolute deviation from median
+int deviation(const QMap<int, int>& histogram, int count, int median) {
+  QVector<QPair<int, int> > deviations;
+  deviations.reserve(histogram.size());
+  QMap<int, int>::const_iterator it;
+  for (it = histogram.constBegin(); it != histogram.constEnd(); ++it)
+    deviations.append(qMakePair(qAbs(it.key() - median), it.value()));
+  std::sort(deviations.begin(), deviations.end());
+  int seen = 0;
+  for (int i = 0; i < deviations.size(); ++i) {
+    seen += deviations.at(i).second;
+    if (seen > (count - 1) / 2)
+      return deviations.at(i).first;
+  }
+  return 0;
+}
+
+void range(const QMap<int, int>& histogram, int count, int median,
+           int* low, int* high) {
+  if (count < kMinSamples) {
+    *low = INT_MIN;
+    *high = INT_MAX;
+    return;
+  }
+  double allowed = qMax(kMadScale * deviation(histogram, count, median),
+                        kMinDeviation * median);
+  allowed = qMax(allowed, 2.0);
+  *low = qFloor(median - allowed);
+  *high = qCeil(median + allowed);
+}
+
+}  // namespace
+
+SymbolStats::SymbolStats() {
+  m_boxCount = 0;
+}
+
+void SymbolStats::clear() {
+  m_symbols.clear();
+  m_pages.clear();
+  m_boxCount = 0;
+}
+
+QString SymbolStats::symbol(const QStringList& box) {
+  bool bold, italic, underline;
+  return BoxFile::stripStyleFlags(box.value(0), &bold, &italic, &underline);
+}
+
+void SymbolStats::add(const QStringList& box) {
+  account(box, 1);
+}
+
+void SymbolStats::remove(const QStringList& box) {
+  account(box, -1);
+}
+
+void SymbolStats::account(const QStringList& box, int delta) {
+  bool bold, italic, underline;
+  QString letter = BoxFile::stripStyleFlags(box.value(0), &bold, &italic,
+                                            &underline);
+  QHash<QString, Distribution>::iterator it = m_symbols.find(letter);
+  if (it == m_symbols.end()) {
+    if (delta < 0)
+      return;
+    Distribution empty;
+    empty.m_count = 0;
+    empty.m_bold = 0;
+    empty.m_italic = 0;
+    empty.m_underline = 0;
+    empty.m_dirty = true;
+    it = m_symbols.insert(letter, empty);
+  }
+  Distribution& d = it.value();
+  int width = box.value(3).toInt() - box.value(1).toInt();
+  int height = box.value(4).toInt() - box.value(2).toInt();
+  d.m_count += delta;
+  d.m_bold += bold ? delta : 0;
+  d.m_italic += italic ? delta : 0;
+  d.m_underline += underline ? delta : 0;
+  addCount(&d.m_widths, width, delta);
+  addCount(&d.m_heights, height, delta);
+  if (height > 0)
+    addCount(&d.m_aspects, qRound(1000.0 * width / height), delta);
+  d.m_dirty = true;
+  m_boxCount += delta;
+  if (d.m_count <= 0)
+    m_symbols.erase(it);
+}
+
+void SymbolStats::update(const BoxPages& pages) {
+  TRACE_SPAN(tcModel);
+  for (int page = 0; page < qMax(pages.size(), m_pages.size()); ++page) {
+    if (page >= pages.size()) {
+      for (int row = 0; row < m_pages.at(page).size(); ++row)
+        remove(m_pages.at(page).at(row));
+      continue;
+    }
+    const BoxPage& now = pages.at(page);
+    if (page >= m_pages.size()) {
+      for (int row = 0; row < now.size(); ++row)
+        add(now.at(row));
+      continue;
+    }
+    const BoxPage& before = m_pages.at(page);
+    if (now == before)  // shared data are equal without comparison
+      continue;
+    if (now.size() != before.size()) {
+      for (int row = 0; row < before.size(); ++row)
+        remove(before.at(row));
+      for (int row = 0; row < now.size(); ++row)
+        add(now.at(row));
+      continue;
+    }
+    for (int row = 0; row < now.size(); ++row) {
+      if (now.at(row) != before.at(row)) {
+        remove(before.at(row));
+        add(now.at(row));
+      }
+    }
+  }
+  m_pages = pages;
+}
+
+QStringList SymbolStats::symbols() const {
+  QStringList result = m_symbols.keys();
+  std::sort(result.begin(), result.end(),
+            [this](const QString& a, const QString& b) {
+              int countA = m_symbols.constFind(a).value().m_count;
+              int countB = m_symbols.constFind(b).value().m_count;
+              return countA != countB ? countA > countB : a < b;
+            });
+  return result;
+}
+
+void SymbolStats::computeSummary(Distribution* d) {
+  SymbolSummary& s = d->m_summary;
+  s.m_count = d->m_count;
+  s.m_bold = d->m_bold;
+  s.m_italic = d->m_italic;
+  s.m_underline = d->m_underline;
+  int middle = (d->m_count - 1) / 2;
+  s.m_minWidth = d->m_widths.firstKey();
+  s.m_medianWidth = valueAt(d->m_widths, middle);
+  s.m_maxWidth = d->m_widths.lastKey();
+  s.m_minHeight = d->m_heights.firstKey();
+  s.m_medianHeight = valueAt(d->m_heights, middle);
+  s.m_maxHeight = d->m_heights.lastKey();
+  if (d->m_aspects.isEmpty()) {
+    s.m_minAspect = s.m_medianAspect = s.m_maxAspect = 0;
+  } else {
+    int aspects = 0;
+    QMap<int, int>::const_iterator it;
+    for (it = d->m_aspects.constBegin(); it != d->m_aspects.constEnd(); ++it)
+      aspects += it.value();
+    s.m_minAspect = d->m_aspects.firstKey() / 1000.0;
+    s.m_medianAspect = valueAt(d->m_aspects, (aspects - 1) / 2) / 1000.0;
+    s.m_maxAspect = d->m_aspects.lastKey() / 1000.0;
+  }
+  range(d->m_widths, d->m_count, s.m_medianWidth, &s.m_widthLow,
+        &s.m_widthHigh);
+  range(d->m_heights, d->m_count, s.m_medianHeight, &s.m_heightLow,
+        &s.m_heightHigh);
+  d->m_dirty = false;
+}
+
+/*
+ * Summary is computed from histograms (cost depends on number of distinct
+ * sizes, not on number of boxes) and kept until symbol is changed.
+ */
+SymbolSummary SymbolStats::summary(const QString& symbol) const {
+  QHash<QString, Distribution>::iterator it = m_symbols.find(symbol);
+  if (it == m_symbols.end()) {
+    SymbolSummary empty = {};
+    return empty;
+  }
+  if (it.value().m_dirty)
+    computeSummary(&it.value());
+  return it.value().m_summary;
+}
+
+bool SymbolStats::isOutlier(const QStringList& box) const {
+  SymbolSummary s = summary(symbol(box));
+  int width = box.value(3).toInt() - box.value(1).toInt();
+  int height = box.value(4).toInt() - box.value(2).toInt();
+  return width < s.m_widthLow || width > s.m_widthHigh ||
+         height < s.m_heightLow || height > s.m_heightHigh;
+}
+
+QVector<BoxRef> SymbolStats::outliers(const QString& symbol,
+                                      const BoxPages& pages) const {
+  TRACE_SPAN(tcModel);
+  QVector<BoxRef> result;
+  SymbolSummary s = summary(symbol);
+  if (s.m_count < kMinSamples)
+    return result;
+  for (int page = 0; page < pages.size(); ++page) {
+    const BoxPage& boxes = pages.at(page);
+    for (int row = 0; row < boxes.size(); ++row) {
+      const QStringList& box = boxes.at(row);
+      // flags are only prefix of symbol
+      if (!box.value(0).endsWith(symbol) || SymbolStats::symbol(box) != symbol)
+        continue;
+      int width = box.value(3).toInt() - box.value(1).toInt();
+      int height = box.value(4).toInt() - box.value(2).toInt();
+      if (width < s.m_widthLow || width > s.m_widthHigh ||
+          height < s.m_heightLow || height > s.m_heightHigh) {
+        BoxRef ref = {page, row};
+        result.append(ref);
+      }
+    }
+  }
+  return result;
+}
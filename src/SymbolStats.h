@@ -0,0 +1,113 @@
+/**********************************************************************
+* File:        SymbolStats.h
+* Description: Incremental statistics of box sizes per symbol
+* Author:      Zdenko Podobny
+* Created:     2026-10-19
+*
+* (C) Copyright 2026, Zdenko Podobny
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**    http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*
+**********************************************************************/
+
+
+#ifndef SRC_SYMBOLSTATS_H_
+#define SRC_SYMBOLSTATS_H_
+
+#include <QHash>
+#include <QMap>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+#include "BoxFile.h"
+
+// Box in BoxPages
+struct BoxRef {
+    int m_page;
+    int m_row;
+};
+
+struct SymbolSummary {
+    int m_count;
+    int m_bold;
+    int m_italic;
+    int m_underline;
+    int m_minWidth;
+    int m_medianWidth;
+    int m_maxWidth;
+    int m_minHeight;
+    int m_medianHeight;
+    int m_maxHeight;
+    double m_minAspect;     // width / height
+    double m_medianAspect;
+    double m_maxAspect;
+    // boxes outside of these ranges are outliers (all allowed if too few)
+    int m_widthLow;
+    int m_widthHigh;
+    int m_heightLow;
+    int m_heightHigh;
+};
+
+/*
+ * Size distributions of boxes per symbol (style flags are counted, not
+ * separated). Distributions are histograms, so box can be added and removed
+ * and update() costs only pages changed since the previous update.
+ */
+class SymbolStats {
+  public:
+    SymbolStats();
+
+    void clear();
+    /** Account changes since previous update. Pages which still share data
+     *  with previous state (implicit sharing) are skipped without
+     *  comparison, changed pages are compared row by row.
+     */
+    void update(const BoxPages& pages);
+    void add(const QStringList& box);
+    void remove(const QStringList& box);
+
+    int boxCount() const {
+        return m_boxCount;
+    }
+    // Symbols sorted by number of boxes (the most frequent first)
+    QStringList symbols() const;
+    SymbolSummary summary(const QString& symbol) const;
+    // Width or height is far from median of symbol (median absolute deviation)
+    bool isOutlier(const QStringList& box) const;
+    QVector<BoxRef> outliers(const QString& symbol,
+                             const BoxPages& pages) const;
+
+    static QString symbol(const QStringList& box);
+
+  private:
+    struct Distribution {
+        int m_count;
+        int m_bold;
+        int m_italic;
+        int m_underline;
+        QMap<int, int> m_widths;
+        QMap<int, int> m_heights;
+        QMap<int, int> m_aspects;   // per mille
+        bool m_dirty;               // summary has to be computed again
+        SymbolSummary m_summary;
+    };
+    void account(const QStringList& box, int delta);
+    static void computeSummary(Distribution* distribution);
+
+    mutable QHash<QString, Distribution> m_symbols;  // summary is cached
+    BoxPages m_pages;   // state of the previous update
+    int m_boxCount;
+};
+
+#endif  // SRC_SYMBOLSTATS_H_
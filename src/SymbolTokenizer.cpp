@@ -0,0 +1,118 @@
+/**********************************************************************
+* File:        SymbolTokenizer.cpp
+* Description: Split text to symbols with ligatures
+* Author:      Zdenko Podobny
+* Created:     2026-10-19
+*
+* (C) Copyright 2026, Zdenko Podobny
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**    http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*
+**********************************************************************/
+
+
+#include <QTextStream>
+
+#include "SymbolTokenizer.h"
+#include "Trace.h"
+
+SymbolTokenizer::SymbolTokenizer(const QStringList& ligatures) {
+  m_terminal.append(false);  // root
+  m_maxLength = 0;
+  m_pos = 0;
+  for (int i = 0; i < ligatures.size(); ++i) {
+    const QString& ligature = ligatures.at(i);
+    if (ligature.isEmpty())
+      continue;
+    int node = 0;
+    for (int c = 0; c < ligature.size(); ++c) {
+      quint64 key = (quint64(node) << 16) | ligature.at(c).unicode();
+      QHash<quint64, int>::const_iterator edge = m_edges.constFind(key);
+      if (edge == m_edges.constEnd()) {
+        m_terminal.append(false);
+        edge = m_edges.insert(key, m_terminal.size() - 1);
+      }
+      node = edge.value();
+    }
+    m_terminal[node] = true;
+    m_maxLength = qMax(m_maxLength, ligature.size());
+  }
+}
+
+int SymbolTokenizer::match(int pos) const {
+  int node = 0;
+  int length = 0;
+  for (int i = pos; i < m_buffer.size(); ++i) {
+    QHash<quint64, int>::const_iterator edge =
+      m_edges.constFind((quint64(node) << 16) | m_buffer.at(i).unicode());
+    if (edge == m_edges.constEnd())
+      break;
+    node = edge.value();
+    if (m_terminal.at(node))
+      length = i - pos + 1;
+  }
+  return length;
+}
+
+void SymbolTokenizer::feed(const QString& text, QStringList* symbols) {
+  m_buffer += text;
+  consume(false, symbols);
+}
+
+void SymbolTokenizer::finish(QStringList* symbols) {
+  consume(true, symbols);
+  m_buffer.clear();
+  m_pos = 0;
+}
+
+/*
+ * Symbol is decided only when the longest ligature fits to rest of buffer
+ * (or at the end of text), so ligature split between chunks is found too.
+ */
+void SymbolTokenizer::consume(bool final, QStringList* symbols) {
+  while (m_pos < m_buffer.size()) {
+    if (!final && m_buffer.size() - m_pos < qMax(m_maxLength, 2))
+      break;
+    int length = match(m_pos);
+    if (length > 0) {
+      symbols->append(m_buffer.mid(m_pos, length));
+    } else {
+      length = 1;
+      QChar ch = m_buffer.at(m_pos);
+      if (ch.isHighSurrogate() && m_pos + 1 < m_buffer.size() &&
+          m_buffer.at(m_pos + 1).isLowSurrogate())
+        length = 2;
+      if (!ch.isSpace())
+        symbols->append(m_buffer.mid(m_pos, length));
+    }
+    m_pos += length;
+  }
+  // drop processed text from time to time
+  if (m_pos > 65536) {
+    m_buffer.remove(0, m_pos);
+    m_pos = 0;
+  }
+}
+
+QStringList SymbolTokenizer::tokenize(QTextStream* in,
+                                      const QStringList& ligatures) {
+  TRACE_SPAN(tcIO);
+  SymbolTokenizer tokenizer(ligatures);
+  QStringList symbols;
+  while (!in->atEnd()) {
+    QString line = in->readLine();
+    tokenizer.feed(line, &symbols);
+  }
+  tokenizer.finish(&symbols);
+  return symbols;
+}
@@ -0,0 +1,64 @@
+/**********************************************************************
+* File:        SymbolTokenizer.h
+* Description: Split text to symbols with ligatures
+* Author:      Zdenko Podobny
+* Created:     2026-10-19
+*
+* (C) Copyright 2026, Zdenko Podobny
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**    http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*
+**********************************************************************/
+
+
+#ifndef SRC_SYMBOLTOKENIZER_H_
+#define SRC_SYMBOLTOKENIZER_H_
+
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+class QTextStream;
+
+/*
+ * Text is split to symbols in one pass: at every position the longest
+ * ligature (stored in trie) is taken, otherwise one character. Whitespace
+ * outside of ligatures is dropped. Text can be fed in chunks.
+ */
+class SymbolTokenizer {
+  public:
+    explicit SymbolTokenizer(const QStringList& ligatures);
+
+    // Append text; finished symbols are appended to symbols
+    void feed(const QString& text, QStringList* symbols);
+    // Flush rest of text
+    void finish(QStringList* symbols);
+
+    // Read whole stream; line breaks are ignored (as in ground truth text)
+    static QStringList tokenize(QTextStream* in, const QStringList& ligatures);
+
+  private:
+    void consume(bool final, QStringList* symbols);
+    // Length of the longest ligature at m_buffer[pos] or 0
+    int match(int pos) const;
+
+    // Trie: edge key is node << 16 | UTF-16 code unit
+    QHash<quint64, int> m_edges;
+    QVector<bool> m_terminal;
+    int m_maxLength;
+    QString m_buffer;
+    int m_pos;
+};
+
+#endif  // SRC_SYMBOLTOKENIZER_H_
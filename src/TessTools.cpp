@@ -27,6 +27,7 @@
 #include <locale.h>
 
 #include "Settings.h"
+#include "Trace.h"
 
 #ifdef TESSERACT_VERSION  // 3.03 API
 #include <tesseract/renderer.h>
@@ -70,6 +71,7 @@ const char *TessTools::qString2Char(QString string) {
  * Create tesseract box data from QImage
  */
 QString TessTools::makeBoxes(const QImage &qImage, const int page) {
+  TRACE_SPAN(tcOCR);
   PIX *pixs;
   char *outText;
 
@@ -101,7 +103,8 @@ QString TessTools::makeBoxes(const QImage &qImage, const int page) {
     return "";
   }
 
-  QApplication::setOverrideCursor(Qt::WaitCursor);
+  if (isGui())
+    QApplication::setOverrideCursor(Qt::WaitCursor);
 
 #ifdef TESSERACT_VERSION
   api->SetImage(pixs);
@@ -118,7 +121,8 @@ QString TessTools::makeBoxes(const QImage &qImage, const int page) {
   }
   outText = text_out.string();
 #endif  // TESSERACT_VERSION
-  QApplication::restoreOverrideCursor();
+  if (isGui())
+    QApplication::restoreOverrideCursor();
 
   pixDestroy(&pixs);
   api->End();
@@ -132,6 +136,7 @@ QString TessTools::makeBoxes(const QImage &qImage, const int page) {
  * result: PIX
  */
 PIX *TessTools::qImage2PIX(const QImage &qImage) {
+  TRACE_SPAN(tcRender);
   PIX *pixs;
 
   QImage myImage = qImage.rgbSwapped();
@@ -170,6 +175,7 @@ PIX *TessTools::qImage2PIX(const QImage &qImage) {
  * result: QImage
  */
 QImage TessTools::PIX2qImage(PIX *pixImage) {
+  TRACE_SPAN(tcRender);
   int width = pixGetWidth(pixImage);
   int height = pixGetHeight(pixImage);
   int depth = pixGetDepth(pixImage);
@@ -223,6 +229,7 @@ QImage TessTools::PIX2qImage(PIX *pixImage) {
 }
 
 QImage TessTools::GetThresholded(const QImage &qImage) {
+  TRACE_SPAN(tcOCR);
   // TODO(zdenop): Check this for memory leak
   PIX *pixs = qImage2PIX(qImage);
   setDataPath();
@@ -313,7 +320,18 @@ QList<QString> TessTools::getLanguages(QString datapath) {
   return languages;
 }
 
+/*
+ * Batch mode (--batch) runs without QApplication - no message boxes
+ */
+bool TessTools::isGui() {
+  return qobject_cast<QApplication *>(QCoreApplication::instance()) != NULL;
+}
+
 void TessTools::msg(QString messageText) {
+  if (!isGui()) {
+    qWarning() << messageText;
+    return;
+  }
   QMessageBox msgBox;
   msgBox.setText(messageText);
   msgBox.exec();
@@ -47,6 +47,7 @@ class TessTools {
   static QString getLang();
   static void setDataPath();
   static void msg(QString messageText);
+  static bool isGui();
   static const char *kTrainedDataSuffix;
 };
 
@@ -0,0 +1,211 @@
+/**********************************************************************
+* File:        TiffIndex.cpp
+* Description: Directory offsets of multi-page TIFF for direct page access
+* Author:      Zdenko Podobny
+* Created:     2026-10-19
+*
+* (C) Copyright 2026, Zdenko Podobny
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**    http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*
+**********************************************************************/
+
+
+#include <string.h>
+
+#include <QDateTime>
+#include <QFileInfo>
+#include <QList>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSet>
+#include <QtEndian>
+
+#include "TiffIndex.h"
+#include "Trace.h"
+
+// Indexes of recently used files kept open
+static const int kOpenFiles = 8;
+
+static const quint16 kTagImageWidth = 256;
+static const quint16 kTagImageLength = 257;
+static const quint16 kTypeShort = 3;
+static const quint16 kTypeLong8 = 16;  // BigTIFF
+
+static QMutex s_mutex;
+static QList<QSharedPointer<const TiffIndex> > s_open;  // the most recent first
+
+// Reads unsigned value of given size in byte order of file
+static quint64 readValue(const uchar* data, int bytes, bool bigEndian) {
+  switch (bytes) {
+  case 2:
+    return bigEndian ? qFromBigEndian<quint16>(data)
+                     : qFromLittleEndian<quint16>(data);
+  case 4:
+    return bigEndian ? qFromBigEndian<quint32>(data)
+                     : qFromLittleEndian<quint32>(data);
+  default:
+    return bigEndian ? qFromBigEndian<quint64>(data)
+                     : qFromLittleEndian<quint64>(data);
+  }
+}
+
+TiffIndex::TiffIndex() {
+  m_mtime = 0;
+  m_data = 0;
+  m_size = 0;
+}
+
+TiffIndex::~TiffIndex() {
+  if (m_data)
+    m_file.unmap(const_cast<uchar*>(m_data));
+}
+
+QSharedPointer<const TiffIndex> TiffIndex::open(const QString& fileName) {
+  QFileInfo info(fileName);
+  QString path = info.canonicalFilePath();
+  if (path.isEmpty())
+    return QSharedPointer<const TiffIndex>();
+  qint64 mtime = info.lastModified().toMSecsSinceEpoch();
+
+  QMutexLocker locker(&s_mutex);
+  for (int i = 0; i < s_open.size(); ++i) {
+    if (s_open.at(i)->m_path != path)
+      continue;
+    if (s_open.at(i)->m_mtime == mtime) {
+      s_open.move(i, 0);
+      return s_open.first();
+    }
+    s_open.removeAt(i);  // file was changed
+    break;
+  }
+
+  // directories are read only once per file, so it is done under lock
+  QSharedPointer<TiffIndex> index(new TiffIndex());
+  index->m_mtime = mtime;
+  if (!index->build(path))
+    return QSharedPointer<const TiffIndex>();
+  s_open.prepend(index);
+  while (s_open.size() > kOpenFiles)
+    s_open.removeLast();  // users keep their copy open
+  return index;
+}
+
+/*
+ * Only header and chain of directories are read. File which can not be
+ * mapped (e.g. in address space of 32-bit build) is read by seeks.
+ */
+bool TiffIndex::build(const QString& path) {
+  TRACE_SPAN(tcIO);
+  m_path = path;
+  m_file.setFileName(path);
+  if (!m_file.open(QIODevice::ReadOnly))
+    return false;
+  m_size = m_file.size();
+
+  uchar header[16];
+  if (!read(0, 8, header))
+    return false;
+  bool bigEndian;
+  if (header[0] == 'I' && header[1] == 'I')
+    bigEndian = false;
+  else if (header[0] == 'M' && header[1] == 'M')
+    bigEndian = true;
+  else
+    return false;
+  int version = readValue(header + 2, 2, bigEndian);
+  if (version != 42 && version != 43)
+    return false;
+  bool bigTiff = version == 43;
+  // sizes of offset, entry count and entry differ in BigTIFF
+  int offsetBytes = bigTiff ? 8 : 4;
+  int countBytes = bigTiff ? 8 : 2;
+  int entryBytes = bigTiff ? 20 : 12;
+  qint64 offset;
+  if (bigTiff) {
+    if (!read(8, 8, header + 8))
+      return false;
+    offset = readValue(header + 8, 8, bigEndian);
+  } else {
+    offset = readValue(header + 4, 4, bigEndian);
+  }
+
+  m_data = m_file.map(0, m_size);
+
+  QSet<qint64> visited;  // broken file could have loop of directories
+  QByteArray directory;
+  while (offset > 0 && offset < m_size && !visited.contains(offset)) {
+    visited.insert(offset);
+    uchar count[8];
+    if (!read(offset, countBytes, count))
+      break;
+    qint64 entries = readValue(count, countBytes, bigEndian);
+    if (entries <= 0 || entries > m_size / entryBytes)
+      break;
+    qint64 length = entries * entryBytes + offsetBytes;
+    if (offset + countBytes + length > m_size)
+      break;
+    directory.resize(length);
+    uchar* data = reinterpret_cast<uchar*>(directory.data());
+    if (!read(offset + countBytes, length, data))
+      break;
+
+    QSize size;
+    for (qint64 i = 0; i < entries; ++i) {
+      const uchar* entry = data + i * entryBytes;
+      int tag = readValue(entry, 2, bigEndian);
+      if (tag != kTagImageWidth && tag != kTagImageLength)
+        continue;
+      // single value is stored in entry, aligned to its beginning
+      int type = readValue(entry + 2, 2, bigEndian);
+      int valueBytes = type == kTypeShort ? 2 : type == kTypeLong8 ? 8 : 4;
+      int value = readValue(entry + 4 + offsetBytes, valueBytes, bigEndian);
+      if (tag == kTagImageWidth)
+        size.setWidth(value);
+      else
+        size.setHeight(value);
+    }
+    m_offsets.append(offset);
+    m_sizes.append(size);
+    offset = readValue(data + entries * entryBytes, offsetBytes, bigEndian);
+  }
+  return !m_offsets.isEmpty();
+}
+
+bool TiffIndex::read(qint64 pos, qint64 length, uchar* buffer) const {
+  if (pos < 0 || pos + length > m_size)
+    return false;
+  if (m_data) {
+    memcpy(buffer, m_data + pos, length);
+    return true;
+  }
+  // only used while index is built (by one thread)
+  QFile& file = const_cast<QFile&>(m_file);
+  return file.seek(pos) &&
+         file.read(reinterpret_cast<char*>(buffer), length) == length;
+}
+
+/*
+ * Every call has own libtiff handle on the shared mapping, so pages can be
+ * decoded in parallel.
+ */
+PIX* TiffIndex::readPage(int page) const {
+  TRACE_SPAN(tcIO);
+  if (page < 0 || page >= m_offsets.size())
+    return 0;
+  size_t offset = m_offsets.at(page);
+  if (m_data)
+    return pixReadMemFromMultipageTiff(m_data, m_size, &offset);
+  QByteArray name = m_path.toLocal8Bit();
+  return pixReadFromMultipageTiff(name.data(), &offset);
+}
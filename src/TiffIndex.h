@@ -0,0 +1,78 @@
+/**********************************************************************
+* File:        TiffIndex.h
+* Description: Directory offsets of multi-page TIFF for direct page access
+* Author:      Zdenko Podobny
+* Created:     2026-10-19
+*
+* (C) Copyright 2026, Zdenko Podobny
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**    http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*
+**********************************************************************/
+
+
+#ifndef SRC_TIFFINDEX_H_
+#define SRC_TIFFINDEX_H_
+
+#include <leptonica/allheaders.h>
+
+#include <QFile>
+#include <QSharedPointer>
+#include <QSize>
+#include <QString>
+#include <QVector>
+
+/*
+ * TIFF file opened once and mapped to memory (read only), with offsets of
+ * image directories (IFD) of all pages. Page is decoded directly from its
+ * directory, so the last page of big file costs the same as the first one
+ * (leptonica/libtiff walks all previous directories otherwise).
+ * Index is not changed after it is built, so pages can be decoded by
+ * several threads at once.
+ */
+class TiffIndex {
+  public:
+    ~TiffIndex();
+
+    /** Index of file shared by all documents and threads; it is built again
+     *  when file is changed. Null is returned for other formats.
+     */
+    static QSharedPointer<const TiffIndex> open(const QString& fileName);
+
+    int pageCount() const {
+        return m_offsets.size();
+    }
+    // Size from directory, page does not need to be decoded
+    QSize pageSize(int page) const {
+        return m_sizes.value(page);
+    }
+    // Returns 0 on failure; caller must destroy pix
+    PIX* readPage(int page) const;
+
+  private:
+    TiffIndex();
+    Q_DISABLE_COPY(TiffIndex)
+
+    bool build(const QString& path);
+    bool read(qint64 pos, qint64 length, uchar* buffer) const;
+
+    QString m_path;
+    qint64 m_mtime;
+    QFile m_file;
+    const uchar* m_data;  // mapping of whole file or 0
+    qint64 m_size;
+    QVector<qint64> m_offsets;
+    QVector<QSize> m_sizes;
+};
+
+#endif  // SRC_TIFFINDEX_H_
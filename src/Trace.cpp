@@ -0,0 +1,181 @@
+/**********************************************************************
+* File:        Trace.cpp
+* Description: Lightweight tracing of hot paths (Chrome trace format)
+* Author:      Zdenko Podobny
+* Created:     2026-10-19
+*
+* (C) Copyright 2026, Zdenko Podobny
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**    http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*
+**********************************************************************/
+
+
+#include <atomic>
+
+#include <QAtomicInteger>
+#include <QAtomicPointer>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QObject>
+#include <QThread>
+
+#include "Trace.h"
+
+// Must be power of 2
+static const int kTraceCapacity = 1 << 16;
+
+// Fields are read while other thread can write them (see exportChromeTrace)
+struct TraceEvent {
+    // 0 while event is written, otherwise its sequence number + 1
+    QAtomicInteger<quint64> seq;
+    QAtomicPointer<const char> name;
+    QAtomicInt category;
+    QAtomicInteger<quintptr> thread;
+    QAtomicInteger<qint64> start;
+    QAtomicInteger<qint64> duration;
+};
+
+static TraceEvent s_events[kTraceCapacity];
+static QAtomicInteger<quint64> s_next;
+static QAtomicInt s_enabled;
+
+struct TraceClock {
+    TraceClock() {
+        timer.start();
+    }
+    QElapsedTimer timer;
+};
+
+static const QElapsedTimer& traceClock() {
+  static TraceClock clock;
+  return clock.timer;
+}
+
+void Trace::setEnabled(bool enabled) {
+  traceClock();
+  s_enabled.storeRelease(enabled ? 1 : 0);
+}
+
+bool Trace::isEnabled() {
+  return s_enabled.load() != 0;
+}
+
+qint64 Trace::now() {
+  return traceClock().nsecsElapsed();
+}
+
+void Trace::record(const char* name, traceCategory category, qint64 start,
+                   qint64 duration) {
+  quint64 index = s_next.fetchAndAddRelaxed(1);
+  TraceEvent& event = s_events[index & (kTraceCapacity - 1)];
+  event.seq.storeRelaxed(0);
+  // fields must not become visible before seq is cleared
+  std::atomic_thread_fence(std::memory_order_release);
+  event.name.storeRelaxed(name);
+  event.category.storeRelaxed(category);
+  event.thread.storeRelaxed(
+    reinterpret_cast<quintptr>(QThread::currentThreadId()));
+  event.start.storeRelaxed(start);
+  event.duration.storeRelaxed(duration);
+  event.seq.storeRelease(index + 1);
+}
+
+void Trace::clear() {
+  for (int i = 0; i < kTraceCapacity; ++i)
+    s_events[i].seq.storeRelease(0);
+  s_next.storeRelease(0);
+}
+
+int Trace::count() {
+  return static_cast<int>(qMin<quint64>(s_next.loadAcquire(), kTraceCapacity));
+}
+
+const char* Trace::categoryName(traceCategory category) {
+  switch (category) {
+  case tcIO:
+    return "io";
+  case tcModel:
+    return "model";
+  case tcRender:
+    return "render";
+  case tcOCR:
+    return "ocr";
+  case tcUndo:
+    return "undo";
+  }
+  return "other";
+}
+
+/*
+ * Events are copied from buffer without lock. Event which is overwritten
+ * during copy (its sequence number changed) is skipped.
+ */
+bool Trace::exportChromeTrace(const QString& fileName, QString* error) {
+  QJsonArray events;
+  QJsonObject process;
+  process["name"] = QString("process_name");
+  process["ph"] = QString("M");
+  process["pid"] = 1;
+  process["args"] = QJsonObject{{"name", QString("qt-box-editor")}};
+  events.append(process);
+
+  QHash<quintptr, int> threads;
+  quint64 end = s_next.loadAcquire();
+  quint64 begin = end > kTraceCapacity ? end - kTraceCapacity : 0;
+  for (quint64 index = begin; index < end; ++index) {
+    const TraceEvent& slot = s_events[index & (kTraceCapacity - 1)];
+    quint64 seq = slot.seq.loadAcquire();
+    if (seq != index + 1)
+      continue;
+    const char* name = slot.name.loadRelaxed();
+    int category = slot.category.loadRelaxed();
+    quintptr thread = slot.thread.loadRelaxed();
+    qint64 start = slot.start.loadRelaxed();
+    qint64 duration = slot.duration.loadRelaxed();
+    // fields must be read before seq is checked again
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot.seq.loadRelaxed() != seq)
+      continue;
+
+    if (!threads.contains(thread))
+      threads.insert(thread, threads.size() + 1);
+    QJsonObject event;
+    event["name"] = QString::fromLatin1(name);
+    event["cat"] = QString(categoryName(static_cast<traceCategory>(category)));
+    event["ph"] = QString("X");
+    event["ts"] = start / 1000.0;  // microseconds
+    event["dur"] = duration / 1000.0;
+    event["pid"] = 1;
+    event["tid"] = threads.value(thread);
+    events.append(event);
+  }
+
+  QJsonObject root;
+  root["traceEvents"] = events;
+  root["displayTimeUnit"] = QString("ms");
+
+  QFile file(fileName);
+  if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+    if (error)
+      *error = QObject::tr("Cannot write file %1:\n%2.")
+               .arg(fileName).arg(file.errorString());
+    return false;
+  }
+  file.write(QJsonDocument(root).toJson(QJsonDocument::Compact));
+  return true;
+}
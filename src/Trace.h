@@ -0,0 +1,85 @@
+/**********************************************************************
+* File:        Trace.h
+* Description: Lightweight tracing of hot paths (Chrome trace format)
+* Author:      Zdenko Podobny
+* Created:     2026-10-19
+*
+* (C) Copyright 2026, Zdenko Podobny
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**    http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*
+**********************************************************************/
+
+
+#ifndef SRC_TRACE_H_
+#define SRC_TRACE_H_
+
+#include <QString>
+#include <QtGlobal>
+
+// Category of traced span (shown as "cat" in trace viewer)
+enum traceCategory {
+    tcIO = 1,       // reading/writing files
+    tcModel = 2,    // box data, table model
+    tcRender = 4,   // scene, image conversion, selection
+    tcOCR = 8,      // tesseract
+    tcUndo = 16     // undo/redo/journal
+};
+
+/*
+ * Collector of timed spans. Spans are stored to fixed size lock-free ring
+ * buffer (the oldest are overwritten), so tracing can run for whole session
+ * and from worker threads. When tracing is disabled span costs one atomic
+ * load. Buffer can be exported in Chrome trace format (chrome://tracing,
+ * https://ui.perfetto.dev).
+ */
+class Trace {
+  public:
+    static void setEnabled(bool enabled);
+    static bool isEnabled();
+    // Monotonic time in nanoseconds since start of application
+    static qint64 now();
+    // name must be static string (e.g. Q_FUNC_INFO or string literal)
+    static void record(const char* name, traceCategory category, qint64 start,
+                       qint64 duration);
+    static void clear();
+    // Number of spans in buffer
+    static int count();
+    static const char* categoryName(traceCategory category);
+    static bool exportChromeTrace(const QString& fileName, QString* error);
+};
+
+// Records time between construction and destruction if tracing is enabled
+class TraceSpan {
+  public:
+    TraceSpan(const char* name, traceCategory category)
+        : m_name(name), m_category(category),
+          m_start(Trace::isEnabled() ? Trace::now() : -1) {
+    }
+    ~TraceSpan() {
+        if (m_start >= 0)
+            Trace::record(m_name, m_category, m_start, Trace::now() - m_start);
+    }
+
+  private:
+    Q_DISABLE_COPY(TraceSpan)
+    const char* m_name;
+    traceCategory m_category;
+    qint64 m_start;
+};
+
+// Span of whole function / of named block
+#define TRACE_SPAN(category) TraceSpan traceSpan(Q_FUNC_INFO, category)
+#define TRACE_SCOPE(name, category) TraceSpan traceScope(name, category)
+
+#endif  // SRC_TRACE_H_
@@ -0,0 +1,154 @@
+/**********************************************************************
+* File:        UndoStack.cpp
+* Description: Undo/redo commands of box editor
+* Author:      Zdenko Podobny
+* Created:     2026-10-19
+*
+* (C) Copyright 2026, Zdenko Podobny
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**    http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*
+**********************************************************************/
+
+#include "UndoStack.h"
+#include "EditJournal.h"
+
+// Default memory limit for undo/redo (can be changed in settings)
+static const qint64 kDefaultUndoLimit = 64 * 1024 * 1024;
+
+// Rough estimation of memory used by value stored in step
+static qint64 variantBytes(const QVariant& value) {
+  qint64 bytes = sizeof(QVariant);
+  switch (value.type()) {
+  case QVariant::String:
+    bytes += value.toString().capacity() * sizeof(QChar) + 32;
+    break;
+  case QVariant::List: {
+    QVariantList list = value.toList();
+    for (int i = 0; i < list.size(); ++i)
+      bytes += variantBytes(list.at(i));
+    bytes += 32;
+    break;
+  }
+  default:
+    break;
+  }
+  return bytes;
+}
+
+UndoStack::UndoStack() {
+  m_macroDepth = 0;
+  m_bytes = 0;
+  m_limit = kDefaultUndoLimit;
+  m_journal = 0;
+}
+
+qint64 UndoStack::commandBytes(const UndoCommand& command) {
+  qint64 bytes = sizeof(UndoCommand) + command.m_text.capacity() * 2;
+  for (int i = 0; i < command.m_steps.size(); ++i) {
+    const UndoStep& step = command.m_steps.at(i);
+    bytes += sizeof(UndoStep) - 2 * sizeof(QVariant);
+    bytes += variantBytes(step.m_before) + variantBytes(step.m_after);
+  }
+  return bytes;
+}
+
+void UndoStack::beginMacro(const QString& text, int page) {
+  if (m_macroDepth++ > 0)
+    return;  // nested macro is part of outer one
+  m_macro = UndoCommand();
+  m_macro.m_text = text;
+  m_macro.m_page = page;
+  m_macro.m_bytes = 0;
+}
+
+void UndoStack::endMacro() {
+  if (m_macroDepth == 0 || --m_macroDepth > 0)
+    return;
+  if (!m_macro.m_steps.isEmpty())
+    push(m_macro);
+  m_macro = UndoCommand();
+}
+
+void UndoStack::record(const UndoStep& step, int page) {
+  if (m_macroDepth > 0) {
+    m_macro.m_steps.append(step);
+    return;
+  }
+  UndoCommand command;
+  command.m_page = page;
+  command.m_bytes = 0;
+  command.m_steps.append(step);
+  push(command);
+}
+
+void UndoStack::push(const UndoCommand& command) {
+  // New command makes redo list invalid
+  for (int i = 0; i < m_redo.size(); ++i)
+    m_bytes -= m_redo.at(i).m_bytes;
+  m_redo.clear();
+
+  m_undo.append(command);
+  m_undo.last().m_bytes = commandBytes(command);
+  m_bytes += m_undo.last().m_bytes;
+  if (m_journal)
+    m_journal->append(ejrCommand, command);
+  trim();
+}
+
+UndoCommand UndoStack::undo() {
+  if (m_undo.isEmpty())
+    return UndoCommand();
+  m_redo.append(m_undo.takeLast());
+  if (m_journal)
+    m_journal->append(ejrUndo, m_redo.last());
+  return m_redo.last();
+}
+
+UndoCommand UndoStack::redo() {
+  if (m_redo.isEmpty())
+    return UndoCommand();
+  m_undo.append(m_redo.takeLast());
+  if (m_journal)
+    m_journal->append(ejrRedo, m_undo.last());
+  return m_undo.last();
+}
+
+void UndoStack::clear() {
+  m_undo.clear();
+  m_redo.clear();
+  m_macro = UndoCommand();
+  m_macroDepth = 0;
+  m_bytes = 0;
+}
+
+void UndoStack::setMemoryLimit(qint64 bytes) {
+  m_limit = bytes;
+  while (m_bytes > m_limit && !m_redo.isEmpty()) {
+    m_bytes -= m_redo.first().m_bytes;
+    m_redo.removeFirst();
+  }
+  trim();
+}
+
+/*
+ * Drop the oldest commands until memory limit is satisfied. The last command
+ * is always kept, so even huge operation can be undone. Redo list is empty
+ * after push; setMemoryLimit drops it before.
+ */
+void UndoStack::trim() {
+  while (m_bytes > m_limit && m_undo.size() > 1) {
+    m_bytes -= m_undo.first().m_bytes;
+    m_undo.removeFirst();
+  }
+}
@@ -0,0 +1,126 @@
+/**********************************************************************
+* File:        UndoStack.h
+* Description: Undo/redo commands of box editor
+* Author:      Zdenko Podobny
+* Created:     2026-10-19
+*
+* (C) Copyright 2026, Zdenko Podobny
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**    http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*
+**********************************************************************/
+
+#ifndef SRC_UNDOSTACK_H_
+#define SRC_UNDOSTACK_H_
+
+#include <QList>
+#include <QString>
+#include <QVariant>
+#include <QVector>
+
+class EditJournal;
+
+/*
+ * Elementary changes of table model. Every user operation is stored as list
+ * of these steps, so undo costs only as much as changed cells/rows.
+ */
+enum undoOperation {
+    euoAdd = 1,       // row m_row inserted; m_after keeps row values
+    euoDelete = 2,    // row m_row removed; m_before keeps row values
+    euoChange = 4,    // cell (m_row, m_arg) changed from m_before to m_after
+    euoStore = 8,     // symbol m_row of other page m_arg changed (in pages)
+    euoPermute = 16,  // rows reordered; m_after[i] is old row of row i
+    euoMove = 32      // rows m_before moved to block from row m_arg
+};
+
+struct UndoStep {
+    undoOperation m_eop;
+    int m_row;
+    int m_arg;
+    QVariant m_before;
+    QVariant m_after;
+};
+
+// One undoable user operation (e.g. join of 20 symbols)
+struct UndoCommand {
+    QString m_text;
+    int m_page;        // page where command was recorded
+    qint64 m_bytes;    // estimated memory used by command
+    QVector<UndoStep> m_steps;
+};
+
+/*
+ * Undo and redo lists with grouping of steps to commands (macros) and
+ * memory limit. Limit is checked when command is pushed or limit is changed
+ * and the oldest commands are dropped then; undo and redo only move commands
+ * between lists, so memory usage does not change.
+ */
+class UndoStack {
+  public:
+    UndoStack();
+
+    // Steps recorded between beginMacro and endMacro form one command
+    void beginMacro(const QString& text, int page);
+    void endMacro();
+    bool isMacroOpen() const {
+        return m_macroDepth > 0;
+    }
+    // Record step to open macro or as new one-step command
+    void record(const UndoStep& step, int page);
+    // Store finished command and clear redo list
+    void push(const UndoCommand& command);
+
+    bool canUndo() const {
+        return !m_undo.isEmpty();
+    }
+    bool canRedo() const {
+        return !m_redo.isEmpty();
+    }
+    // Move the last command to redo list and return it
+    UndoCommand undo();
+    // Move the last undone command back to undo list and return it
+    UndoCommand redo();
+    void clear();
+
+    int count() const {
+        return m_undo.size() + m_redo.size();
+    }
+    qint64 memoryUsage() const {
+        return m_bytes;
+    }
+    qint64 memoryLimit() const {
+        return m_limit;
+    }
+    // Lower limit drops redo list first, then the oldest commands
+    void setMemoryLimit(qint64 bytes);
+
+    // Every pushed, undone and redone command is written to journal
+    void setJournal(EditJournal* journal) {
+        m_journal = journal;
+    }
+
+    static qint64 commandBytes(const UndoCommand& command);
+
+  private:
+    void trim();
+
+    QList<UndoCommand> m_undo;
+    QList<UndoCommand> m_redo;
+    UndoCommand m_macro;
+    int m_macroDepth;
+    qint64 m_bytes;
+    qint64 m_limit;
+    EditJournal* m_journal;
+};
+
+#endif  // SRC_UNDOSTACK_H_
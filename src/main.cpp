@@ -24,15 +24,30 @@
 #include <QTextCodec>
 #include <QApplication>
 #include <QStyleFactory>
+#include <QDebug>
 #if defined _COMPOSE_STATIC_
 #include <QtPlugin>
 Q_IMPORT_PLUGIN(qsvg)
 #endif
 
+#include <string.h>
+
+#include "BatchProcessor.h"
 #include "MainWindow.h"
 #include "Settings.h"
+#include "Trace.h"
 
 int main(int argc, char* argv[]) {
+  // Batch mode does not need display
+  for (int i = 1; i < argc; ++i) {
+    if (strcmp(argv[i], "--batch") == 0) {
+      QCoreApplication app(argc, argv);
+      app.setOrganizationName(SETTING_ORGANIZATION);
+      app.setApplicationName(SETTING_APPLICATION);
+      return BatchProcessor::run(app.arguments());
+    }
+  }
+
   Q_INIT_RESOURCE(application);
 
   QApplication app(argc, argv);
@@ -68,12 +83,32 @@ int main(int argc, char* argv[]) {
     QTextCodec::setCodecForTr(QTextCodec::codecForName("UTF-8"));
   #endif
 
+  // --trace file: record whole session and write it as Chrome trace at exit
+  QString traceFile;
+  QStringList files;
+  for (int i = 1; i < argc; ++i) {
+    if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+      traceFile = QString::fromLocal8Bit(argv[++i]);
+      Trace::setEnabled(true);
+    } else {
+      files.append(QString::fromLocal8Bit(argv[i]));
+    }
+  }
+
   MainWindow mainWin;
   mainWin.show();
-  for (int i = 1; i < argc; ++i) {
-    mainWin.addChild(argv[i]);
+  for (int i = 0; i < files.size(); ++i) {
+    mainWin.addChild(files.at(i));
   }
+  if (files.isEmpty())
+    mainWin.restoreSession();
 
-  return app.exec();
+  int result = app.exec();
+  if (!traceFile.isEmpty()) {
+    QString error;
+    if (!Trace::exportChromeTrace(traceFile, &error))
+      qWarning() << error;
+  }
+  return result;
 }
 